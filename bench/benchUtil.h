@@ -0,0 +1,49 @@
+#ifndef LIBRARYMANAGEMENT_BENCHUTIL_H
+#define LIBRARYMANAGEMENT_BENCHUTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+using namespace std;
+
+// 基准测试的公共工具
+class BenchUtil {
+public:
+    // 计时器, 构造时开始计时
+    class Timer {
+    private:
+        chrono::steady_clock::time_point start;
+
+    public:
+        Timer() : start(chrono::steady_clock::now()) {}
+
+        // 重新开始计时
+        void reset() { start = chrono::steady_clock::now(); }
+
+        // 返回经过的秒数
+        double seconds() const {
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    // 返回当前进程的常驻内存 (字节), 无法获取时返回 0
+    static size_t residentBytes() {
+        ifstream in("/proc/self/statm");
+        size_t pages = 0, resident = 0;
+        if (in >> pages >> resident) {
+            return resident * 4096;
+        }
+        return 0;
+    }
+
+    // 以 MiB 为单位格式化字节数
+    static double mib(size_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+    // 每秒操作数 (百万)
+    static double mops(size_t ops, double seconds) {
+        return seconds > 0 ? ops / seconds / 1e6 : 0;
+    }
+};
+
+#endif //LIBRARYMANAGEMENT_BENCHUTIL_H
@@ -0,0 +1,148 @@
+// 列式筛选基准测试
+// 对比多条件筛选 (计数) 的三种做法:
+// - RbTree:      遍历以编号为键的红黑树 (与 BookManager 主索引相同), 逐本调用 Book 的取值函数比较
+// - vector:      遍历按编号排列的 vector<Book>, 同样逐本调用取值函数 (行存储的上限)
+// - BookColumns: 列式存储上的向量化扫描 (SSE2 每次 16 行, 字符串条件预先编码为整数)
+// 图书数据: 作者 AuthorCount 个、出版社 PublisherCount 个 (均匀分布), 出版年份 1950..2024, 约 1/8 已借出
+// 同一 ISBN 的副本共享 Title, 与 BookManager 中的存储方式相同
+//
+// 用法: columns_bench [规模...]
+// 默认: 100000 1000000 10000000
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchUtil.h"
+#include "book.h"
+#include "bookColumns.h"
+#include "rbTree.h"
+using namespace std;
+
+class ColumnsBench {
+private:
+    // 用于从 Book 对象中提取书籍编号
+    struct IdOfBook {
+        const int &operator()(const Book &book) const { return book.GetId(); }
+    };
+
+    static constexpr int AuthorCount = 1000;
+    static constexpr int PublisherCount = 50;
+    static constexpr int TitleCount = 100000;  // 不同 ISBN 的个数
+
+    // 防止结果被优化掉
+    static volatile size_t sink;
+
+    // 每项测量至少扫描约五千万行
+    static size_t repeats(size_t n) { return max<size_t>(1, 50000000 / max<size_t>(n, 1)); }
+
+    // 逐本比较的筛选条件 (对照组使用)
+    static bool match(const BookColumns::Query &query, const Book &book) {
+        return (!query.byAuthor || book.GetAuthor() == query.author)
+               && (!query.byPublisher || book.GetPublisher() == query.publisher)
+               && book.GetYear() >= query.yearMin && book.GetYear() <= query.yearMax
+               && (query.availability == BookColumns::AnyStatus
+                   || book.GetBorrowStatus() == (query.availability == BookColumns::BorrowedOnly));
+    }
+
+    // 测量 count() 的扫描速度, 输出每秒扫描的行数
+    template <class Count>
+    static void measure(const char *name, size_t n, Count count) {
+        size_t reps = repeats(n);
+        size_t hits = 0;
+        BenchUtil::Timer timer;
+        for (size_t r = 0; r < reps; ++r) {
+            hits = count();
+        }
+        double seconds = timer.seconds();
+        sink = sink + hits;
+        cout << "  " << name << "  hits=" << hits << "  " << BenchUtil::mops(n * reps, seconds) << " Mrows/s"
+             << "  " << seconds * 1e3 / reps << " ms/query" << endl;
+    }
+
+public:
+    // 对规模 n 运行全部查询
+    static void run(size_t n) {
+        mt19937 rng(42);
+        vector<shared_ptr<const Title>> titles;
+        titles.reserve(TitleCount);
+        for (int i = 0; i < TitleCount; ++i) {
+            titles.push_back(make_shared<Title>("978" + to_string(1000000 + i), "book" + to_string(i),
+                                                "author" + to_string(rng() % AuthorCount),
+                                                "publisher" + to_string(rng() % PublisherCount),
+                                                1950 + (int) (rng() % 75)));
+        }
+
+        size_t before = BenchUtil::residentBytes();
+        vector<Book> books;
+        books.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            books.emplace_back((int) i + 1, titles[rng() % TitleCount], rng() % 8 == 0, "");
+        }
+        RbTree<int, Book, IdOfBook, std::less<>> tree;
+        tree.buildUnique(books.begin(), books.end());
+        BookColumns columns;
+        columns.Reserve(n);
+        size_t rowBytes = BenchUtil::residentBytes();
+        for (const Book &book : books) {
+            columns.Put(book);
+        }
+        size_t columnBytes = BenchUtil::residentBytes() - rowBytes;
+        cout << "n=" << n << "  rows+tree: " << BenchUtil::mib(rowBytes - before) << " MiB"
+             << "  columns: " << BenchUtil::mib(columnBytes) << " MiB" << endl;
+
+        vector<pair<const char *, BookColumns::Query>> queries;
+        BookColumns::Query q;
+        q.byAuthor = true;
+        q.author = "author7";
+        queries.push_back({"author", q});
+        q.yearMin = 1980;
+        q.yearMax = 1999;
+        queries.push_back({"author+year", q});
+        q = BookColumns::Query();
+        q.byPublisher = true;
+        q.publisher = "publisher3";
+        q.availability = BookColumns::Available;
+        queries.push_back({"publisher+available", q});
+        q = BookColumns::Query();
+        q.yearMin = 2000;
+        q.yearMax = 2009;
+        q.availability = BookColumns::BorrowedOnly;
+        queries.push_back({"year+borrowed", q});
+
+        for (auto &query : queries) {
+            cout << " " << query.first << endl;
+            const BookColumns::Query &cond = query.second;
+            measure("RbTree     ", n, [&tree, &cond]() {
+                size_t hits = 0;
+                for (auto it = tree.begin(); it != tree.end(); ++it) {
+                    hits += match(cond, *it);
+                }
+                return hits;
+            });
+            measure("vector     ", n, [&books, &cond]() {
+                size_t hits = 0;
+                for (const Book &book : books) {
+                    hits += match(cond, book);
+                }
+                return hits;
+            });
+            measure("BookColumns", n, [&columns, &cond]() { return columns.Count(cond); });
+        }
+    }
+};
+
+volatile size_t ColumnsBench::sink = 0;
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000, 10000000};
+    }
+    for (size_t n : sizes) {
+        ColumnsBench::run(n);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// 并发图书管理基准测试
+// 在 99/1 与 90/10 两种读写比例下, 测量线程数从 1 增加到 N 时的读吞吐量
+// - facade: ConcurrentBookManager 包装的 BookManager (读者共享锁, 写者独占锁)
+// - direct: 对照组, 单线程直接调用同一个 BookManager, 不加锁 (只在线程数为 1 时运行)
+// 读操作: 80% 按编号查找, 15% 按 ISBN 查找, 5% 分页浏览 (每页 20 本)
+// 写操作: 随机一本书, 在库则借出, 已借出则归还
+//
+// 用法: concurrent_bench [图书数] [最大线程数] [每轮秒数]
+// 默认: 1000000 硬件并发数 1
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchUtil.h"
+#include "bookManager.h"
+#include "concurrentBookManager.h"
+using namespace std;
+
+class ConcurrentBench {
+public:
+    // 运行一轮, 输出吞吐量
+    // Target 提供 FindByID、FindByISBN、FindPage、Lend、Return 和 Sync
+    template <class Target>
+    static void run(const char *name, Target &target, int writePercent, int threads, double seconds, size_t n) {
+        atomic<bool> start(false), stop(false);
+        vector<size_t> reads(threads, 0), writes(threads, 0);
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                mt19937 rng(t + 1);
+                Book book;
+                size_t pages = (n + 19) / 20;
+                while (!start.load()) {
+                    this_thread::yield();
+                }
+                while (!stop.load(memory_order_relaxed)) {
+                    int r = (int) (rng() % 100);
+                    int id = (int) (rng() % n) + 1;
+                    if (r < writePercent) {
+                        if (target.Lend(id, "bench") != BookManager::Ok) {
+                            target.Return(id);
+                        }
+                        if (++writes[t] % 1024 == 0) {  // 定期提交 (接管后台重建的冻结索引)
+                            target.Sync();
+                        }
+                    } else if (r < writePercent + 80) {
+                        target.FindByID(id, book);
+                        ++reads[t];
+                    } else if (r < writePercent + 95) {
+                        target.FindByISBN("ISBN" + to_string((id - 1) / 10));
+                        ++reads[t];
+                    } else {
+                        target.FindPage(rng() % pages + 1, 20);
+                        ++reads[t];
+                    }
+                }
+            });
+        }
+        BenchUtil::Timer timer;
+        start = true;
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop = true;
+        for (thread &w : workers) {
+            w.join();
+        }
+        double elapsed = timer.seconds();
+        size_t totalReads = 0, totalWrites = 0;
+        for (int t = 0; t < threads; ++t) {
+            totalReads += reads[t];
+            totalWrites += writes[t];
+        }
+        cout << name << "  mix=" << 100 - writePercent << "/" << writePercent
+             << "  threads=" << threads
+             << "  reads: " << BenchUtil::mops(totalReads, elapsed) << " Mops/s"
+             << "  writes: " << BenchUtil::mops(totalWrites, elapsed) * 1000 << " Kops/s" << endl;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? stoul(argv[1]) : 1000000;
+    int maxThreads = argc > 2 ? stoi(argv[2]) : (int) max(1u, thread::hardware_concurrency());
+    double seconds = argc > 3 ? stod(argv[3]) : 1.0;
+
+    // BookManager 按相对路径 ../data 读写最大编号文件, 在临时目录中运行以免改动真实数据
+    filesystem::path root = filesystem::temp_directory_path() / "concurrent_bench";
+    filesystem::create_directories(root / "data");
+    filesystem::create_directories(root / "run");
+    filesystem::current_path(root / "run");
+
+    // 每个 ISBN 10 本副本, 不打开操作日志 (只测内存中的读写)
+    BookManager books;
+    for (size_t i = 0; i < n; i += 10) {
+        int firstId;
+        books.Insert(Title("ISBN" + to_string(i / 10), "书名", "作者", "出版社", 2000),
+                     (int) min<size_t>(10, n - i), firstId);
+    }
+    books.Sync();
+
+    vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (int writePercent : {1, 10}) {
+        ConcurrentBench::run("direct", books, writePercent, 1, seconds, n);
+        ConcurrentBookManager facade(books);
+        for (int t : threadCounts) {
+            ConcurrentBench::run("facade", facade, writePercent, t, seconds, n);
+        }
+    }
+    return 0;
+}
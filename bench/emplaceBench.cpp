@@ -0,0 +1,184 @@
+// 插入路径的分配次数基准测试
+// 对比三种把一个值放进红黑树的方式, 统计每次插入的堆分配次数 (含节点池按块分摊的部分) 和吞吐量:
+// - copy:    先构造临时对象, 再以 insertUnique(const Value &) 复制进节点 (原来 BookManager 的做法)
+// - move:    先构造临时对象, 再以 insertUnique(Value &&) 移入节点
+// - emplace: emplaceUnique(参数...) 直接在节点中构造 (没有提示位置, 每次都要从根查找插入点, 顺序追加时比带提示的 move 慢)
+// 以及查找时以 string 和 string_view 为参数的分配次数 (透明比较函数 std::less<> 下的异构查找)
+// 元素形状:
+// - admin: Admin (用户名、密码两个字符串), 按用户名排序
+// - book:  Book (共享的 Title + 借阅人字符串), 按编号排序
+// 字符串都超过短字符串优化的长度, 每次复制都需要分配
+//
+// 用法: emplace_bench [规模...]
+// 默认: 100000 1000000
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "admin.h"
+#include "benchUtil.h"
+#include "book.h"
+#include "rbTree.h"
+using namespace std;
+
+// 全局分配计数
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// 提取管理员的用户名
+struct NameOfAdmin {
+    const string &operator()(const Admin &a) const { return a.GetAdminName(); }
+};
+
+// 提取书的编号
+struct IdOfBook {
+    const int &operator()(const Book &b) const { return b.GetId(); }
+};
+
+class EmplaceBench {
+public:
+    typedef RbTree<string, Admin, NameOfAdmin, std::less<>> AdminTree;
+    typedef RbTree<int, Book, IdOfBook, std::less<>> BookTree;
+
+    // 输出一行结果
+    static void report(const char *shape, const char *path, size_t n, size_t allocs, double sec) {
+        cout << shape << "  " << path << "  n=" << n
+             << "  allocs/op: " << (double) allocs / n
+             << "  " << BenchUtil::mops(n, sec) << " Mops/s" << endl;
+    }
+
+    // 运行 body, 返回期间的分配次数和耗时
+    template <class Body>
+    static size_t measure(Body body, double &sec) {
+        size_t before = allocations;
+        BenchUtil::Timer timer;
+        body();
+        sec = timer.seconds();
+        return allocations - before;
+    }
+
+    static void runAdmin(size_t n) {
+        // 用户名按顺序生成, 以 end() 为提示追加
+        vector<string> names(n), passwords(n);
+        for (size_t i = 0; i < n; ++i) {
+            string digits = to_string(i);
+            names[i] = "administrator-" + string(10 - digits.size(), '0') + digits;
+            passwords[i] = "password-for-administrator-" + digits;
+        }
+        double sec;
+        size_t allocs;
+        {
+            AdminTree tree;
+            allocs = measure([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    Admin user(names[i], passwords[i]);
+                    tree.insertUnique(tree.end(), user);
+                }
+            }, sec);
+            report("admin", "copy   ", n, allocs, sec);
+        }
+        {
+            AdminTree tree;
+            allocs = measure([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    Admin user(names[i], passwords[i]);
+                    tree.insertUnique(tree.end(), move(user));
+                }
+            }, sec);
+            report("admin", "move   ", n, allocs, sec);
+        }
+        AdminTree tree;
+        allocs = measure([&] {
+            for (size_t i = 0; i < n; ++i) {
+                tree.emplaceUnique(names[i], passwords[i]);
+            }
+        }, sec);
+        report("admin", "emplace", n, allocs, sec);
+
+        // 以 C 字符串查找: string 版本需要先构造临时 string, string_view 版本不需要
+        size_t hits = 0;
+        allocs = measure([&] {
+            for (size_t i = 0; i < n; ++i) {
+                hits += tree.find(string(names[i].c_str())) != tree.end();
+            }
+        }, sec);
+        report("admin", "find(string)     ", n, allocs, sec);
+        allocs = measure([&] {
+            for (size_t i = 0; i < n; ++i) {
+                hits += tree.find(string_view(names[i].c_str())) != tree.end();
+            }
+        }, sec);
+        report("admin", "find(string_view)", n, allocs, sec);
+        if (hits != 2 * n) {
+            cout << "查找结果错误" << endl;
+        }
+    }
+
+    static void runBook(size_t n) {
+        // 所有副本共享一个 Title, 借阅人各不相同
+        shared_ptr<const Title> title = make_shared<Title>("9787000000000", "a-reasonably-long-book-name",
+                                                           "some-author-name", "some-publisher-name", 2020);
+        vector<string> borrowers(n);
+        for (size_t i = 0; i < n; ++i) {
+            borrowers[i] = "borrower-with-a-long-name-" + to_string(i);
+        }
+        double sec;
+        size_t allocs;
+        {
+            BookTree tree;
+            allocs = measure([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    Book copy((int) i, title, true, borrowers[i]);
+                    tree.insertUnique(tree.end(), copy);
+                }
+            }, sec);
+            report("book ", "copy   ", n, allocs, sec);
+        }
+        {
+            BookTree tree;
+            allocs = measure([&] {
+                for (size_t i = 0; i < n; ++i) {
+                    Book copy((int) i, title, true, borrowers[i]);
+                    tree.insertUnique(tree.end(), move(copy));
+                }
+            }, sec);
+            report("book ", "move   ", n, allocs, sec);
+        }
+        BookTree tree;
+        allocs = measure([&] {
+            for (size_t i = 0; i < n; ++i) {
+                tree.emplaceUnique((int) i, title, true, borrowers[i]);
+            }
+        }, sec);
+        report("book ", "emplace", n, allocs, sec);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000};
+    }
+    for (size_t n : sizes) {
+        EmplaceBench::runAdmin(n);
+        EmplaceBench::runBook(n);
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// 批量删除基准测试
+// 从 n 个节点的树中删除 10% 与 50% 的节点, 对比:
+// - 连续区间: 逐个 erase(iterator) / erase(first, last) (拆分 + 连接) / std::set::erase(first, last)
+// - 分散节点 (每隔若干个删除一个): 逐个 erase(iterator) / eraseIf (一次遍历后重建) / std::set 逐个删除
+// 每项测量前由有序键值重新建树, 建树时间不计入
+//
+// 用法: erase_bench [规模...]
+// 默认: 1000000 10000000
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "benchUtil.h"
+#include "rbTree.h"
+using namespace std;
+
+// 元素即键值
+struct KeyOfInt {
+    const int &operator()(const int &v) const { return v; }
+};
+
+class EraseBench {
+public:
+    typedef RbTree<int, int, KeyOfInt, std::less<>> Tree;
+
+    // 输出一行结果
+    static void report(const char *what, size_t n, size_t removed, double sec) {
+        cout << what << "  n=" << n << "  removed=" << removed
+             << "  " << sec * 1000 << " ms  (" << BenchUtil::mops(removed, sec) << " M removed/s)" << endl;
+    }
+
+    // 删除中间连续的 percent% 个节点
+    static void range(const vector<int> &keys, size_t percent) {
+        size_t n = keys.size();
+        size_t k = n * percent / 100;
+        int lo = (int) ((n - k) / 2), hi = lo + (int) k;
+        cout << "-- 连续区间 " << percent << "%" << endl;
+        {
+            Tree tree;
+            tree.buildUnique(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            Tree::iterator first = tree.lowerBound(lo), last = tree.lowerBound(hi);
+            while (first != last) {
+                tree.erase(first++);
+            }
+            report("RbTree  erase(iterator) x k ", n, k, timer.seconds());
+        }
+        {
+            Tree tree;
+            tree.buildUnique(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            tree.erase(tree.lowerBound(lo), tree.lowerBound(hi));
+            report("RbTree  erase(first, last)  ", n, k, timer.seconds());
+        }
+        {
+            set<int> s(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            s.erase(s.lower_bound(lo), s.lower_bound(hi));
+            report("std::set erase(first, last) ", n, k, timer.seconds());
+        }
+    }
+
+    // 每隔 step 个键值删除一个
+    static void scattered(const vector<int> &keys, int step) {
+        size_t n = keys.size();
+        size_t k = (n + step - 1) / step;
+        cout << "-- 分散节点 " << 100 / step << "%" << endl;
+        {
+            Tree tree;
+            tree.buildUnique(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            for (Tree::iterator it = tree.begin(); it != tree.end();) {
+                if (*it % step == 0) {
+                    tree.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+            report("RbTree  erase(iterator) x k ", n, k, timer.seconds());
+        }
+        {
+            Tree tree;
+            tree.buildUnique(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            size_t removed = tree.eraseIf([step](int v) { return v % step == 0; });
+            report("RbTree  eraseIf             ", n, removed, timer.seconds());
+        }
+        {
+            set<int> s(keys.begin(), keys.end());
+            BenchUtil::Timer timer;
+            for (set<int>::iterator it = s.begin(); it != s.end();) {
+                if (*it % step == 0) {
+                    it = s.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            report("std::set erase(iterator) x k", n, k, timer.seconds());
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000};
+    }
+    for (size_t n : sizes) {
+        vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = (int) i;
+        }
+        EraseBench::range(keys, 10);
+        EraseBench::range(keys, 50);
+        EraseBench::scattered(keys, 10);
+        EraseBench::scattered(keys, 2);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+// 冻结索引查找基准测试
+// 对比按编号查找时各索引的吞吐量与延迟:
+// - RbTree:      红黑树, 逐层追指针
+// - BTree:       B+ 树, 节点内二分
+// - sorted:      有序数组上的 std::lower_bound (冻结索引的朴素版本)
+// - FrozenIndex: Eytzinger 布局 + 预取 + 无分支比较
+// 两种测量方式:
+// - throughput: 查询互不依赖, CPU 可以同时执行多次查找
+// - latency:    下一次查询的键值取决于上一次的结果, 测得单次查找的完整延迟
+// 键值为 2k (k 随机排列后插入), 查询按另一随机排列进行, 全部命中
+//
+// 用法: frozen_bench [规模...]
+// 默认: 1000 100000 1000000 10000000
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bTree.h"
+#include "benchUtil.h"
+#include "frozenIndex.h"
+#include "rbTree.h"
+using namespace std;
+
+class FrozenIndexBench {
+private:
+    // 元素即键值
+    struct KeyOf {
+        const int &operator()(const int &v) const { return v; }
+    };
+
+    // 防止查询结果被优化掉
+    static volatile size_t sink;
+
+    // 每项测量至少约两百万次查询
+    static size_t repeats(size_t n) { return max<size_t>(1, 2000000 / max<size_t>(n, 1)); }
+
+    // 对一种索引测量两种方式, lookup(k) 返回找到的键值
+    template <class Lookup>
+    static void measure(const char *name, size_t n, const vector<int> &queries, Lookup lookup) {
+        size_t reps = repeats(n);
+        size_t total = 0;
+        BenchUtil::Timer timer;
+        for (size_t r = 0; r < reps; ++r) {
+            for (int k : queries) {
+                total += lookup(k);
+            }
+        }
+        double throughput = timer.seconds();
+
+        // 上一次结果的最低位 (总是 0) 参与下一次下标计算, 形成数据依赖
+        size_t carry = 0;
+        timer.reset();
+        for (size_t r = 0; r < reps; ++r) {
+            for (size_t i = 0; i < n; ++i) {
+                carry = (size_t) lookup(queries[(i + carry) % n]) & 1;
+                total += carry;
+            }
+        }
+        double latency = timer.seconds();
+        sink = sink + total;
+
+        size_t ops = n * reps;
+        cout << name << "  n=" << n << "  throughput: " << BenchUtil::mops(ops, throughput) << " Mops/s"
+             << "  latency: " << latency * 1e9 / ops << " ns/op" << endl;
+    }
+
+public:
+    // 对规模 n 运行全部索引
+    static void run(size_t n) {
+        vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = (int) (2 * i);
+        }
+        vector<int> sorted = keys;
+        mt19937 rng(42);
+        shuffle(keys.begin(), keys.end(), rng);
+        vector<int> queries = keys;
+        shuffle(queries.begin(), queries.end(), rng);
+
+        // 随机顺序逐个插入, 使树节点在内存中分散, 与长期运行后的主索引相近
+        {
+            RbTree<int, int, KeyOf, std::less<>> tree;
+            for (int k : keys) {
+                tree.insertUnique(k);
+            }
+            measure("RbTree     ", n, queries, [&tree](int k) { return *tree.find(k); });
+        }
+        {
+            BTree<int, int, KeyOf, std::less<>> tree;
+            for (int k : keys) {
+                tree.insertUnique(k);
+            }
+            measure("BTree      ", n, queries, [&tree](int k) { return *tree.find(k); });
+        }
+        measure("sorted     ", n, queries, [&sorted](int k) {
+            return *lower_bound(sorted.begin(), sorted.end(), k);
+        });
+        {
+            FrozenIndex<int, int> frozen;
+            size_t next = 0;
+            frozen.build(n, [&sorted, &next](int &k, int &v) {
+                k = v = sorted[next++];
+                return true;
+            });
+            measure("FrozenIndex", n, queries, [&frozen](int k) { return *frozen.find(k); });
+        }
+    }
+};
+
+volatile size_t FrozenIndexBench::sink = 0;
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 100000, 1000000, 10000000};
+    }
+    for (size_t n : sizes) {
+        FrozenIndexBench::run(n);
+    }
+    return 0;
+}
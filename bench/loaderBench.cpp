@@ -0,0 +1,93 @@
+// 图书加载器基准测试
+// 把 n 行 book.txt 格式的测试数据写入临时文件, 分别以不同的解析线程数加载并线性建树, 对比总耗时
+// BookLoader 以 N 个解析线程加载, 读取、解析和拼接互相重叠, 之后建树
+// 加速比相对于 1 个解析线程计算; 建树不与解析重叠, 线程数增加时只有读取 + 解析 + 拼接部分变快
+// 每轮之前都重新读取文件, 文件已在页缓存中, 测得的是解析和建树的开销而不是磁盘速度
+//
+// 用法: loader_bench [记录数] [线程数...]
+// 默认: 2000000 1 2 4 以及硬件并发数
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchUtil.h"
+#include "book.h"
+#include "bookLoader.h"
+#include "rbTree.h"
+using namespace std;
+
+class LoaderBench {
+public:
+    // 按编号排序的主索引 (与 BookManager 相同)
+    struct IdOfBook {
+        const int &operator()(const Book &book) const { return book.GetId(); }
+    };
+    typedef RbTree<int, Book, IdOfBook, std::less<>> Tree;
+
+    // 生成与 book.txt 格式相同的 n 行测试数据, 每个 ISBN 平均 4 本副本, 约十分之一为借出状态
+    static void makeFile(const string &file, size_t n) {
+        mt19937 rng(42);
+        ofstream out(file, ios::out | ios::binary | ios::trunc);
+        string line;
+        for (size_t i = 0; i < n; ++i) {
+            size_t title = i / 4;
+            bool borrowed = rng() % 10 == 0;
+            line = to_string(i + 1) + " 978-7-" + to_string(100000 + title) + " 书名" + to_string(title) +
+                   " 作者" + to_string(title % 5000) + " 出版社" + to_string(title % 200) + " " +
+                   to_string(1950 + title % 75) + (borrowed ? " 1 读者" + to_string(rng() % 1000) : " 0") + "\n";
+            out << line;
+        }
+    }
+
+    // 以 threads 个解析线程加载
+    static double runLoader(const string &file, size_t threads, size_t &records) {
+        BenchUtil::Timer timer;
+        Tree tree;
+        BookLoader loader(threads);
+        loader.Load(file, [&tree](vector<Book> &books) { tree.buildUnique(books.begin(), books.end()); });
+        double seconds = timer.seconds();
+        records = tree.size();
+        const BookLoader::Stats &stats = loader.GetStats();
+        cout << "    读取 " << stats.readSeconds * 1000 << " ms, 解析 " << stats.parseSeconds * 1000
+             << " ms (各线程合计), 拼接 " << stats.mergeSeconds * 1000 << " ms, 建树 "
+             << stats.buildSeconds * 1000 << " ms" << endl;
+        return seconds;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? stoul(argv[1]) : 2000000;
+    vector<size_t> threads;
+    for (int i = 2; i < argc; ++i) {
+        threads.push_back(stoul(argv[i]));
+    }
+    if (threads.empty()) {
+        threads = {1, 2, 4};
+        size_t hardware = max(1u, thread::hardware_concurrency());
+        if (find(threads.begin(), threads.end(), hardware) == threads.end()) {
+            threads.push_back(hardware);
+        }
+    }
+
+    string file = (filesystem::temp_directory_path() / "loader_bench.txt").string();
+    LoaderBench::makeFile(file, n);
+    cout << "n=" << n << "  " << BenchUtil::mib(filesystem::file_size(file)) << " MiB" << endl;
+
+    size_t records;
+    double base = 0;  // 1 个解析线程的耗时
+    for (size_t t : threads) {
+        double seconds = LoaderBench::runLoader(file, t, records);
+        if (base == 0) {
+            base = t == 1 ? seconds : LoaderBench::runLoader(file, 1, records);
+        }
+        cout << "threads " << t << "  records: " << records << "  " << seconds * 1000 << " ms  "
+             << BenchUtil::mops(records, seconds) << " M records/s  speedup " << base / seconds << "x" << endl;
+    }
+    filesystem::remove(file);
+    return 0;
+}
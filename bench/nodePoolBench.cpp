@@ -0,0 +1,103 @@
+// 节点分配策略基准测试
+// 对比 NewAllocator (new / delete) 与 NodePool (slab + 空闲链表) 下红黑树的
+// 插入、删除、清空吞吐量以及常驻内存
+//
+// 用法: nodepool_bench [new|pool|both] [节点数...]
+// 默认: both 1000000 10000000
+// 注意: 同一进程先后运行两种策略时, 后者的 RSS 会受前者归还给 libc 的内存影响,
+//       需要精确的 RSS 对比时请分别以 new / pool 单独运行
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchUtil.h"
+#include "rbTree.h"
+using namespace std;
+
+// 测试用记录, 大小与一个小型业务对象相当
+struct BenchRecord {
+    int id;
+    char payload[44];
+
+    explicit BenchRecord(int id = 0) : id(id), payload() {}
+};
+
+// 提取测试记录的键值
+struct IdOfRecord {
+    const int &operator()(const BenchRecord &r) const { return r.id; }
+};
+
+class NodePoolBench {
+public:
+    // 对指定分配策略运行一轮测试
+    template <class Alloc>
+    static void run(const char *name, const vector<int> &keys) {
+        typedef RbTree<int, BenchRecord, IdOfRecord, std::less<>, Alloc> Tree;
+        size_t n = keys.size();
+        size_t rssBefore = BenchUtil::residentBytes();
+
+        Tree *tree = new Tree();
+        BenchUtil::Timer timer;
+        for (int k : keys) {
+            tree->insertUnique(BenchRecord(k));
+        }
+        double insertSec = timer.seconds();
+        size_t rssAfter = BenchUtil::residentBytes();
+
+        // 以插入顺序删除一半节点, 再插回, 测试空闲链表复用
+        timer.reset();
+        for (size_t i = 0; i < n / 2; ++i) {
+            tree->erase(tree->find(keys[i]));
+        }
+        double eraseSec = timer.seconds();
+        for (size_t i = 0; i < n / 2; ++i) {
+            tree->insertUnique(BenchRecord(keys[i]));
+        }
+
+        timer.reset();
+        tree->clear();
+        double clearSec = timer.seconds();
+        delete tree;
+
+        cout << name << "  n=" << n
+             << "  insert: " << BenchUtil::mops(n, insertSec) << " Mops/s"
+             << "  erase: " << BenchUtil::mops(n / 2, eraseSec) << " Mops/s"
+             << "  clear: " << clearSec * 1000 << " ms"
+             << "  rss: +" << BenchUtil::mib(rssAfter - rssBefore) << " MiB" << endl;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    string policy = "both";
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "new") == 0 || strcmp(argv[i], "pool") == 0 ||
+            strcmp(argv[i], "both") == 0) {
+            policy = argv[i];
+        } else {
+            sizes.push_back(stoul(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000};
+    }
+
+    for (size_t n : sizes) {
+        // 随机打乱的键值序列
+        vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = (int) i;
+        }
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+
+        if (policy != "new") {
+            NodePoolBench::run<NodePool<Node<BenchRecord>>>("pool", keys);
+        }
+        if (policy != "pool") {
+            NodePoolBench::run<NewAllocator<Node<BenchRecord>>>("new ", keys);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// 记录解析基准测试
+// 对比现有的流式解析 (istringstream >> Book) 与 RecordParser 的每秒记录数
+// - stream: 格式化 istream 提取, 每条记录构造一个 Book
+// - parser: RecordParser 解析并转换为 Book (与 BookLoader 的用法相同)
+// - fields: RecordParser 只解析字段视图, 不构造 Book (解析本身的开销)
+//
+// 用法: parser_bench [记录数...]
+// 默认: 1000000
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchUtil.h"
+#include "book.h"
+#include "recordParser.h"
+using namespace std;
+
+class ParserBench {
+public:
+    // 生成与 book.txt 格式相同的 n 行测试数据, 约十分之一为借出状态
+    static string makeData(size_t n) {
+        mt19937 rng(42);
+        string data;
+        for (size_t i = 0; i < n; ++i) {
+            bool borrowed = rng() % 10 == 0;
+            data += to_string(i + 1) + " 978-7-" + to_string(100000 + rng() % 900000) +
+                    " 书名" + to_string(rng() % 100000) + " 作者" + to_string(rng() % 5000) +
+                    " 出版社" + to_string(rng() % 200) + " " + to_string(1950 + rng() % 75) +
+                    (borrowed ? " 1 读者" + to_string(rng() % 1000) : " 0") + "\n";
+        }
+        return data;
+    }
+
+    // 输出一轮测试的结果
+    static void report(const char *name, size_t records, double seconds, size_t bytes) {
+        cout << name << "  records: " << records
+             << "  " << BenchUtil::mops(records, seconds) << " M records/s"
+             << "  " << bytes / seconds / (1024.0 * 1024.0) << " MiB/s" << endl;
+    }
+
+    // 现有的流式解析
+    static void runStream(const string &data) {
+        BenchUtil::Timer timer;
+        istringstream in(data);
+        vector<Book> books;
+        Book book;
+        while (in >> book) {
+            books.push_back(book);
+        }
+        report("stream", books.size(), timer.seconds(), data.size());
+    }
+
+    // RecordParser 解析并转换为 Book
+    static void runParser(const string &data) {
+        BenchUtil::Timer timer;
+        RecordParser parser(data.data(), data.size());
+        RecordParser::BookFields fields;
+        vector<Book> books;
+        while (parser.NextBook(fields)) {
+            books.push_back(fields.ToBook());
+        }
+        report("parser", books.size(), timer.seconds(), data.size());
+    }
+
+    // RecordParser 只解析字段
+    static void runFields(const string &data) {
+        BenchUtil::Timer timer;
+        RecordParser parser(data.data(), data.size());
+        RecordParser::BookFields fields;
+        size_t count = 0, checksum = 0;
+        while (parser.NextBook(fields)) {
+            ++count;
+            checksum += fields.id + fields.ISBN.size();  // 防止循环被优化掉
+        }
+        double seconds = timer.seconds();
+        report("fields", count, seconds, data.size());
+        if (checksum == 0) {
+            cout << endl;
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {1000000};
+    }
+
+    for (size_t n : sizes) {
+        string data = ParserBench::makeData(n);
+        cout << "n=" << n << "  " << BenchUtil::mib(data.size()) << " MiB" << endl;
+        ParserBench::runStream(data);
+        ParserBench::runParser(data);
+        ParserBench::runFields(data);
+    }
+    return 0;
+}
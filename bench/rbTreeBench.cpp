@@ -0,0 +1,354 @@
+// 红黑树微基准测试
+// 以 std::set / std::multiset / std::map / std::multimap 为对照, 测量 RbTree 与 BTree (B+ 树) 各操作的吞吐量:
+// insertUnique, insertEqual, 带提示插入 (end() 作提示), find, lowerBound, erase, 完整遍历, 复制构造
+// 键值顺序:
+// - sequential: 0, 1, 2, ... 递增
+// - random:     随机排列
+// - zipfian:    Zipf 分布 (θ = 0.99) 抽样, 少数热点键反复出现 (热点经随机排列打散到整个键空间)
+// 元素形状:
+// - set: 元素即 int 键值
+// - map: 元素为 (int 键值, int64 值)
+// 插入的键值为 2k, lowerBound 查询 2k + 1 (命中下一个元素), find 查询 2k (全部命中)
+// 规模较小时重复多轮取平均, 使每项测量至少覆盖约一百万次操作
+//
+// 用法: rbtree_bench [--json 结果文件] [规模...]
+// 默认: 1000 10000 100000 1000000 10000000
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bTree.h"
+#include "benchUtil.h"
+#include "rbTree.h"
+using namespace std;
+
+// 元素即键值
+struct SetShape {
+    typedef int Value;
+    struct KeyOf {
+        const int &operator()(const int &v) const { return v; }
+    };
+    typedef RbTree<int, Value, KeyOf, std::less<>> Tree;
+    typedef ::BTree<int, Value, KeyOf, std::less<>> BTree;
+    typedef set<int> Std;
+    typedef multiset<int> StdMulti;
+    static const char *name() { return "set"; }
+    static Value make(int k) { return k; }
+};
+
+// 元素为 (键值, 值)
+struct MapShape {
+    typedef pair<int, int64_t> Value;
+    struct KeyOf {
+        const int &operator()(const Value &v) const { return v.first; }
+    };
+    typedef RbTree<int, Value, KeyOf, std::less<>> Tree;
+    typedef ::BTree<int, Value, KeyOf, std::less<>> BTree;
+    typedef map<int, int64_t> Std;
+    typedef multimap<int, int64_t> StdMulti;
+    static const char *name() { return "map"; }
+    static Value make(int k) { return Value(k, k); }
+};
+
+// Zipf 分布生成器 (Gray 等人的方法, 与 YCSB 相同), 返回 [0, n) 中的名次, 名次越小越热
+class ZipfGenerator {
+private:
+    size_t n;
+    double theta, alpha, zetan, eta;
+
+public:
+    ZipfGenerator(size_t n, double theta) : n(n), theta(theta) {
+        double zeta2 = 1 + pow(0.5, theta);
+        zetan = 0;
+        for (size_t i = 1; i <= n; ++i) {
+            zetan += 1 / pow((double) i, theta);
+        }
+        alpha = 1 / (1 - theta);
+        eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetan);
+    }
+
+    size_t operator()(mt19937_64 &rng) {
+        double u = (double) (rng() >> 11) * (1.0 / 9007199254740992.0);  // [0, 1) 均匀分布
+        double uz = u * zetan;
+        if (uz < 1) {
+            return 0;
+        }
+        if (uz < 1 + pow(0.5, theta)) {
+            return 1;
+        }
+        return min(n - 1, (size_t) (n * pow(eta * u - eta + 1, alpha)));
+    }
+};
+
+class RbTreeBench {
+public:
+    // 一项测量结果
+    struct Result {
+        string container, shape, order, op;
+        size_t n;           // 规模 (参与操作的键值个数)
+        size_t ops;         // 每轮操作数
+        double seconds;     // 每轮平均耗时
+    };
+
+private:
+    vector<Result> results;
+
+    // 防止查询结果被优化掉
+    static volatile size_t sink;
+
+    // RbTree / BTree 与标准容器的统一接口, 重载决议优先匹配 RbTree 和 BTree 的版本
+    // (两种树的接口相同, 共用 treeInsertUnique 等实现)
+    template <class T, class V>
+    static void treeInsertUnique(T &t, const V &v) { t.insertUnique(v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertUnique(RbTree<K, V, KoV, C, A> &t, const V &v) { treeInsertUnique(t, v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertUnique(BTree<K, V, KoV, C, A> &t, const V &v) { treeInsertUnique(t, v); }
+    template <class S, class V>
+    static void insertUnique(S &s, const V &v) { s.insert(v); }
+
+    template <class T, class V>
+    static void treeInsertEqual(T &t, const V &v) { t.insertEqual(v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertEqual(RbTree<K, V, KoV, C, A> &t, const V &v) { treeInsertEqual(t, v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertEqual(BTree<K, V, KoV, C, A> &t, const V &v) { treeInsertEqual(t, v); }
+    template <class S, class V>
+    static void insertEqual(S &s, const V &v) { s.insert(v); }
+
+    template <class T, class V>
+    static void treeInsertHint(T &t, const V &v) { t.insertUnique(t.end(), v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertHint(RbTree<K, V, KoV, C, A> &t, const V &v) { treeInsertHint(t, v); }
+    template <class K, class V, class KoV, class C, class A>
+    static void insertHint(BTree<K, V, KoV, C, A> &t, const V &v) { treeInsertHint(t, v); }
+    template <class S, class V>
+    static void insertHint(S &s, const V &v) { s.insert(s.end(), v); }
+
+    template <class K, class V, class KoV, class C, class A>
+    static auto lowerBound(RbTree<K, V, KoV, C, A> &t, int k) { return t.lowerBound(k); }
+    template <class K, class V, class KoV, class C, class A>
+    static auto lowerBound(BTree<K, V, KoV, C, A> &t, int k) { return t.lowerBound(k); }
+    template <class S>
+    static auto lowerBound(S &s, int k) { return s.lower_bound(k); }
+
+    template <class T>
+    static bool treeEraseKey(T &t, int k) {
+        auto it = t.find(k);
+        if (it == t.end()) {
+            return false;
+        }
+        t.erase(it);
+        return true;
+    }
+    template <class K, class V, class KoV, class C, class A>
+    static bool eraseKey(RbTree<K, V, KoV, C, A> &t, int k) { return treeEraseKey(t, k); }
+    template <class K, class V, class KoV, class C, class A>
+    static bool eraseKey(BTree<K, V, KoV, C, A> &t, int k) { return treeEraseKey(t, k); }
+    template <class S>
+    static bool eraseKey(S &s, int k) { return s.erase(k) > 0; }
+
+    // 每项测量重复的轮数
+    static size_t repeats(size_t n) { return max<size_t>(1, 1000000 / max<size_t>(n, 1)); }
+
+    // 记录并输出一项结果
+    void report(const char *container, const char *shape, const char *order, size_t n,
+                const char *op, size_t ops, double seconds) {
+        results.push_back({container, shape, order, op, n, ops, seconds});
+        cout << container << "  " << shape << "  " << order << "  n=" << n << "  " << op << ": "
+             << BenchUtil::mops(ops, seconds) << " Mops/s" << endl;
+    }
+
+public:
+    // 对一种容器运行全部操作
+    // Unique 为不允许重复的容器, Multi 为允许重复的容器 (RbTree 与 BTree 两者相同)
+    template <class Shape, class Unique, class Multi>
+    void run(const char *container, const char *order, const vector<int> &keys) {
+        typedef typename Shape::Value Value;
+        size_t n = keys.size();
+        size_t reps = repeats(n);
+        vector<Value> values;
+        values.reserve(n);
+        for (int k : keys) {
+            values.push_back(Shape::make(2 * k));
+        }
+        BenchUtil::Timer timer;
+        double total;
+
+        // insertUnique: 每轮从空容器开始, 只计插入时间
+        total = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            Unique c;
+            timer.reset();
+            for (const Value &v : values) {
+                insertUnique(c, v);
+            }
+            total += timer.seconds();
+        }
+        report(container, Shape::name(), order, n, "insertUnique", n, total / reps);
+
+        // insertEqual
+        total = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            Multi c;
+            timer.reset();
+            for (const Value &v : values) {
+                insertEqual(c, v);
+            }
+            total += timer.seconds();
+        }
+        report(container, Shape::name(), order, n, "insertEqual", n, total / reps);
+
+        // 带提示插入: 以 end() 为提示, 递增序列命中快速路径, 其余顺序退化为普通插入
+        total = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            Unique c;
+            timer.reset();
+            for (const Value &v : values) {
+                insertHint(c, v);
+            }
+            total += timer.seconds();
+        }
+        report(container, Shape::name(), order, n, "insertHint", n, total / reps);
+
+        // 以下查询与遍历在同一个容器上进行
+        Unique c;
+        for (const Value &v : values) {
+            insertUnique(c, v);
+        }
+
+        // find: 按键值序列查询, 全部命中
+        size_t hits = 0;
+        timer.reset();
+        for (size_t r = 0; r < reps; ++r) {
+            for (int k : keys) {
+                hits += c.find(2 * k) != c.end();
+            }
+        }
+        report(container, Shape::name(), order, n, "find", n, timer.seconds() / reps);
+
+        // lowerBound: 查询相邻两个键值之间的位置
+        timer.reset();
+        for (size_t r = 0; r < reps; ++r) {
+            for (int k : keys) {
+                hits += lowerBound(c, 2 * k + 1) != c.end();
+            }
+        }
+        report(container, Shape::name(), order, n, "lowerBound", n, timer.seconds() / reps);
+
+        // 完整遍历
+        timer.reset();
+        for (size_t r = 0; r < reps; ++r) {
+            for (auto it = c.begin(); it != c.end(); ++it) {
+                ++hits;
+            }
+        }
+        report(container, Shape::name(), order, n, "iterate", c.size(), timer.seconds() / reps);
+
+        // 复制构造
+        total = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            timer.reset();
+            Unique copy(c);
+            total += timer.seconds();
+            hits += copy.size();
+        }
+        report(container, Shape::name(), order, n, "copy", c.size(), total / reps);
+
+        // erase: 按键值序列逐个删除 (重复出现的键值只有第一次命中)
+        total = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            Unique victim(c);
+            timer.reset();
+            for (int k : keys) {
+                hits += eraseKey(victim, 2 * k);
+            }
+            total += timer.seconds();
+        }
+        report(container, Shape::name(), order, n, "erase", n, total / reps);
+
+        sink = sink + hits;
+    }
+
+    // 以 JSON 格式写出全部结果
+    bool writeJson(const string &path) const {
+        ofstream out(path, ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << "{\n  \"benchmark\": \"rbtree_bench\",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &r = results[i];
+            out << (i ? "," : "") << "\n    {\"container\": \"" << r.container
+                << "\", \"shape\": \"" << r.shape << "\", \"order\": \"" << r.order
+                << "\", \"op\": \"" << r.op << "\", \"n\": " << r.n << ", \"ops\": " << r.ops
+                << ", \"seconds\": " << r.seconds
+                << ", \"ns_per_op\": " << (r.ops ? r.seconds * 1e9 / r.ops : 0)
+                << ", \"mops\": " << BenchUtil::mops(r.ops, r.seconds) << "}";
+        }
+        out << "\n  ]\n}\n";
+        return (bool) out;
+    }
+};
+
+volatile size_t RbTreeBench::sink = 0;
+
+int main(int argc, char *argv[]) {
+    string jsonPath;
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            sizes.push_back(stoul(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 10000, 100000, 1000000, 10000000};
+    }
+
+    RbTreeBench bench;
+    for (size_t n : sizes) {
+        // 三种键值顺序
+        vector<int> sequential(n);
+        for (size_t i = 0; i < n; ++i) {
+            sequential[i] = (int) i;
+        }
+        vector<int> random = sequential;
+        shuffle(random.begin(), random.end(), mt19937(42));
+        vector<int> zipfian(n);
+        ZipfGenerator zipf(n, 0.99);
+        mt19937_64 rng(42);
+        for (size_t i = 0; i < n; ++i) {
+            zipfian[i] = random[zipf(rng)];  // 借用随机排列把热点打散
+        }
+
+        const pair<const char *, const vector<int> *> orders[] = {
+                {"sequential", &sequential}, {"random", &random}, {"zipfian", &zipfian}};
+        for (const auto &order : orders) {
+            bench.run<SetShape, SetShape::Tree, SetShape::Tree>("RbTree", order.first, *order.second);
+            bench.run<SetShape, SetShape::BTree, SetShape::BTree>("BTree", order.first, *order.second);
+            bench.run<SetShape, SetShape::Std, SetShape::StdMulti>("std", order.first, *order.second);
+            bench.run<MapShape, MapShape::Tree, MapShape::Tree>("RbTree", order.first, *order.second);
+            bench.run<MapShape, MapShape::BTree, MapShape::BTree>("BTree", order.first, *order.second);
+            bench.run<MapShape, MapShape::Std, MapShape::StdMulti>("std", order.first, *order.second);
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        if (!bench.writeJson(jsonPath)) {
+            cout << "无法写入结果文件: " << jsonPath << endl;
+            return 1;
+        }
+        cout << "结果已写入 " << jsonPath << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// 合并基准测试
+// 把 m 个节点的树 B 并入 n 个节点的树 A (键值随机, 两树约有 1/4 的键值重复), 对比:
+// - 逐个 insertUnique: 遍历 B, 把每个值插入 A
+// - unionWith 单线程: 拆分 + 连接的分治合并, 不分配节点
+// - unionWith 多线程: 同上, 前几层的子问题在不同线程中进行 (硬件线程数大于 1 时才测量)
+// 每项测量前由有序键值重新建树, 建树时间不计入
+//
+// 用法: union_bench [规模...]
+// 默认: 1000000 4000000
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "benchUtil.h"
+#include "rbTree.h"
+using namespace std;
+
+// 元素即键值
+struct KeyOfInt {
+    const int &operator()(const int &v) const { return v; }
+};
+
+class UnionBench {
+public:
+    typedef RbTree<int, int, KeyOfInt, std::less<>> Tree;
+
+    // 输出一行结果
+    static void report(const char *what, size_t n, size_t m, double sec) {
+        cout << what << "  n=" << n << "  m=" << m
+             << "  " << sec * 1000 << " ms  (" << BenchUtil::mops(m, sec) << " M merged/s)" << endl;
+    }
+
+    // 从 [0, range) 中随机取 count 个不重复的键值, 升序返回
+    static vector<int> sample(size_t count, int range, mt19937 &rng) {
+        vector<int> keys;
+        keys.reserve(count * 2);
+        uniform_int_distribution<int> dist(0, range - 1);
+        while (keys.size() < count) {
+            for (size_t i = keys.size(); i < count; ++i) {
+                keys.push_back(dist(rng));
+            }
+            sort(keys.begin(), keys.end());
+            keys.erase(unique(keys.begin(), keys.end()), keys.end());
+        }
+        shuffle(keys.begin(), keys.end(), rng);
+        keys.resize(count);
+        sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    static void run(size_t n, size_t m, unsigned threads) {
+        mt19937 rng((unsigned) (n + m));
+        int range = (int) (n * 4);  // B 中约 1/4 的键值在 A 中已存在
+        vector<int> a = sample(n, range, rng), b = sample(m, range, rng);
+        cout << "-- n=" << n << " m=" << m << endl;
+        size_t expected;
+        {
+            Tree ta, tb;
+            ta.buildUnique(a.begin(), a.end());
+            tb.buildUnique(b.begin(), b.end());
+            BenchUtil::Timer timer;
+            for (Tree::iterator it = tb.begin(); it != tb.end(); ++it) {
+                ta.insertUnique(*it);
+            }
+            report("insertUnique x m     ", n, m, timer.seconds());
+            expected = ta.size();
+        }
+        unsigned counts[] = {1, threads};
+        for (unsigned t : counts) {
+            Tree ta, tb;
+            ta.buildUnique(a.begin(), a.end());
+            tb.buildUnique(b.begin(), b.end());
+            BenchUtil::Timer timer;
+            ta.unionWith(tb, t);
+            double sec = timer.seconds();
+            cout << "unionWith threads=" << t << (t < 10 ? " " : "") << " ";
+            report("", n, m, sec);
+            if (ta.size() != expected) {
+                cout << "合并结果错误" << endl;
+            }
+            if (t == threads) {
+                break;
+            }
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(stoul(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 4000000};
+    }
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    for (size_t n : sizes) {
+        UnionBench::run(n, n, threads);
+        UnionBench::run(n, n / 10, threads);
+        UnionBench::run(n, n / 100, threads);
+    }
+    return 0;
+}
@@ -20,6 +20,12 @@ public:
     // 析构函数
     ~Admin();
 
+    // 复制与移动 (移动时用户名和密码直接转移, 不重新分配)
+    Admin(const Admin &other) = default;
+    Admin(Admin &&other) noexcept = default;
+    Admin &operator=(const Admin &other) = default;
+    Admin &operator=(Admin &&other) noexcept = default;
+
     // 获取管理员用户名
     const string &GetAdminName() const;
 
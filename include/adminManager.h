@@ -1,6 +1,7 @@
 #ifndef LIBRARYMANAGEMENT_ADMINMANAGER_H
 #define LIBRARYMANAGEMENT_ADMINMANAGER_H
 
+#include <string_view>
 #include "admin.h"
 #include "rbTree.h"
 
@@ -45,6 +46,13 @@ public:
     // - false: 登录失败
     bool Login();
 
+    // 校验用户名和密码
+    // 比较函数是透明的 std::less<>, 以 string_view 直接在树中查找, 不构造临时字符串
+    // 返回值:
+    // - true: 用户名存在且密码匹配
+    // - false: 否则
+    bool Verify(string_view name, string_view password);
+
     // 保存管理员数据到文件
     // 参数:
     // - path: 保存路径
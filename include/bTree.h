@@ -0,0 +1,1278 @@
+#ifndef LIBRARYMANAGEMENT_BTREE_H
+#define LIBRARYMANAGEMENT_BTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "nodePool.h"
+#include "rbTree.h"
+using namespace std;
+
+// B+ 树中的一个值
+// 值单独分配, 不随键值在节点间移动, 因此插入和删除不会使其他值的迭代器失效 (与 RbTree 相同)
+template <class Value>
+struct BTreeRecord {
+    Value value;  // 存储的值
+    void *leaf;   // 所在的叶子节点 (节点分裂、合并时更新)
+
+    explicit BTreeRecord(const Value &v = Value()) : value(v), leaf(nullptr) {}
+};
+
+// 缓存友好的 B+ 树, 接口与 RbTree 相同, 可直接替换
+// - 每个节点的键值连续存放在一个数组中, 查找时在节点内二分, 一次下降只访问 O(log_B n) 个节点
+// - 值只存放在叶子节点中, 叶子节点之间以双向链表相连, 顺序遍历逐个扫描叶子的数组
+// - 内部节点记录每个子树的值个数, 按名次查找 (select / rank) 仍为 O(log n)
+// - 叶子节点只保存键值和指向值的指针, 值本身单独分配 (见 BTreeRecord), 迭代器在插入和删除其他值后仍然有效
+// Alloc: 值的分配策略, 默认使用节点池 (见 nodePool.h); 树节点本身数量很少, 直接使用 new / delete
+template <class Key, class Value, class KeyOfValue, class Compare,
+          class Alloc = NodePool<BTreeRecord<Value>>>
+class BTree {
+public:
+    typedef BTreeRecord<Value> Record;
+
+    // 每个节点最多容纳的键值 (子节点) 个数: 键值数组约占 512 字节 (8 条缓存行), 至少 16
+    static constexpr size_t Capacity = 512 / sizeof(Key) > 16 ? 512 / sizeof(Key) : 16;
+    // 非根节点至少容纳的个数 (递增追加产生的最后一个叶子节点除外, 见 _insertAt)
+    static constexpr size_t MinCount = Capacity / 2;
+
+private:
+    struct Inner;
+
+    // 节点的公共部分
+    struct NodeBase {
+        bool isLeaf;    // 是否为叶子节点
+        size_t count;   // 叶子节点: 值的个数; 内部节点: 子节点个数
+        Inner *parent;  // 父节点, 根节点为 nullptr
+        size_t slot;    // 在父节点 children 中的下标
+
+        explicit NodeBase(bool isLeaf) : isLeaf(isLeaf), count(0), parent(nullptr), slot(0) {}
+    };
+
+    // 叶子节点
+    struct Leaf : NodeBase {
+        Key keys[Capacity];         // 键值, 有序
+        Record *records[Capacity];  // 对应的值
+        Leaf *prev;                 // 前一个叶子节点 (第一个叶子节点的前一个是 header)
+        Leaf *next;                 // 后一个叶子节点 (最后一个叶子节点的后一个是 header)
+
+        Leaf() : NodeBase(true), prev(nullptr), next(nullptr) {}
+    };
+
+    // 内部节点
+    // keys[i] 为 children[i] 与 children[i + 1] 之间的分隔键:
+    // children[i] 子树中的键值都 <= keys[i], children[i + 1] 子树中的键值都 >= keys[i]
+    struct Inner : NodeBase {
+        Key keys[Capacity - 1];          // 分隔键
+        NodeBase *children[Capacity];    // 子节点
+        size_t sizes[Capacity];          // 各子树中值的个数 (用于按名次查找)
+
+        Inner() : NodeBase(false) {}
+    };
+
+public:
+    // 迭代器
+    // 指向一个值, 并缓存该值所在的叶子节点和下标, 使顺序遍历每一步为 O(1);
+    // 值在节点间移动后缓存失效, 使用前先核对, 失效时重新定位, 因此迭代器本身始终有效
+    template <class Ref, class Ptr>
+    struct IteratorBase {
+        typedef IteratorBase<Value &, Value *> iterator;
+        typedef IteratorBase<Ref, Ptr> Self;
+
+        Record *rec;   // 指向的值 (end() 指向 header 中的哨兵)
+        Leaf *leaf;    // 缓存的所在叶子节点
+        size_t slot;   // 缓存的在叶子节点中的下标
+
+        // 默认构造函数
+        IteratorBase() : rec(nullptr), leaf(nullptr), slot(0) {}
+
+        // 构造函数, 指向叶子节点 l 中下标为 s 的值 r
+        IteratorBase(Record *r, Leaf *l, size_t s) : rec(r), leaf(l), slot(s) {}
+
+        // 复制构造函数和赋值运算符
+        IteratorBase(const IteratorBase &) = default;
+        IteratorBase &operator=(const IteratorBase &) = default;
+
+        // 由普通迭代器转换为常量迭代器 (模板构造函数不是复制构造函数, 不与上面的默认版本冲突)
+        template <class R, class P, class = typename enable_if<
+                is_same<IteratorBase<R, P>, iterator>::value && !is_same<iterator, Self>::value>::type>
+        IteratorBase(const IteratorBase<R, P> &it) : rec(it.rec), leaf(it.leaf), slot(it.slot) {}
+
+        // 解引用运算符, 返回当前值
+        Ref operator*() const { return rec->value; }
+
+        // 箭头运算符, 返回当前值的指针
+        Ptr operator->() const { return &(operator*()); }
+
+        // 核对缓存的位置, 失效时重新定位
+        void sync() {
+            Leaf *l = static_cast<Leaf *>(rec->leaf);
+            if (l != leaf || slot >= l->count || l->records[slot] != rec) {
+                leaf = l;
+                slot = _slotOf(l, rec);
+            }
+        }
+
+        // 后继: 同一叶子节点的下一个, 或下一个叶子节点的第一个
+        void increment() {
+            sync();
+            if (slot + 1 < leaf->count) {
+                ++slot;
+            } else {
+                leaf = leaf->next;
+                slot = 0;
+            }
+            rec = leaf->records[slot];  // 走过最后一个叶子节点时落到 header 中的哨兵
+        }
+
+        // 前驱: 同一叶子节点的前一个, 或前一个叶子节点的最后一个
+        void decrement() {
+            sync();
+            if (slot > 0) {
+                --slot;
+            } else {
+                leaf = leaf->prev;
+                slot = leaf->count - 1;
+            }
+            rec = leaf->records[slot];
+        }
+
+        Self &operator++() {
+            increment();
+            return *this;
+        }
+
+        Self operator++(int) {
+            Self tmp = *this;
+            increment();
+            return tmp;
+        }
+
+        Self &operator--() {
+            decrement();
+            return *this;
+        }
+
+        Self operator--(int) {
+            Self tmp = *this;
+            decrement();
+            return tmp;
+        }
+
+        // 比较运算符, 只比较指向的值
+        bool operator==(const Self &y) const { return rec == y.rec; }
+        bool operator!=(const Self &y) const { return rec != y.rec; }
+    };
+
+    typedef Value *Ptr;
+    typedef const Value *constPtr;
+    typedef Value &Ref;
+    typedef const Value &constRef;
+    typedef IteratorBase<Ref, Ptr> iterator;
+    typedef IteratorBase<constRef, constPtr> constIterator;
+    typedef NodeBase *NodePtr;
+
+private:
+    // 内部成员变量
+    size_t nodeCount;      // 值的总数
+    Compare keyCompare;    // 键值比较函数对象
+    Alloc nodeAllocator;   // 值的分配器
+    NodeBase *root;        // 根节点, 空树为 nullptr
+    Leaf *header;          // 叶子链表的头 (不存放值), records[0] 为 end() 指向的哨兵
+#ifdef RBTREE_STATS
+    RbTreeStats counters;  // 结构统计计数器 (只使用查找次数与比较次数)
+#endif
+
+    // 取得值的键值
+    static const Key &key(const Value &v) { return KeyOfValue()(v); }
+
+    // 在叶子节点 l 中定位值 r 的下标 (先二分定位键值, 再在相等的键值中找到 r)
+    static size_t _slotOf(Leaf *l, Record *r);
+
+    // 在有序数组 keys[0, n) 中二分查找, 返回首个 >= k (或 > k) 的下标
+    // compares 不为空时累计比较次数
+    size_t _lowerIndex(const Key *keys, size_t n, const Key &k, size_t *compares = nullptr) const;
+    size_t _upperIndex(const Key *keys, size_t n, const Key &k) const;
+
+    // 从根节点下降到叶子节点, upper 为 false 时走向首个 >= k 的值所在的叶子, 否则走向首个 > k 的值所在的叶子
+    Leaf *_descend(const Key &k, bool upper, size_t *compares = nullptr) const;
+
+    // 子树中值的个数
+    static size_t _size(NodeBase *x);
+    // 子树中的最小键值
+    static const Key &_minKey(NodeBase *x);
+    // 节点 x 的值个数变化 delta 后, 更新所有祖先中的子树大小
+    static void _addSize(NodeBase *x, ptrdiff_t delta);
+
+    // 从分配器取得内存并构造一个值
+    Record *_createRecord(const Value &v);
+    // 析构值并将内存归还给分配器
+    void _destroyRecord(Record *r);
+
+    // 空树插入第一个值前建立空的根叶子节点
+    Leaf *_emptyRoot();
+    // 在叶子节点 l 的下标 pos 处插入新值 (叶子节点已满时先分裂), 返回指向新值的迭代器
+    iterator _insertAt(Leaf *l, size_t pos, const Value &v);
+    // 把叶子节点 l 中下标 at 之后的值移入新的右兄弟, 分隔键为 sep, 返回新节点
+    Leaf *_splitLeaf(Leaf *l, size_t at, const Key &sep);
+    // 在 left 之后插入新的兄弟节点 right, 分隔键为 sep (父节点已满时递归分裂, 根节点分裂时树长高一层)
+    void _insertChild(NodeBase *left, const Key &sep, NodeBase *right);
+    // 在未满的内部节点 p 的下标 pos (>= 1) 处插入子节点, 其左侧的分隔键为 sep
+    void _insertChildAt(Inner *p, size_t pos, const Key &sep, NodeBase *child);
+
+    // 删除后叶子节点 l 不足 MinCount 时, 从兄弟借一个值或与兄弟合并
+    void _fixLeaf(Leaf *l);
+    // 删除子节点后内部节点 n 不足 MinCount 时, 从兄弟借一个子节点或与兄弟合并
+    void _fixInner(Inner *n);
+    // 移除内部节点 p 的第 s 个子节点 (节点本身由调用者释放), 必要时继续向上调整
+    void _removeChild(Inner *p, size_t s);
+
+    // 释放以 x 为根的整棵子树 (值由 clear 统一处理)
+    void _destroyNodes(NodeBase *x);
+
+    // 由 n 个有序的值 get(0), get(1), ... 自底向上构造整棵树, 各层节点均匀装填
+    template <class Get>
+    void _buildSorted(size_t n, Get get);
+    // 检查有序区间是否满足插入要求 (unique 为 true 时要求严格递增, 否则要求非递减)
+    template <class RandomIt>
+    bool _isSorted(RandomIt first, RandomIt last, bool unique) const;
+    // 批量构造的实现, unique 表示键值是否允许重复
+    template <class RandomIt>
+    bool _build(RandomIt first, RandomIt last, bool unique);
+    // 按 RbTree::_buildSorted 的形状先序遍历有序序列 order[lo, hi)
+    template <class Visit>
+    static void _preorder(const vector<Record *> &order, size_t lo, size_t hi, int depth, int redDepth,
+                          Visit &visit);
+    // 读取先序序列中以当前节点为根的子树, 按中序追加到 values
+    template <class Next>
+    static void _readPreorder(Next &next, size_t &remaining, bool &ok, vector<Value> &values);
+
+    // 空树的初始化
+    void _emptyInitialize() {
+        header = new Leaf();
+        header->prev = header;  // 叶子链表为空时 header 自成环
+        header->next = header;
+        header->records[0] = new Record();  // end() 指向的哨兵
+        header->records[0]->leaf = header;
+        root = nullptr;
+    }
+
+    // 调试和验证
+    // 检查以 x 为根的子树: 键值范围、父节点与下标、子树大小、值所在的叶子, 返回子树中值的个数
+    size_t _verifyNode(NodeBase *x, const Key *low, const Key *high, size_t depth, size_t &leafDepth,
+                       bool &ok) const;
+    // 判断 B+ 树是否正确
+    bool _verify() const;
+
+public:
+    // 构造函数与析构函数
+    explicit BTree(const Compare &comp = Compare()) : nodeCount(0), keyCompare(comp) { _emptyInitialize(); }
+    // 复制构造函数, 按顺序取出所有值后批量构造
+    BTree(const BTree<Key, Value, KeyOfValue, Compare, Alloc> &t) : nodeCount(0), keyCompare(t.keyCompare) {
+        _emptyInitialize();
+        *this = t;
+    }
+    // 析构函数
+    ~BTree() {
+        clear();
+        delete header->records[0];
+        delete header;
+    }
+
+    // 运算符重载
+    BTree &operator=(const BTree &x);
+
+    // 树的基本信息
+    bool empty() const { return nodeCount == 0; }
+    size_t size() const { return nodeCount; }
+    void clear();
+
+    // 迭代器
+    // 返回指向起始的迭代器 (第一个叶子节点的第一个值; 空树时 header->next 即 header, 得到 end())
+    iterator begin() { return iterator(header->next->records[0], header->next, 0); }
+    constIterator begin() const { return iterator(header->next->records[0], header->next, 0); }
+    // 返回指向末尾的迭代器 (header 中的哨兵)
+    iterator end() { return iterator(header->records[0], header, 0); }
+    constIterator end() const { return iterator(header->records[0], header, 0); }
+
+    // 插入操作 (语义与 RbTree 相同)
+    // 插入新值, 键值不允许重复, 若重复则插入无效
+    pair<iterator, bool> insertUnique(const Value &v);
+    // 插入新值, 键值允许重复 (插在相同键值之后)
+    iterator insertEqual(const Value &v);
+    // 在指定位置之前插入新值, 位置正确时省去查找 (以 end() 为提示追加递增的键值只需 O(1) 均摊时间)
+    iterator insertUnique(iterator position, const Value &v);
+    iterator insertEqual(iterator position, const Value &v);
+
+    // 批量构造
+    // 由按键值有序的区间 [first, last) 在 O(n) 时间内自底向上直接构造
+    // 仅当树为空且区间有序时走线性构造; 否则退化为逐个插入, 返回是否使用了线性构造
+    template <class RandomIt>
+    bool buildUnique(RandomIt first, RandomIt last) { return _build(first, last, true); }
+    template <class RandomIt>
+    bool buildEqual(RandomIt first, RandomIt last) { return _build(first, last, false); }
+
+    // 形状序列化 (与 RbTree 的快照格式兼容)
+    // 按 RbTree 批量构造得到的形状和颜色先序遍历所有值, 对每个值调用 visit(值, 颜色, 是否有左子节点, 是否有右子节点)
+    template <class Visit>
+    void preorder(Visit visit) const;
+    // 读取 preorder (或 RbTree::preorder) 产生的 n 个节点的序列, 按中序取出所有值后批量构造, 颜色被忽略
+    // 仅用于空树; 序列不合法时返回 false, 树保持为空
+    template <class Next>
+    bool buildPreorder(size_t n, Next next);
+
+    // 删除操作
+    // 移除指定位置的值
+    void erase(iterator position);
+
+    // 查询操作
+    // 寻找键值为 k 的值的迭代器
+    iterator find(const Key &k);
+    // 按名次查找, 返回第 k 个 (从 0 开始) 值的迭代器, k 越界时返回 end()
+    iterator select(size_t k);
+    // 返回键值小于 k 的值的个数, 即 lowerBound(k) 的名次
+    size_t rank(const Key &k);
+    // 返回键值为 k 的区间
+    pair<iterator, iterator> equalRange(const Key &k);
+    // 返回首个 >= k 的值的迭代器
+    iterator lowerBound(const Key &k);
+    // 返回首个 > k 的值的迭代器
+    iterator upperBound(const Key &k);
+
+    // 按顺序输出所有键值
+    void inOrderTraversal() const;
+    void inOrderTraversal(NodePtr root) const;
+
+    // 删除最大键值的函数
+    void removeRightmost();
+
+    // 获取根节点
+    NodePtr rootNode() const {
+        return root;
+    }
+
+    // 结构统计
+    // 高度为节点层数 (所有值都在最底层, 平均深度即高度), B+ 树没有颜色, 黑高为 0;
+    // 开启 RBTREE_STATS 时累计查找次数与比较次数, 旋转和着色计数始终为 0
+    RbTreeStats stats() const;
+    // 清零计数器
+    void resetStats();
+};
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::_slotOf(Leaf *l, Record *r) {
+    if (l->count == 0) {
+        return 0;  // header 中的哨兵
+    }
+    const Key &k = key(r->value);
+    Compare comp;
+    size_t lo = 0, hi = l->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (comp(l->keys[mid], k)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    while (l->records[lo] != r) {  // 键值重复时顺序找到 r
+        ++lo;
+    }
+    return lo;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::_lowerIndex(const Key *keys, size_t n, const Key &k,
+                                                                  size_t *compares) const {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compares != nullptr) {
+            ++*compares;
+        }
+        if (keyCompare(keys[mid], k)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::_upperIndex(const Key *keys, size_t n,
+                                                                  const Key &k) const {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (keyCompare(k, keys[mid])) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::Leaf *
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::_descend(const Key &k, bool upper, size_t *compares) const {
+    NodeBase *x = root;
+    while (!x->isLeaf) {
+        Inner *in = static_cast<Inner *>(x);
+        // 分隔键等于 k 时: 找 >= k 走左侧 (左子树可能有等于 k 的值), 找 > k 走右侧
+        size_t i = upper ? _upperIndex(in->keys, in->count - 1, k)
+                         : _lowerIndex(in->keys, in->count - 1, k, compares);
+        x = in->children[i];
+    }
+    return static_cast<Leaf *>(x);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::_size(NodeBase *x) {
+    if (x->isLeaf) {
+        return x->count;
+    }
+    Inner *in = static_cast<Inner *>(x);
+    size_t total = 0;
+    for (size_t i = 0; i < in->count; ++i) {
+        total += in->sizes[i];
+    }
+    return total;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+const Key &BTree<Key, Value, KeyOfValue, Compare, Alloc>::_minKey(NodeBase *x) {
+    while (!x->isLeaf) {
+        x = static_cast<Inner *>(x)->children[0];
+    }
+    return static_cast<Leaf *>(x)->keys[0];
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_addSize(NodeBase *x, ptrdiff_t delta) {
+    for (; x->parent != nullptr; x = x->parent) {
+        x->parent->sizes[x->slot] += delta;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::Record *
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::_createRecord(const Value &v) {
+    Record *r = nodeAllocator.allocate();
+    try {
+        new (r) Record(v);  // 在分配的内存上构造值
+    } catch (...) {
+        nodeAllocator.deallocate(r);  // 构造失败时归还内存
+        throw;
+    }
+    return r;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_destroyRecord(Record *r) {
+    r->~Record();
+    nodeAllocator.deallocate(r);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::Leaf *
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::_emptyRoot() {
+    Leaf *l = new Leaf();
+    l->prev = header;
+    l->next = header;
+    header->prev = l;
+    header->next = l;
+    root = l;
+    return l;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::_insertAt(Leaf *l, size_t pos, const Value &v) {
+    Record *r = _createRecord(v);
+    if (l->count == Capacity) {
+        // 在最后一个叶子节点末尾追加 (如递增的书籍编号) 时不平分, 新叶子只放新值,
+        // 前面的叶子保持满载; 其余情况平分, 新值在分裂点时留在左侧 (右侧的值都不小于分隔键)
+        bool append = pos == Capacity && l->next == header;
+        size_t at = append ? Capacity : Capacity / 2;
+        Leaf *right = _splitLeaf(l, at, append ? key(v) : l->keys[at]);
+        if (append || pos > at) {
+            l = right;
+            pos -= at;
+        }
+    }
+    for (size_t i = l->count; i > pos; --i) {  // 后面的键值和值右移一格
+        l->keys[i] = move(l->keys[i - 1]);
+        l->records[i] = l->records[i - 1];
+    }
+    l->keys[pos] = key(v);
+    l->records[pos] = r;
+    r->leaf = l;
+    ++l->count;
+    _addSize(l, 1);
+    ++nodeCount;
+    return iterator(r, l, pos);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::Leaf *
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::_splitLeaf(Leaf *l, size_t at, const Key &sep) {
+    Key separator = sep;  // sep 可能引用 l 中即将移走的键值, 先复制
+    Leaf *right = new Leaf();
+    for (size_t i = at; i < l->count; ++i) {
+        right->keys[i - at] = move(l->keys[i]);
+        right->records[i - at] = l->records[i];
+        l->records[i]->leaf = right;
+    }
+    right->count = l->count - at;
+    l->count = at;
+    // 接入叶子链表
+    right->prev = l;
+    right->next = l->next;
+    l->next->prev = right;
+    l->next = right;
+    _insertChild(l, separator, right);
+    return right;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_insertChild(NodeBase *left, const Key &sep,
+                                                                 NodeBase *right) {
+    Inner *p = left->parent;
+    if (p == nullptr) {  // left 是根节点, 树长高一层
+        p = new Inner();
+        p->count = 1;
+        p->children[0] = left;
+        left->parent = p;
+        left->slot = 0;
+        root = p;
+    }
+    size_t pos = left->slot + 1;
+    p->sizes[left->slot] = _size(left);  // left 分出了一部分, 重新计算
+    if (p->count < Capacity) {
+        _insertChildAt(p, pos, sep, right);
+        return;
+    }
+
+    // 父节点已满: 平分为 p 与新节点 q, 中间的分隔键上移到祖父节点
+    size_t at = Capacity / 2;
+    Key up = move(p->keys[at - 1]);
+    Inner *q = new Inner();
+    for (size_t i = at; i < p->count; ++i) {
+        q->children[i - at] = p->children[i];
+        q->sizes[i - at] = p->sizes[i];
+        q->children[i - at]->parent = q;
+        q->children[i - at]->slot = i - at;
+    }
+    for (size_t i = at; i + 1 < p->count; ++i) {
+        q->keys[i - at] = move(p->keys[i]);
+    }
+    q->count = p->count - at;
+    p->count = at;
+    if (pos > at) {
+        _insertChildAt(q, pos - at, sep, right);
+    } else {
+        _insertChildAt(p, pos, sep, right);
+    }
+    _insertChild(p, up, q);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_insertChildAt(Inner *p, size_t pos, const Key &sep,
+                                                                   NodeBase *child) {
+    for (size_t i = p->count; i > pos; --i) {  // 后面的子节点右移一格
+        p->children[i] = p->children[i - 1];
+        p->sizes[i] = p->sizes[i - 1];
+        p->children[i]->slot = i;
+    }
+    for (size_t i = p->count - 1; i >= pos; --i) {  // 分隔键 keys[pos - 1, count - 1) 右移一格
+        p->keys[i] = move(p->keys[i - 1]);
+    }
+    p->keys[pos - 1] = sep;
+    p->children[pos] = child;
+    p->sizes[pos] = _size(child);
+    child->parent = p;
+    child->slot = pos;
+    ++p->count;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_fixLeaf(Leaf *l) {
+    Inner *p = l->parent;
+    size_t s = l->slot;
+    Leaf *left = s > 0 ? static_cast<Leaf *>(p->children[s - 1]) : nullptr;
+    Leaf *right = s + 1 < p->count ? static_cast<Leaf *>(p->children[s + 1]) : nullptr;
+
+    if (left != nullptr && left->count > MinCount) {
+        // 从左兄弟借最后一个值
+        for (size_t i = l->count; i > 0; --i) {
+            l->keys[i] = move(l->keys[i - 1]);
+            l->records[i] = l->records[i - 1];
+        }
+        --left->count;
+        l->keys[0] = move(left->keys[left->count]);
+        l->records[0] = left->records[left->count];
+        l->records[0]->leaf = l;
+        ++l->count;
+        p->keys[s - 1] = l->keys[0];
+        --p->sizes[s - 1];
+        ++p->sizes[s];
+    } else if (right != nullptr && right->count > MinCount) {
+        // 从右兄弟借第一个值
+        l->keys[l->count] = move(right->keys[0]);
+        l->records[l->count] = right->records[0];
+        l->records[l->count]->leaf = l;
+        ++l->count;
+        for (size_t i = 0; i + 1 < right->count; ++i) {
+            right->keys[i] = move(right->keys[i + 1]);
+            right->records[i] = right->records[i + 1];
+        }
+        --right->count;
+        p->keys[s] = right->keys[0];
+        ++p->sizes[s];
+        --p->sizes[s + 1];
+    } else {
+        // 兄弟也不富余, 两者合并后不超过 Capacity; 统一把右边的节点并入左边
+        size_t keep = left != nullptr ? s - 1 : s;
+        Leaf *a = static_cast<Leaf *>(p->children[keep]);
+        Leaf *b = static_cast<Leaf *>(p->children[keep + 1]);
+        for (size_t i = 0; i < b->count; ++i) {
+            a->keys[a->count + i] = move(b->keys[i]);
+            a->records[a->count + i] = b->records[i];
+            b->records[i]->leaf = a;
+        }
+        a->count += b->count;
+        a->next = b->next;  // 从叶子链表中摘除 b
+        b->next->prev = a;
+        p->sizes[keep] = a->count;
+        _removeChild(p, keep + 1);
+        delete b;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_fixInner(Inner *n) {
+    Inner *p = n->parent;
+    size_t s = n->slot;
+    Inner *left = s > 0 ? static_cast<Inner *>(p->children[s - 1]) : nullptr;
+    Inner *right = s + 1 < p->count ? static_cast<Inner *>(p->children[s + 1]) : nullptr;
+
+    if (left != nullptr && left->count > MinCount) {
+        // 从左兄弟借最后一个子节点, 父节点中的分隔键下移, 左兄弟的最后一个分隔键上移
+        for (size_t i = n->count; i > 0; --i) {
+            n->children[i] = n->children[i - 1];
+            n->sizes[i] = n->sizes[i - 1];
+            n->children[i]->slot = i;
+        }
+        for (size_t i = n->count - 1; i > 0; --i) {
+            n->keys[i] = move(n->keys[i - 1]);
+        }
+        n->keys[0] = move(p->keys[s - 1]);
+        --left->count;
+        n->children[0] = left->children[left->count];
+        n->sizes[0] = left->sizes[left->count];
+        n->children[0]->parent = n;
+        n->children[0]->slot = 0;
+        p->keys[s - 1] = move(left->keys[left->count - 1]);
+        ++n->count;
+        p->sizes[s - 1] -= n->sizes[0];
+        p->sizes[s] += n->sizes[0];
+    } else if (right != nullptr && right->count > MinCount) {
+        // 从右兄弟借第一个子节点
+        size_t moved = right->sizes[0];
+        n->keys[n->count - 1] = move(p->keys[s]);
+        n->children[n->count] = right->children[0];
+        n->sizes[n->count] = moved;
+        n->children[n->count]->parent = n;
+        n->children[n->count]->slot = n->count;
+        ++n->count;
+        p->keys[s] = move(right->keys[0]);
+        for (size_t i = 0; i + 1 < right->count; ++i) {
+            right->children[i] = right->children[i + 1];
+            right->sizes[i] = right->sizes[i + 1];
+            right->children[i]->slot = i;
+        }
+        for (size_t i = 0; i + 2 < right->count; ++i) {
+            right->keys[i] = move(right->keys[i + 1]);
+        }
+        --right->count;
+        p->sizes[s] += moved;
+        p->sizes[s + 1] -= moved;
+    } else {
+        // 与兄弟合并, 父节点中的分隔键下移到合并后的节点中
+        size_t keep = left != nullptr ? s - 1 : s;
+        Inner *a = static_cast<Inner *>(p->children[keep]);
+        Inner *b = static_cast<Inner *>(p->children[keep + 1]);
+        a->keys[a->count - 1] = move(p->keys[keep]);
+        for (size_t i = 0; i < b->count; ++i) {
+            a->children[a->count + i] = b->children[i];
+            a->sizes[a->count + i] = b->sizes[i];
+            b->children[i]->parent = a;
+            b->children[i]->slot = a->count + i;
+        }
+        for (size_t i = 0; i + 1 < b->count; ++i) {
+            a->keys[a->count + i] = move(b->keys[i]);
+        }
+        a->count += b->count;
+        p->sizes[keep] += p->sizes[keep + 1];
+        _removeChild(p, keep + 1);
+        delete b;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_removeChild(Inner *p, size_t s) {
+    for (size_t i = s; i + 1 < p->count; ++i) {
+        p->children[i] = p->children[i + 1];
+        p->sizes[i] = p->sizes[i + 1];
+        p->children[i]->slot = i;
+    }
+    // 移除第一个子节点时去掉它右侧的分隔键, 否则去掉左侧的分隔键
+    for (size_t i = s > 0 ? s - 1 : 0; i + 2 < p->count; ++i) {
+        p->keys[i] = move(p->keys[i + 1]);
+    }
+    --p->count;
+
+    if (p == root) {
+        if (p->count == 1) {  // 根节点只剩一个子节点, 树降低一层
+            root = p->children[0];
+            root->parent = nullptr;
+            root->slot = 0;
+            delete p;
+        }
+    } else if (p->count < MinCount) {
+        _fixInner(p);
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_destroyNodes(NodeBase *x) {
+    if (!x->isLeaf) {
+        Inner *in = static_cast<Inner *>(x);
+        for (size_t i = 0; i < in->count; ++i) {
+            _destroyNodes(in->children[i]);
+        }
+        delete in;
+    } else {
+        delete static_cast<Leaf *>(x);
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class Get>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_buildSorted(size_t n, Get get) {
+    // 叶子层: 把 n 个值均匀分到 ceil(n / Capacity) 个叶子中, 每个叶子至少 Capacity / 2 个 (只有一个叶子时除外)
+    vector<NodeBase *> level;
+    size_t leaves = (n + Capacity - 1) / Capacity;
+    size_t index = 0;
+    for (size_t j = 0; j < leaves; ++j) {
+        Leaf *l = new Leaf();
+        l->count = n / leaves + (j < n % leaves);
+        for (size_t i = 0; i < l->count; ++i) {
+            l->records[i] = _createRecord(get(index++));
+            l->records[i]->leaf = l;
+            l->keys[i] = key(l->records[i]->value);
+        }
+        l->prev = header->prev;  // 接到叶子链表末尾
+        l->next = header;
+        header->prev->next = l;
+        header->prev = l;
+        level.push_back(l);
+    }
+
+    // 内部节点层: 同样均匀分组, 直到只剩一个根节点
+    while (level.size() > 1) {
+        size_t m = level.size();
+        size_t parents = (m + Capacity - 1) / Capacity;
+        vector<NodeBase *> upper;
+        size_t c = 0;
+        for (size_t j = 0; j < parents; ++j) {
+            Inner *p = new Inner();
+            p->count = m / parents + (j < m % parents);
+            for (size_t i = 0; i < p->count; ++i) {
+                NodeBase *child = level[c++];
+                p->children[i] = child;
+                p->sizes[i] = _size(child);
+                child->parent = p;
+                child->slot = i;
+                if (i > 0) {
+                    p->keys[i - 1] = _minKey(child);
+                }
+            }
+            upper.push_back(p);
+        }
+        level.swap(upper);
+    }
+    root = level[0];
+    nodeCount = n;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class RandomIt>
+bool BTree<Key, Value, KeyOfValue, Compare, Alloc>::_isSorted(RandomIt first, RandomIt last,
+                                                              bool unique) const {
+    if (first == last) {
+        return true;
+    }
+    for (RandomIt prev = first++; first != last; prev = first++) {
+        const Key &a = key(*prev);
+        const Key &b = key(*first);
+        // unique: 要求 a < b; 否则要求 !(b < a)
+        if (unique ? !keyCompare(a, b) : keyCompare(b, a)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class RandomIt>
+bool BTree<Key, Value, KeyOfValue, Compare, Alloc>::_build(RandomIt first, RandomIt last, bool unique) {
+    if (!empty() || !_isSorted(first, last, unique)) {
+        // 退化路径: 逐个插入, 对有序输入以 end() 为提示可省去查找
+        for (; first != last; ++first) {
+            if (unique) {
+                insertUnique(end(), *first);
+            } else {
+                insertEqual(end(), *first);
+            }
+        }
+        return false;
+    }
+    if (first != last) {
+        _buildSorted(last - first, [&first](size_t i) -> const Value & { return first[i]; });
+    }
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class Visit>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_preorder(const vector<Record *> &order, size_t lo,
+                                                              size_t hi, int depth, int redDepth,
+                                                              Visit &visit) {
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;  // 与 RbTree::_buildSorted 相同: 区间中点为子树根
+        visit(order[mid]->value, depth == redDepth ? Red : Black, lo < mid, mid + 1 < hi);
+        _preorder(order, lo, mid, depth + 1, redDepth, visit);  // 先递归左子树
+        lo = mid + 1;  // 右子树用循环代替尾递归
+        ++depth;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class Visit>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::preorder(Visit visit) const {
+    vector<Record *> order;
+    order.reserve(nodeCount);
+    for (Leaf *l = header->next; l != header; l = l->next) {
+        order.insert(order.end(), l->records, l->records + l->count);
+    }
+    // 树高与染红的层数与 RbTree::_build 相同
+    int h = 0;
+    while ((size_t(2) << h) <= nodeCount) {
+        ++h;
+    }
+    _preorder(order, 0, order.size(), 0, h > 0 ? h : -1, visit);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class Next>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::_readPreorder(Next &next, size_t &remaining, bool &ok,
+                                                                  vector<Value> &values) {
+    Value v;
+    Color c;
+    bool hasLeft, hasRight;
+    if (remaining == 0 || !next(v, c, hasLeft, hasRight)) {
+        ok = false;  // 序列提前结束或读取失败
+        return;
+    }
+    --remaining;
+    if (hasLeft && ok) {
+        _readPreorder(next, remaining, ok, values);
+    }
+    values.push_back(move(v));
+    if (hasRight && ok) {
+        _readPreorder(next, remaining, ok, values);
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+template <class Next>
+bool BTree<Key, Value, KeyOfValue, Compare, Alloc>::buildPreorder(size_t n, Next next) {
+    if (!empty()) {
+        return false;
+    }
+    if (n == 0) {
+        return true;
+    }
+    vector<Value> values;
+    size_t remaining = n;
+    bool ok = true;
+    _readPreorder(next, remaining, ok, values);
+    if (!ok || remaining != 0) {
+        return false;
+    }
+    _build(values.begin(), values.end(), false);
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+BTree<Key, Value, KeyOfValue, Compare, Alloc>
+&BTree<Key, Value, KeyOfValue, Compare, Alloc>::operator=(const BTree<Key, Value, KeyOfValue, Compare, Alloc> &x) {
+    if (this != &x) {
+        clear();
+        keyCompare = x.keyCompare;
+        // 已按顺序存放在 x 的叶子中, 收集指针后直接批量构造
+        vector<const Value *> order;
+        order.reserve(x.nodeCount);
+        for (Leaf *l = x.header->next; l != x.header; l = l->next) {
+            for (size_t i = 0; i < l->count; ++i) {
+                order.push_back(&l->records[i]->value);
+            }
+        }
+        if (!order.empty()) {
+            _buildSorted(order.size(), [&order](size_t i) -> const Value & { return *order[i]; });
+        }
+    }
+    return *this;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::clear() {
+    if (root == nullptr) {
+        return;
+    }
+    for (Leaf *l = header->next; l != header; l = l->next) {
+        for (size_t i = 0; i < l->count; ++i) {
+            if (!Alloc::canRelease) {
+                _destroyRecord(l->records[i]);
+            } else if (!is_trivially_destructible<Value>::value) {
+                l->records[i]->~Record();  // 内存稍后一次性归还
+            }
+        }
+    }
+    if (Alloc::canRelease) {
+        nodeAllocator.release();
+    }
+    _destroyNodes(root);
+    root = nullptr;
+    header->prev = header;
+    header->next = header;
+    nodeCount = 0;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::insertUnique(const Value &v) {
+    if (root == nullptr) {
+        return pair<iterator, bool>(_insertAt(_emptyRoot(), 0, v), true);
+    }
+    const Key &k = key(v);
+    Leaf *l = _descend(k, false);
+    size_t pos = _lowerIndex(l->keys, l->count, k);
+    if (pos < l->count) {
+        if (!keyCompare(k, l->keys[pos])) {  // 键值重复
+            return pair<iterator, bool>(iterator(l->records[pos], l, pos), false);
+        }
+    } else if (l->next != header && !keyCompare(k, l->next->keys[0])) {
+        // 叶子中的键值都 < k, 后一个叶子的第一个键值 >= k, 相等时重复
+        return pair<iterator, bool>(iterator(l->next->records[0], l->next, 0), false);
+    }
+    return pair<iterator, bool>(_insertAt(l, pos, v), true);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::insertEqual(const Value &v) {
+    if (root == nullptr) {
+        return _insertAt(_emptyRoot(), 0, v);
+    }
+    const Key &k = key(v);
+    Leaf *l = _descend(k, true);
+    return _insertAt(l, _upperIndex(l->keys, l->count, k), v);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::insertUnique(iterator position, const Value &v) {
+    if (root == nullptr) {
+        return insertUnique(v).first;
+    }
+    const Key &k = key(v);
+    if (position == end()) {
+        // 追加到最后一个叶子节点末尾
+        Leaf *last = header->prev;
+        if (keyCompare(last->keys[last->count - 1], k)) {
+            return _insertAt(last, last->count, v);
+        }
+        return insertUnique(v).first;
+    }
+    // 前一个值与 position 在同一个叶子节点中且 前一个 < k < position 时直接插入
+    position.sync();
+    Leaf *l = position.leaf;
+    size_t pos = position.slot;
+    if (pos > 0 && keyCompare(l->keys[pos - 1], k) && keyCompare(k, l->keys[pos])) {
+        return _insertAt(l, pos, v);
+    }
+    return insertUnique(v).first;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::insertEqual(iterator position, const Value &v) {
+    if (root == nullptr) {
+        return insertEqual(v);
+    }
+    const Key &k = key(v);
+    if (position == end()) {
+        Leaf *last = header->prev;
+        if (!keyCompare(k, last->keys[last->count - 1])) {
+            return _insertAt(last, last->count, v);
+        }
+        return insertEqual(v);
+    }
+    position.sync();
+    Leaf *l = position.leaf;
+    size_t pos = position.slot;
+    if (pos > 0 && !keyCompare(k, l->keys[pos - 1]) && !keyCompare(l->keys[pos], k)) {
+        return _insertAt(l, pos, v);
+    }
+    return insertEqual(v);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::erase(iterator position) {
+    position.sync();
+    Leaf *l = position.leaf;
+    for (size_t i = position.slot; i + 1 < l->count; ++i) {  // 后面的键值和值左移一格
+        l->keys[i] = move(l->keys[i + 1]);
+        l->records[i] = l->records[i + 1];
+    }
+    --l->count;
+    _destroyRecord(position.rec);
+    _addSize(l, -1);
+    --nodeCount;
+
+    if (l == root) {
+        if (l->count == 0) {  // 最后一个值被删除
+            delete l;
+            root = nullptr;
+            header->prev = header;
+            header->next = header;
+        }
+    } else if (l->count < MinCount) {
+        _fixLeaf(l);
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key &k) {
+    RBTREE_COUNT(finds, 1);
+    iterator j = end();
+    if (root != nullptr) {
+        size_t compares = 0;
+        Leaf *l = _descend(k, false, &compares);
+        size_t pos = _lowerIndex(l->keys, l->count, k, &compares);
+        if (pos == l->count) {  // 叶子中的键值都 < k, 只可能是后一个叶子的第一个
+            l = l->next;
+            pos = 0;
+        }
+        if (l != header) {
+            ++compares;  // 下面确认相等的一次比较
+            if (!keyCompare(k, l->keys[pos])) {
+                j = iterator(l->records[pos], l, pos);
+            }
+        }
+        RBTREE_COUNT(findCompares, compares);
+    }
+    return j;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::select(size_t k) {
+    if (k >= nodeCount) {
+        return end();  // 名次越界
+    }
+    NodeBase *x = root;
+    while (!x->isLeaf) {  // 依次跳过排在前面的子树
+        Inner *in = static_cast<Inner *>(x);
+        size_t i = 0;
+        while (k >= in->sizes[i]) {
+            k -= in->sizes[i++];
+        }
+        x = in->children[i];
+    }
+    Leaf *l = static_cast<Leaf *>(x);
+    return iterator(l->records[k], l, k);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::rank(const Key &k) {
+    if (root == nullptr) {
+        return 0;
+    }
+    size_t r = 0;
+    NodeBase *x = root;
+    while (!x->isLeaf) {  // 与 _descend 相同的路线, 累计左侧子树的大小
+        Inner *in = static_cast<Inner *>(x);
+        size_t i = _lowerIndex(in->keys, in->count - 1, k);
+        for (size_t j = 0; j < i; ++j) {
+            r += in->sizes[j];
+        }
+        x = in->children[i];
+    }
+    Leaf *l = static_cast<Leaf *>(x);
+    return r + _lowerIndex(l->keys, l->count, k);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator,
+          typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator>
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::equalRange(const Key &k) {
+    return pair<iterator, iterator>(lowerBound(k), upperBound(k));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::lowerBound(const Key &k) {
+    if (root == nullptr) {
+        return end();
+    }
+    Leaf *l = _descend(k, false);
+    size_t pos = _lowerIndex(l->keys, l->count, k);
+    if (pos == l->count) {  // 落在叶子末尾时即后一个叶子的第一个 (或 end())
+        l = l->next;
+        pos = 0;
+    }
+    return iterator(l->records[pos], l, pos);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename BTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+BTree<Key, Value, KeyOfValue, Compare, Alloc>::upperBound(const Key &k) {
+    if (root == nullptr) {
+        return end();
+    }
+    Leaf *l = _descend(k, true);
+    size_t pos = _upperIndex(l->keys, l->count, k);
+    if (pos == l->count) {
+        l = l->next;
+        pos = 0;
+    }
+    return iterator(l->records[pos], l, pos);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::inOrderTraversal() const {
+    inOrderTraversal(root);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::inOrderTraversal(NodePtr root) const {
+    if (root == nullptr) return;
+    if (!root->isLeaf) {  // 依次遍历各子树
+        Inner *in = static_cast<Inner *>(root);
+        for (size_t i = 0; i < in->count; ++i) {
+            inOrderTraversal(in->children[i]);
+        }
+        return;
+    }
+    Leaf *l = static_cast<Leaf *>(root);
+    for (size_t i = 0; i < l->count; ++i) {
+        cout << "Node ID: " << l->keys[i] << endl;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::removeRightmost() {
+    if (empty()) {
+        cout << "The tree is empty." << endl;
+        return;
+    }
+    iterator last = --end();
+    Key removedKey = key(*last);  // 删除后值的内存会被回收, 先保存键值
+    cout << "Before removing, Rightmost Node ID: " << removedKey << endl;
+    erase(last);
+    cout << "Removed the rightmost node: " << removedKey << endl;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+size_t BTree<Key, Value, KeyOfValue, Compare, Alloc>::_verifyNode(NodeBase *x, const Key *low, const Key *high,
+                                                                  size_t depth, size_t &leafDepth,
+                                                                  bool &ok) const {
+    if (x->isLeaf) {
+        Leaf *l = static_cast<Leaf *>(x);
+        if (leafDepth == 0) {
+            leafDepth = depth;
+        }
+        ok = ok && depth == leafDepth && l->count > 0 && l->count <= Capacity;  // 所有叶子在同一层, 不为空
+        for (size_t i = 0; i < l->count; ++i) {
+            const Key &k = l->keys[i];
+            ok = ok && l->records[i]->leaf == l && !keyCompare(k, key(l->records[i]->value)) &&
+                 !keyCompare(key(l->records[i]->value), k);
+            ok = ok && (low == nullptr || !keyCompare(k, *low)) && (high == nullptr || !keyCompare(*high, k));
+            ok = ok && (i == 0 || !keyCompare(k, l->keys[i - 1]));
+        }
+        return l->count;
+    }
+    Inner *in = static_cast<Inner *>(x);
+    ok = ok && in->count >= 2 && in->count <= Capacity && (x == root || in->count >= MinCount);
+    size_t total = 0;
+    for (size_t i = 0; i < in->count && ok; ++i) {
+        NodeBase *child = in->children[i];
+        ok = ok && child->parent == in && child->slot == i;
+        const Key *childLow = i > 0 ? &in->keys[i - 1] : low;
+        const Key *childHigh = i + 1 < in->count ? &in->keys[i] : high;
+        size_t n = _verifyNode(child, childLow, childHigh, depth + 1, leafDepth, ok);
+        ok = ok && n == in->sizes[i];
+        total += n;
+    }
+    return total;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+bool BTree<Key, Value, KeyOfValue, Compare, Alloc>::_verify() const {
+    if (root == nullptr) {
+        return nodeCount == 0 && header->next == header && header->prev == header;
+    }
+    bool ok = root->parent == nullptr;
+    size_t leafDepth = 0;
+    ok = ok && _verifyNode(root, nullptr, nullptr, 1, leafDepth, ok) == nodeCount;
+    // 叶子链表按顺序连接所有叶子, 前后指针一致
+    size_t total = 0;
+    for (Leaf *l = header->next; ok && l != header; l = l->next) {
+        ok = l->next->prev == l && (l->next == header || !keyCompare(l->next->keys[0], l->keys[l->count - 1]));
+        total += l->count;
+    }
+    return ok && total == nodeCount;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+RbTreeStats BTree<Key, Value, KeyOfValue, Compare, Alloc>::stats() const {
+#ifdef RBTREE_STATS
+    RbTreeStats result = counters;
+    result.counting = true;
+#else
+    RbTreeStats result;
+#endif
+    result.size = nodeCount;
+    for (NodeBase *x = root; x != nullptr; x = x->isLeaf ? nullptr : static_cast<Inner *>(x)->children[0]) {
+        ++result.height;
+    }
+    result.averageDepth = nodeCount ? (double) result.height : 0;  // 所有值都在叶子层
+    return result;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void BTree<Key, Value, KeyOfValue, Compare, Alloc>::resetStats() {
+#ifdef RBTREE_STATS
+    counters = RbTreeStats();
+#endif
+}
+
+#endif //LIBRARYMANAGEMENT_BTREE_H
@@ -0,0 +1,115 @@
+#ifndef LIBRARYMANAGEMENT_BATCHRUNNER_H
+#define LIBRARYMANAGEMENT_BATCHRUNNER_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bookManager.h"
+#include "recordParser.h"
+using namespace std;
+
+// 批处理命令执行器
+// 从文件逐行读取命令, 调用 BookManager 的无交互接口执行, 不经过任何菜单和确认提示
+// 每行一条命令, 字段以空白分隔, 空行和以 # 开头的行忽略:
+//   add <ISBN> <书名> <作者> <出版社> <出版年份> <数量>
+//   find id <编号> | find isbn <ISBN> | find page <页码> [每页数量]
+//   lend <编号> <借阅者>
+//   return <编号>
+//   remove id <编号> | remove isbn <ISBN>
+//   save <路径> <扩展名>
+//   stats                       (输出各棵红黑树的结构统计)
+//   filter [author <作者>] [publisher <出版社>] [year <起> <止>] [available|borrowed]
+//                               (多条件筛选, 条件可任意组合, 输出命中数和前 FilterPrintLimit 本)
+//   search <页码> <关键词...>     (全文检索书名、作者、出版社, 按相关度分页输出, 每页 SearchPageSize 本)
+//   suggest name <前缀> | suggest author <前缀>
+//                               (输入补全, 输出书名或作者以前缀开头的前 SuggestLimit 个书目)
+//   years <起> <止> [页码]        (出版年份区间内在库和已借出的书数, 以及按年份排列的一页, 每页 SearchPageSize 本)
+//   import <文件> [dedupe]        (导入分馆的图书文件, dedupe 时跳过本馆已有 ISBN 的副本)
+// 只读模式下修改数据的命令 (add、lend、return、remove、save、import) 被拒绝执行, 只计入统计
+class BatchRunner {
+public:
+    // 命令种类
+    enum Command {
+        Add,
+        FindId,
+        FindISBN,
+        FindPage,
+        Lend,
+        Return,
+        RemoveId,
+        RemoveISBN,
+        Save,
+        TreeStats,
+        Filter,
+        Search,
+        Suggest,
+        YearRange,
+        Import,
+        CommandCount,  // 命令种类数
+    };
+
+    // 执行统计
+    struct Stats {
+        size_t count[CommandCount] = {};    // 各命令的执行次数
+        size_t failed[CommandCount] = {};   // 各命令返回非 Ok 状态的次数
+        size_t total = 0;                   // 执行的命令总数
+        size_t syncFailed = 0;              // 日志提交失败的次数 (修改未能落盘)
+        size_t denied = 0;                  // 只读模式下拒绝执行的修改命令数
+        double seconds = 0;                 // 墙钟时间
+    };
+
+private:
+    BookManager& books;    // 操作的图书管理器
+    bool verbose;          // 是否输出每条命令的结果
+    bool readOnly;         // 是否只允许查询命令 (未以管理员身份运行)
+    Stats stats;           // 最近一次执行的统计
+    vector<RecordParser::Error> errors;  // 无法识别的命令行
+    istringstream fields;  // 当前行的字段 (每行复用同一个流)
+
+    // 每执行这么多条命令提交一次日志 (日志过长时随之压缩为快照)
+    static constexpr size_t SyncInterval = 4096;
+
+    // filter 命令在 verbose 模式下最多输出的书籍数
+    static constexpr size_t FilterPrintLimit = 20;
+
+    // search 命令每页的书籍数
+    static constexpr size_t SearchPageSize = 20;
+
+    // suggest 命令最多输出的书目数
+    static constexpr size_t SuggestLimit = 10;
+
+    // 命令名称, 用于输出统计
+    static const char* CommandName(Command command);
+
+    // 是否为修改数据的命令
+    static bool IsWrite(const string& op);
+
+    // 解析并执行一行命令, 格式错误时返回 false
+    bool Execute(const string& line);
+
+    // 记录一条命令的执行结果
+    void Record(Command command, BookManager::Status status);
+
+    // 提交日志, 失败时计入统计
+    void Sync();
+
+    // 输出一组查找结果 (verbose 模式)
+    void Print(const vector<Book>& found) const;
+
+public:
+    // 构造函数, verbose 为 true 时输出每条命令的结果
+    // readOnly 为 true 时拒绝修改数据的命令, 调用者验证管理员身份后才应传入 false
+    explicit BatchRunner(BookManager& books, bool verbose = false, bool readOnly = true);
+
+    // 执行命令文件, 返回文件是否打开成功
+    bool Run(const string& file);
+
+    // 获取最近一次执行的统计
+    const Stats& GetStats() const;
+
+    // 输出各命令的次数、失败数和总耗时, 以及格式错误的行 (最多 maxErrors 行)
+    void PrintSummary(ostream& out, size_t maxErrors = 10) const;
+};
+
+#endif //LIBRARYMANAGEMENT_BATCHRUNNER_H
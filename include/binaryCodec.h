@@ -0,0 +1,26 @@
+#ifndef LIBRARYMANAGEMENT_BINARYCODEC_H
+#define LIBRARYMANAGEMENT_BINARYCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+// 二进制文件格式的公共编解码函数 (操作日志和二进制快照共用)
+// 整数一律按小端序存储, 与运行平台的字节序无关
+class BinaryCodec {
+public:
+    // 向字符串追加一个 32 位整数 (小端序)
+    static void PutUint32(string& out, uint32_t v);
+
+    // 从 p 处读取一个 32 位整数 (小端序), 调用者保证至少有 4 个字节
+    static uint32_t GetUint32(const char* p);
+
+    // 从缓冲区的 pos 处读取一个 32 位整数并前移 pos, 越界时返回 false
+    static bool GetUint32(const string& in, size_t& pos, uint32_t& v);
+
+    // 计算 CRC32 校验值 (多项式 0xEDB88320)
+    static uint32_t Crc32(const char* data, size_t len);
+};
+
+#endif //LIBRARYMANAGEMENT_BINARYCODEC_H
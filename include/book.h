@@ -2,19 +2,21 @@
 #define LIBRARYMANAGEMENT_BOOK_H
 
 #include <iostream>
+#include <memory>
+#include "title.h"
 using namespace std;
 
-// Book 类表示一本书的相关信息
+// Book 类表示一本书 (一个实体副本) 的相关信息
+// ISBN、书名等描述信息保存在共享的 Title 中, 副本自身只保存编号和借阅信息
 class Book {
 private:
-    int id;             // 编号 (每本书的唯一标识)
-    string ISBN;        // 国际标准书号 (唯一标识书籍)
-    string name;        // 书名
-    string author;      // 作者
-    string publisher;   // 出版社
-    int year;           // 出版年份
-    bool borrowStatus;  // 借阅状态 0: 在库中, 1: 借阅中
-    string borrower;    // 借阅人
+    int id;                        // 编号 (每本书的唯一标识)
+    shared_ptr<const Title> title; // 描述信息 (同一 ISBN 的副本可共享同一个 Title)
+    bool borrowStatus;             // 借阅状态 0: 在库中, 1: 借阅中
+    string borrower;               // 借阅人
+
+    // 修改描述信息前调用: 复制一份自己的 Title, 不影响共享同一 Title 的其他副本
+    Title& _ownTitle();
 
 public:
     // 默认构造函数
@@ -25,14 +27,28 @@ public:
          const string& publisher, int year, bool borrowStatus,
          const string& borrower);
 
+    // 引用已有描述信息的构造函数
+    Book(int id, shared_ptr<const Title> title, bool borrowStatus, const string& borrower);
+
     // 析构函数
     ~Book();
 
+    // 复制与移动 (移动只转移描述信息的引用和借阅人字符串, 不复制)
+    Book(const Book& other) = default;
+    Book(Book&& other) noexcept = default;
+    Book& operator=(const Book& other) = default;
+    Book& operator=(Book&& other) noexcept = default;
+
     // 获取书的编号
     const int& GetId() const;
     // 设置书的编号
     void SetId(int id);
 
+    // 获取描述信息
+    const shared_ptr<const Title>& GetTitle() const;
+    // 设置描述信息 (引用共享的 Title)
+    void SetTitle(shared_ptr<const Title> title);
+
     // 获取书的 ISBN
     const string& GetISBN() const;
     // 设置书的 ISBN
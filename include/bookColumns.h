@@ -0,0 +1,131 @@
+#ifndef LIBRARYMANAGEMENT_BOOKCOLUMNS_H
+#define LIBRARYMANAGEMENT_BOOKCOLUMNS_H
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "book.h"
+using namespace std;
+
+// 图书目录的列式投影
+// 每本书占一行, 行按书籍编号排列, 各字段分列存放在连续数组中, 多条件筛选时只扫描涉及的列:
+// - ids:        书籍编号 (递增, 按编号定位行时二分查找)
+// - years:      出版年份
+// - borrowed:   借阅状态 (0 / 1)
+// - authors / publishers: 作者和出版社的字典编码 (字典只增不减, 编码在 Clear 之前保持不变)
+// - valid:      有效标记, 删除的书只清除标记 (同一编号再次加入时复用该行), 空行过多时整体压缩
+// 由 BookManager 在每次修改时同步维护; 筛选在支持 SSE2 的平台上每次比较 16 行
+class BookColumns {
+public:
+    // 借阅状态条件
+    enum Availability {
+        AnyStatus,      // 不限
+        Available,      // 只要在库的书
+        BorrowedOnly,   // 只要已借出的书
+    };
+
+    // 筛选条件, 未设置的条件不参与筛选, 各条件之间为 "并且"
+    struct Query {
+        bool byAuthor = false;       // 是否按作者筛选
+        string author;               // 作者 (完全相同)
+        bool byPublisher = false;    // 是否按出版社筛选
+        string publisher;            // 出版社 (完全相同)
+        int yearMin = INT_MIN;       // 出版年份下限 (含)
+        int yearMax = INT_MAX;       // 出版年份上限 (含)
+        Availability availability = AnyStatus;  // 借阅状态
+    };
+
+private:
+    // 字符串字典: 每个不同的字符串分配一个编码
+    class Dictionary {
+    private:
+        vector<string> values;                  // 编码 -> 字符串
+        unordered_map<string, uint32_t> codes;  // 字符串 -> 编码
+
+    public:
+        // 返回字符串的编码, 不存在时分配新编码
+        uint32_t Encode(const string& value);
+
+        // 查找字符串的编码, 不存在时返回 false
+        bool Find(const string& value, uint32_t& code) const;
+
+        // 字典中的字符串个数
+        size_t Size() const;
+
+        // 清空字典
+        void Clear();
+    };
+
+    // 编码后的筛选条件
+    struct Predicate {
+        bool byAuthor, byPublisher, byYear, byStatus;
+        uint32_t author, publisher;
+        int yearMin, yearMax;
+        uint8_t status;
+    };
+
+    vector<int> ids;              // 书籍编号
+    vector<int> years;            // 出版年份
+    vector<uint8_t> borrowed;     // 借阅状态
+    vector<uint32_t> authors;     // 作者编码
+    vector<uint32_t> publishers;  // 出版社编码
+    vector<uint8_t> valid;        // 有效标记
+    size_t live;                  // 有效行数
+    Dictionary authorDict;        // 作者字典
+    Dictionary publisherDict;     // 出版社字典
+
+    // 空行超过 max(CompactMinRows, 有效行数) 时压缩
+    static constexpr size_t CompactMinRows = 1024;
+
+    // 按编号定位行, 不存在时返回 false (row 为应插入的位置)
+    bool _findRow(int id, size_t& row) const;
+
+    // 用 book 的字段填写第 row 行
+    void _fillRow(size_t row, const Book& book);
+
+    // 去掉所有空行, 保持行的顺序
+    void _compact();
+
+    // 把筛选条件编码为 Predicate, 条件中的字符串不在字典中时 (不可能匹配) 返回 false
+    bool _compile(const Query& query, Predicate& predicate) const;
+
+    // 单行是否满足条件
+    bool _match(const Predicate& predicate, size_t row) const;
+
+    // 扫描所有行, 以 emit(起始行, 掩码) 报告结果: 掩码第 i 位表示第 (起始行 + i) 行满足条件
+    // emit 返回 false 时停止扫描
+    template <class Emit>
+    void _scan(const Predicate& predicate, Emit emit) const;
+
+public:
+    // 构造函数, 没有任何行
+    BookColumns();
+
+    // 清空所有行和字典
+    void Clear();
+
+    // 预留 n 行的空间
+    void Reserve(size_t n);
+
+    // 按编号加入一本书, 编号已存在时覆盖该行 (编号递增时直接追加到末尾)
+    void Put(const Book& book);
+
+    // 按编号删除一本书
+    void Remove(int id);
+
+    // 修改一本书的借阅状态
+    void SetBorrowed(int id, bool status);
+
+    // 返回满足条件的书籍编号 (按编号递增), 最多 limit 个
+    vector<int> Select(const Query& query, size_t limit = SIZE_MAX) const;
+
+    // 返回满足条件的书籍个数
+    size_t Count(const Query& query) const;
+
+    // 有效行数
+    size_t Size() const;
+};
+
+#endif //LIBRARYMANAGEMENT_BOOKCOLUMNS_H
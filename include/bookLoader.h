@@ -0,0 +1,98 @@
+#ifndef LIBRARYMANAGEMENT_BOOKLOADER_H
+#define LIBRARYMANAGEMENT_BOOKLOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "book.h"
+#include "recordParser.h"
+using namespace std;
+
+// 多线程流水线图书加载器
+// 1. 读取: 一个读取线程按大块读取文件, 并在行边界处切分
+// 2. 解析: 多个解析线程并行把数据块解码为 Book 记录
+// 3. 拼接: 调用线程按块序号拼接已解析完的块 (每块是一段有序序列), 与后续块的读取和解析重叠
+// 4. 建树: 全部记录拼接完成后交给调用者批量建树
+// 前三个阶段互相重叠; 建树不与解析重叠: 线性建树需要预先知道记录总数来确定树的形状,
+// 只能在最后一块解析完成后开始, 因此加载时间的下限是 max(读取, 解析 / 线程数) + 建树
+class BookLoader {
+public:
+    // 各阶段耗时统计
+    struct Stats {
+        size_t bytes = 0;          // 读取的字节数
+        size_t blocks = 0;         // 数据块数
+        size_t records = 0;        // 解析出的记录数
+        size_t threads = 0;        // 解析线程数
+        double readSeconds = 0;    // 读取线程的读盘耗时
+        double parseSeconds = 0;   // 解析线程的累计解析耗时 (各线程之和)
+        double mergeSeconds = 0;   // 拼接耗时 (与解析重叠, 不含等待)
+        double buildSeconds = 0;   // 建树耗时
+        double totalSeconds = 0;   // 总耗时 (墙钟时间)
+    };
+
+    // 建树回调, 参数为按文件顺序排列的全部记录
+    typedef function<void(vector<Book>&)> BuildFunc;
+
+private:
+    // 一个数据块, 只包含完整的行
+    struct Block {
+        size_t index;  // 块在文件中的序号
+        string data;   // 块内容
+    };
+
+    // 一个数据块的解析结果
+    struct Run {
+        vector<Book> books;                   // 解析出的记录
+        vector<RecordParser::Error> errors;   // 格式错误的行 (行号相对于块首)
+        size_t lines = 0;                     // 块中的行数
+    };
+
+    // 读取线程与解析线程之间的有界队列
+    class BlockQueue {
+    private:
+        deque<Block> blocks;
+        size_t capacity;
+        bool closed;
+        mutex lock;
+        condition_variable notFull, notEmpty;
+
+    public:
+        explicit BlockQueue(size_t capacity);
+        // 放入一个数据块, 队列满时等待
+        void Push(Block block);
+        // 取出一个数据块, 队列为空且已关闭时返回 false
+        bool Pop(Block& block);
+        // 关闭队列, 不再放入新的数据块
+        void Close();
+    };
+
+    size_t threads;    // 解析线程数
+    size_t blockSize;  // 每次读取的字节数
+    Stats stats;       // 最近一次加载的统计
+    vector<RecordParser::Error> errors;  // 最近一次加载中格式错误的行
+
+    // 解析一个数据块中的所有记录
+    static void ParseBlock(const string& data, Run& run);
+
+public:
+    // 构造函数, threads 为 0 时使用硬件并发数
+    explicit BookLoader(size_t threads = 0, size_t blockSize = 4 << 20);
+
+    // 加载文件, 解析完成后调用 build 建树, 返回文件是否打开成功
+    bool Load(const string& file, const BuildFunc& build);
+
+    // 获取最近一次加载的统计
+    const Stats& GetStats() const;
+
+    // 获取最近一次加载中格式错误的行 (行号为文件中的行号)
+    const vector<RecordParser::Error>& GetErrors() const;
+
+    // 输出最近一次加载的各阶段耗时, 以及格式错误的行 (最多 maxErrors 行)
+    void PrintStats(ostream& out, size_t maxErrors = 10) const;
+};
+
+#endif //LIBRARYMANAGEMENT_BOOKLOADER_H
@@ -1,11 +1,53 @@
 #ifndef LIBRARYMANAGEMENT_BOOKMANAGER_H
 #define LIBRARYMANAGEMENT_BOOKMANAGER_H
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bTree.h"
+#include "bookColumns.h"
 #include "book.h"
+#include "frozenIndex.h"
+#include "opLog.h"
+#include "prefixIndex.h"
 #include "rbTree.h"
+#include "textIndex.h"
+#include "title.h"
+#include "yearIndex.h"
 
 // 图书馆图书管理核心类
+// 提供两组接口:
+// - 无交互接口: 参数传入, 结果或状态码返回, 不读写控制台, 供批处理和程序调用
+// - 交互接口: 通过控制台提示输入, 内部调用无交互接口完成操作
 class BookManager {
+public:
+    // 无交互接口的状态码
+    enum Status {
+        Ok = 0,        // 成功
+        NotFound,      // 书籍或 ISBN 不存在
+        Borrowed,      // 书籍已借出
+        NotBorrowed,   // 书籍未借出
+        Invalid,       // 参数不合法
+        IoError,       // 文件读写失败
+    };
+
+    // 状态码对应的提示信息
+    static const char* StatusText(Status status);
+
+    // 一次导入的统计 (见 Import)
+    struct ImportStats {
+        size_t records = 0;       // 文件中的记录数
+        size_t imported = 0;      // 导入的副本数
+        size_t skipped = 0;       // 因 ISBN 本馆已有而跳过的副本数 (去重时)
+        size_t newTitles = 0;     // 新增的书目数
+        double readSeconds = 0;   // 读取与解析耗时
+        double mergeSeconds = 0;  // 编号、并入主索引和更新各二级索引的耗时
+        double totalSeconds = 0;  // 总耗时
+    };
+
 private:
     // 用于从 Book 对象中提取书籍编号
     struct IdOfBook {
@@ -14,14 +56,196 @@ private:
     };
 
     // 红黑树类型定义，使用书籍编号作为键值
+    // 编译时定义 BOOK_INDEX_BTREE (CMake 选项 -DBOOK_INDEX_BTREE=ON) 时改用接口相同的 B+ 树 (见 bTree.h)
+#ifdef BOOK_INDEX_BTREE
+    typedef BTree<int, Book, IdOfBook, std::less<>> RbTree;
+#else
     typedef RbTree<int, Book, IdOfBook, std::less<>> RbTree;
+#endif
+
+    // 指向主索引中一本书的迭代器, 两种树的插入和删除都不会使其他书的迭代器失效
+    typedef RbTree::iterator BookRef;
+
+    // 用于从 ISBN 索引项中提取 ISBN (直接引用主索引中书籍的 ISBN, 不另存副本)
+    struct ISBNOfRef {
+        const string& operator()(const BookRef& ref) const { return ref->GetISBN(); }
+    };
+
+    // ISBN 二级索引类型定义, 以 ISBN 为键值, 允许重复 (同一 ISBN 的多本副本)
+    typedef ::RbTree<string, BookRef, ISBNOfRef, std::less<>> ISBNIndex;
+
+    // 用于从书目表项中提取 ISBN
+    struct ISBNOfTitle {
+        const string& operator()(const shared_ptr<const Title>& title) const { return title->GetISBN(); }
+    };
 
-    // 管理图书的红黑树容器
+    // 书目表类型定义, 以 ISBN 为键值, 每个 ISBN 的描述信息只存一份, 由该 ISBN 的所有副本共享
+    // 登记后的 Title 不再修改, 描述信息变化时换用新的 Title (见 _replaceTitle)
+    typedef ::RbTree<string, shared_ptr<const Title>, ISBNOfTitle, std::less<>> TitleTable;
+
+    // 管理图书的红黑树容器 (每个节点是一本副本, 描述信息引用书目表中的 Title)
     RbTree libraryManager;
 
+    // ISBN -> 描述信息 的书目表, 与 libraryManager 保持同步, 没有副本的 Title 会被移除
+    TitleTable titles;
+
+    // 用于从借出索引项中提取书籍编号
+    struct IdOfRef {
+        const int& operator()(const BookRef& ref) const { return ref->GetId(); }
+    };
+
+    // 借出索引类型定义, 以书籍编号为键值, 只包含已借出的书
+    typedef ::RbTree<int, BookRef, IdOfRef, std::less<>> LendIndex;
+
+    // 已借出书籍的索引, 借出、归还和删除时增量维护, 按编号有序, 可按名次直接分页
+    LendIndex lendIndex;
+
+    // ISBN -> 副本 的二级索引, 与 libraryManager 保持同步
+    ISBNIndex isbnIndex;
+
+    // (出版年份, 编号) 二级索引, 带子树借出数聚合, 与 libraryManager 保持同步
+    YearIndex yearIndex;
+
+    // 书名、作者、出版社的全文倒排索引 (以书目为单位), 与书目表保持同步
+    TextIndex textIndex;
+
+    // 书名和作者的前缀索引 (键值 -> ISBN), 与书目表保持同步, 供输入过程中的即时补全
+    PrefixIndex namePrefix;
+    PrefixIndex authorPrefix;
+
+    // 主索引的列式投影 (编号、年份、借阅状态、作者、出版社), 每次修改时同步更新, 供多条件筛选 (FindWhere)
+    BookColumns columns;
+
     // 记录当前book的id最大值
     int currentMaxId;
 
+    // 操作日志, 每次修改都会追加记录, 启动时回放以恢复上次快照之后的修改
+    OpLog opLog;
+
+    // 快照文件的路径和类型 (由 Init 记录, 日志压缩时写回同一文件)
+    string dataPath, dataType;
+
+    // 日志记录数超过 max(CompactMinRecords, 图书总数) 时压缩为新快照, 摊还每次修改的代价
+    static constexpr size_t CompactMinRecords = 1024;
+
+    // 主索引的冻结副本 (编号 -> 书), 按编号查找时代替逐层追指针的树查找
+    // 主索引增删书籍后失效, 每批修改提交后 (_commit) 由后台线程重建, 重建完成前查找回到主索引
+    FrozenIndex<int, BookRef> frozen;
+
+    // frozen 是否与主索引一致
+    bool frozenValid;
+
+    // 后台重建线程及其正在构造的索引 (线程结束前只由该线程访问)
+    // 重建期间主线程只读主索引的结构, 任何增删之前先取消并等待重建线程结束 (_invalidateFrozen)
+    thread freezer;
+    FrozenIndex<int, BookRef> freezing;
+    atomic<bool> freezeCancel;  // 通知重建线程中止
+    atomic<bool> freezeDone;    // 重建线程已完成构造, 等待主线程接管
+
+    // 图书总数不少于此值时才建立冻结索引, 规模较小时树查找已足够快
+    static constexpr size_t FreezeMinBooks = 4096;
+
+    // 共享读模式 (见 SetSharedReads): 查找时不接管后台重建完成的冻结索引, 只在提交时 (_scheduleFreeze) 接管
+    bool sharedReads;
+
+    // 按编号查找, 冻结索引有效时使用冻结索引, 否则查找主索引; 没有找到时返回 libraryManager.end()
+    // 非共享读模式下, 后台重建已完成时先接管新索引
+    BookRef _findBook(int id);
+
+    // 主索引即将增删书籍: 取消正在进行的后台重建, 冻结索引失效
+    void _invalidateFrozen();
+
+    // 冻结索引失效且没有正在进行的重建时, 启动后台重建
+    void _scheduleFreeze();
+
+    // 后台重建已完成时, 等待线程结束并接管新索引
+    void _adoptFrozen();
+
+    // 插入一本书并登记到 ISBN 索引, 返回指向新书的迭代器 (编号重复时返回已有的书)
+    BookRef _insertBook(const Book& book);
+
+    // 删除一本书, 同时从 ISBN 索引中移除
+    void _eraseBook(BookRef it);
+
+    // 将一本书登记到 ISBN 索引
+    void _indexISBN(BookRef it);
+
+    // 从 ISBN 索引中移除一本书 (修改 ISBN 之前必须先移除)
+    void _unindexISBN(BookRef it);
+
+    // 在书目表中登记描述信息, 返回共享的 Title
+    // ISBN 已存在且描述信息不同时, 以新 Title 替换 (同一 ISBN 的所有副本随之更新)
+    shared_ptr<const Title> _internTitle(const Title& title);
+
+    // 以新的 Title 替换书目表中的 it 项 (ISBN 不变), 并让 ISBN 索引中该 ISBN 的副本改为引用它
+    // 共享出去的 Title 从不原地修改, 查询返回的 Book 在锁外也能安全读取
+    void _replaceTitle(TitleTable::iterator it, const Title& title);
+
+    // 该 ISBN 在 ISBN 索引中已没有副本时, 从书目表中移除 (调用前须先将删除的副本移出 ISBN 索引)
+    void _releaseTitle(const string& ISBN);
+
+    // 按 book 更新已有的副本: ISBN 变化时改为引用新 ISBN 的描述信息, 否则原地修改共享的描述信息
+    void _putBook(BookRef it, const Book& book);
+
+    // 修改一个 ISBN 的描述信息, 一次写入即作用于该 ISBN 的所有副本
+    // 新 ISBN 已存在时, 副本并入已有的书目
+    void _retitle(const string& ISBN, const Title& title);
+
+    // 设置一本书的借阅状态, 同时维护借出索引
+    void _setBorrowed(BookRef it, bool borrowed, const string& borrower);
+
+    // 将书目登记到书名和作者的前缀索引 / 从中移除 (修改描述信息之前必须先移除)
+    void _indexPrefix(const Title& title);
+    void _unindexPrefix(const Title& title);
+
+    // 一本书的描述信息变化后, 刷新它在列式存储中的行, 年份由 oldYear 变化时重新登记年份索引
+    void _refreshCopy(BookRef it, int oldYear);
+
+    // 一个 ISBN 的描述信息变化后 (原出版年份为 oldYear), 刷新其所有副本
+    void _refreshCopies(const string& ISBN, int oldYear);
+
+    // 由主索引重建书目表、ISBN 索引、借出索引、年份索引、列式存储、全文索引和前缀索引, 同一 ISBN 的副本改为共享同一个 Title
+    void _rebuildIndexes();
+
+    // 分页显示已借出的书籍, 用法同 FindByPage
+    void _findLendByPage(int currPage, int pageSize);
+
+    // 分页显示 pages 返回的书籍, 按用户输入的页码跳转, 输入 0 时退出
+    void _browse(size_t total, int currPage, int pageSize,
+                 const function<vector<Book>(size_t, size_t)>& pages);
+
+    // 询问是否继续当前操作, 输入 y/yes 时返回 true
+    // verbose 为 true 时, 对 n/no 和无效输入给出提示
+    static bool _askContinue(const string& prompt, bool verbose = true);
+
+    // 从文本文件加载图书 (文件不存在时创建空文件)
+    void _loadText(const string& file);
+
+    // 以文本格式保存图书, 返回是否成功
+    bool _saveText(const string& file);
+
+    // 导入的副本数不少于已有副本数的 1 / ImportRebuildRatio 时, ISBN 索引和年份索引整体重建, 否则逐个登记
+    static constexpr size_t ImportRebuildRatio = 8;
+
+    // 导入时每登记这么多本输出一次进度
+    static constexpr size_t ImportProgressInterval = 1 << 18;
+
+    // 按文件顺序读出待导入文件 (二进制快照或文本格式) 中的书, 文件无法读取时返回 false
+    bool _readImport(const string& file, vector<Book>& books, ostream& progress);
+
+    // 把一批新书 (按编号递增, 编号都大于已有的书) 整体接到主索引之后, 返回指向其中第一本的迭代器
+    BookRef _appendBooks(const vector<Book>& books);
+
+    // 把导入的副本 (按编号有序) 登记到 ISBN 索引和年份索引
+    void _indexImported(const vector<BookRef>& added);
+
+    // 回放一条日志记录
+    void _applyLog(OpLog::OpType type, const Book& book, const string& ISBN);
+
+    // 提交本次操作产生的日志记录, 日志过长或写入失败时压缩为新快照; 随后按需启动冻结索引的后台重建
+    // 日志和快照都写入失败时返回 IoError (修改只在内存中)
+    Status _commit();
+
 public:
     // 构造函数
     BookManager();
@@ -30,7 +254,9 @@ public:
     ~BookManager();
 
     // 初始化书籍数据，从指定路径加载数据文件
-    void Init(string path,string fileType);
+    // 根据文件头自动识别二进制快照或文本格式; fileType 为 .bin 且快照不存在时从同名 .txt 导入
+    // 快照损坏, 或数据文件缺失而日志或临时文件表明它应当存在时返回 IoError, 此时不打开日志, 也不会压缩覆盖任何文件
+    Status Init(string path,string fileType);
 
     // 加载图书最大ID
     void LoadMaxId(string filePath);
@@ -41,6 +267,9 @@ public:
     // 添加书籍到图书馆
     void Insert();
 
+    // 从外部文件导入图书 (分馆的馆藏)
+    void Import();
+
     // 检查图书馆是否为空
     bool Empty();
 
@@ -53,6 +282,18 @@ public:
     // 根据 ISBN 号查找书籍
     void FindByISBN();
 
+    // 按作者、出版社、出版年份范围和借阅状态多条件筛选书籍 (在列式存储上扫描), 分页显示
+    void FindWhere();
+
+    // 按关键词全文检索书名、作者、出版社, 按相关度分页显示
+    void Search();
+
+    // 按书名或作者的前缀查找书目 (输入补全), 列出匹配的书目及其副本数
+    void Suggest();
+
+    // 按出版年份范围查找书籍, 先输出在库和已借出的书数, 再按年份分页显示
+    void FindByYear();
+
     // 根据书籍编号更新书籍信息
     void UpdateByID();
 
@@ -74,8 +315,90 @@ public:
     // 查询所有已借出的书籍
     void FindAllLend();
 
-    // 保存书籍数据到文件
-    void Save(string path, string fileType);
+    // 保存书籍数据到文件, fileType 为 .bin 时写二进制快照, 否则写文本格式 (用于导出)
+    // 写入的是 Init 加载的同一文件时, 同时清空操作日志 (日志压缩)
+    Status Save(string path, string fileType);
+
+    // 提交尚未落盘的日志记录, 日志过长时压缩为新快照 (退出前调用), 无法落盘时返回 IoError
+    Status Sync();
+
+    // ---------------- 无交互接口 ----------------
+    // 修改操作只追加日志记录 (缓冲区满时自动组提交), 由调用者在适当的时机调用 Sync 提交
+
+    // 添加 count 本同一 ISBN 的副本, 成功时 firstId 为第一本的编号 (各副本编号连续)
+    // 该 ISBN 已有副本且描述信息不同时, 已有副本随之更新
+    Status Insert(const Title& title, int count, int& firstId);
+
+    // 导入外部文件中的图书 (分馆的馆藏), 文件为二进制快照或 book.txt 的文本格式, 按文件头自动识别
+    // 导入的副本按文件顺序从 currentMaxId + 1 起重新编号, 一律为在库状态 (不导入分馆的借阅信息)
+    // dedupe 为 true 时跳过本馆已有 ISBN 的副本, 否则并入已有书目 (描述信息以本馆为准); 新 ISBN 以文件中第一次出现的描述信息为准
+    // 新编号都大于已有编号, 整批线性建树后连接到主索引之后, 不逐个插入; 各阶段的进度和吞吐量输出到 progress
+    // 导入量大到提交时必然压缩日志时, 直接写出新快照, 不逐本追加日志记录
+    Status Import(const string& file, bool dedupe, ImportStats& stats, ostream& progress);
+
+    // 根据书籍编号查找, 找到时写入 book
+    Status FindByID(int id, Book& book);
+
+    // 根据 ISBN 查找所有副本, 按编号排列
+    vector<Book> FindByISBN(const string& ISBN);
+
+    // 取第 currPage 页 (从 1 开始) 的书籍, 页码超出范围时返回空
+    vector<Book> FindPage(size_t currPage, size_t pageSize);
+
+    // 取已借出书籍的第 currPage 页 (从 1 开始), 页码超出范围时返回空
+    vector<Book> FindLendPage(size_t currPage, size_t pageSize);
+
+    // 按 book 更新编号相同的书籍 (描述信息按 ISBN 共享, 同一 ISBN 的其他副本随之更新)
+    Status UpdateByID(const Book& book);
+
+    // 修改一个 ISBN 的描述信息, 作用于该 ISBN 的所有副本
+    Status UpdateByISBN(const string& ISBN, const Title& title);
+
+    // 根据书籍编号删除
+    Status RemoveByID(int id);
+
+    // 删除一个 ISBN 的所有副本, removeBorrowed 为 false 时保留已借出的副本
+    Status RemoveByISBN(const string& ISBN, bool removeBorrowed);
+
+    // 借出书籍
+    Status Lend(int id, const string& borrower);
+
+    // 归还书籍
+    Status Return(int id);
+
+    // 全文检索书名、作者、出版社, text 中的词都要出现 (中文按字匹配)
+    // 结果按书目的相关度排列, 同一书目的副本按编号排列; 返回第 currPage 页 (从 1 开始), total 为命中的书籍总数
+    vector<Book> Search(const string& text, size_t currPage, size_t pageSize, size_t& total);
+
+    // 输入补全: 返回书名 (byAuthor 为 true 时为作者) 以 prefix 开头的前 k 个书目, 按书名 (作者) 的字典序排列
+    // ASCII 字母不区分大小写
+    vector<Title> Suggest(const string& prefix, size_t k, bool byAuthor = false);
+
+    // 出版年份在 [yearMin, yearMax] 内的书数, 分为在库和已借出两部分, O(log n)
+    void CountByYear(int yearMin, int yearMax, size_t& available, size_t& borrowed);
+
+    // 出版年份在 [yearMin, yearMax] 内的书籍按 (年份, 编号) 排列的第 currPage 页 (从 1 开始)
+    vector<Book> FindByYear(int yearMin, int yearMax, size_t currPage, size_t pageSize);
+
+    // 多条件筛选 (作者、出版社、出版年份范围、借阅状态), 返回满足条件的书籍, 按编号排列, 最多 limit 本
+    vector<Book> FindWhere(const BookColumns::Query& query, size_t limit = SIZE_MAX);
+
+    // 满足筛选条件的书籍数
+    size_t CountWhere(const BookColumns::Query& query);
+
+    // 图书总数
+    size_t Size();
+
+    // 已借出的图书数
+    size_t LendCount();
+
+    // 开启或关闭共享读模式
+    // 开启后只读接口 (FindByID、FindByISBN、FindPage、FindLendPage、CountByYear、FindByYear、Size、LendCount)
+    // 不再修改任何状态, 可以在多个线程中并发调用, 但不能与修改接口并发 (由调用者加锁, 见 ConcurrentBookManager)
+    void SetSharedReads(bool shared);
+
+    // 输出各棵红黑树 (主索引、ISBN 索引、书目表、借出索引) 的结构统计
+    void PrintTreeStats(ostream& out);
 
     // 测试红黑树功能
     void TestRbTree();
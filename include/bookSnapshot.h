@@ -0,0 +1,164 @@
+#ifndef LIBRARYMANAGEMENT_BOOKSNAPSHOT_H
+#define LIBRARYMANAGEMENT_BOOKSNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "binaryCodec.h"
+#include "book.h"
+#include "rbTree.h"
+using namespace std;
+
+// 图书二进制快照
+// 按红黑树的先序保存每个节点的数据、颜色和子节点情况, 加载时原样重建树的形状,
+// 不需要任何比较和平衡操作
+// 文件格式 (小端序):
+// - 文件头: "LMBS" | uint32 版本 | uint32 记录数 | int32 最大编号 | uint32 字符串堆字节数
+// - 记录 (先序, 每条定长 RecordSize 字节):
+//   int32 编号 | int32 出版年份 | uint8 标志 | 5 个 uint32 字符串偏移 (ISBN、书名、作者、出版社、借阅人)
+// - 字符串堆: 每个字符串为 uint32 长度 + 字节, 相同的字符串只存一份
+// - uint32 CRC32 (覆盖之前的全部内容)
+class BookSnapshot {
+public:
+    static constexpr uint32_t Version = 1;           // 当前格式版本
+    static constexpr size_t HeaderSize = 20;         // 文件头字节数
+    static constexpr size_t RecordSize = 29;         // 每条记录的字节数
+
+    // 记录标志位
+    static constexpr unsigned char FlagBlack = 1;     // 节点为黑色
+    static constexpr unsigned char FlagLeft = 2;      // 有左子节点
+    static constexpr unsigned char FlagRight = 4;     // 有右子节点
+    static constexpr unsigned char FlagBorrowed = 8;  // 已借出
+
+    // 判断文件是否为二进制快照 (检查文件头的魔数)
+    static bool IsSnapshot(const string& file);
+
+    // 将树写入快照文件, 返回是否成功
+    template <class Tree>
+    static bool Write(const string& file, const Tree& tree, int maxId);
+
+    // 从快照文件重建树 (树必须为空), 返回是否成功; 成功时 maxId 为快照记录的最大编号
+    template <class Tree>
+    static bool Read(const string& file, Tree& tree, int& maxId);
+
+private:
+    // 将字符串登记到字符串堆中, 返回其偏移 (相同字符串复用同一偏移)
+    static uint32_t Intern(string& heap, unordered_map<string, uint32_t>& offsets, const string& s);
+    // 读取字符串堆中偏移为 offset 的字符串, 越界时返回 false
+    static bool HeapString(const char* heap, uint32_t heapSize, uint32_t offset, string& s);
+    // 校验文件内容并解析文件头, 返回是否合法
+    static bool CheckHeader(const string& data, uint32_t& count, int& maxId, uint32_t& heapSize);
+};
+
+template <class Tree>
+bool BookSnapshot::Write(const string& file, const Tree& tree, int maxId) {
+    string records, heap;
+    unordered_map<string, uint32_t> offsets;
+    records.reserve(tree.size() * RecordSize);
+
+    // 先序遍历, 记录每个节点的数据、颜色和子节点情况
+    tree.preorder([&](const Book& book, Color color, bool hasLeft, bool hasRight) {
+        unsigned char flags = 0;
+        if (color == Black) flags |= FlagBlack;
+        if (hasLeft) flags |= FlagLeft;
+        if (hasRight) flags |= FlagRight;
+        if (book.GetBorrowStatus()) flags |= FlagBorrowed;
+        BinaryCodec::PutUint32(records, (uint32_t) book.GetId());
+        BinaryCodec::PutUint32(records, (uint32_t) book.GetYear());
+        records.push_back((char) flags);
+        BinaryCodec::PutUint32(records, Intern(heap, offsets, book.GetISBN()));
+        BinaryCodec::PutUint32(records, Intern(heap, offsets, book.GetName()));
+        BinaryCodec::PutUint32(records, Intern(heap, offsets, book.GetAuthor()));
+        BinaryCodec::PutUint32(records, Intern(heap, offsets, book.GetPublisher()));
+        BinaryCodec::PutUint32(records, Intern(heap, offsets, book.GetBorrower()));
+    });
+
+    string data = "LMBS";
+    BinaryCodec::PutUint32(data, Version);
+    BinaryCodec::PutUint32(data, (uint32_t) tree.size());
+    BinaryCodec::PutUint32(data, (uint32_t) maxId);
+    BinaryCodec::PutUint32(data, (uint32_t) heap.size());
+    data += records;
+    data += heap;
+    BinaryCodec::PutUint32(data, BinaryCodec::Crc32(data.data(), data.size()));
+
+    ofstream out(file, ios::out | ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(data.data(), (streamsize) data.size());
+    out.close();  // 关闭时才会写出缓冲区, 之后再检查是否成功
+    return !out.fail();
+}
+
+template <class Tree>
+bool BookSnapshot::Read(const string& file, Tree& tree, int& maxId) {
+    // 一次读入整个文件
+    ifstream in(file, ios::in | ios::binary | ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    string data((size_t) in.tellg(), '\0');
+    in.seekg(0);
+    if (!in.read(&data[0], (streamsize) data.size())) {
+        return false;
+    }
+    in.close();
+
+    uint32_t count, heapSize;
+    int savedMaxId;
+    if (!CheckHeader(data, count, savedMaxId, heapSize)) {
+        return false;
+    }
+    const char* record = data.data() + HeaderSize;
+    const char* heap = record + (size_t) count * RecordSize;
+
+    // 字符串堆中相同的字符串只存一份, 偏移和出版年份都相同的记录可以共享同一个 Title
+    struct TitleKey {
+        uint32_t offsets[4];               // ISBN、书名、作者、出版社的偏移
+        int year;                          // 出版年份
+        shared_ptr<const Title> title;     // 已解码的描述信息
+    };
+    unordered_map<uint32_t, TitleKey> titles;  // 以 ISBN 偏移为键
+
+    // 按先序依次解码记录, 交给红黑树原样重建
+    bool ok = tree.buildPreorder(count, [&](Book& book, Color& color, bool& hasLeft, bool& hasRight) {
+        unsigned char flags = (unsigned char) record[8];
+        int year = (int) BinaryCodec::GetUint32(record + 4);
+        uint32_t offsets[4] = {BinaryCodec::GetUint32(record + 9), BinaryCodec::GetUint32(record + 13),
+                               BinaryCodec::GetUint32(record + 17), BinaryCodec::GetUint32(record + 21)};
+        auto cached = titles.find(offsets[0]);
+        if (cached == titles.end() || cached->second.year != year ||
+            !equal(offsets, offsets + 4, cached->second.offsets)) {
+            string ISBN, name, author, publisher;
+            if (!HeapString(heap, heapSize, offsets[0], ISBN) ||
+                !HeapString(heap, heapSize, offsets[1], name) ||
+                !HeapString(heap, heapSize, offsets[2], author) ||
+                !HeapString(heap, heapSize, offsets[3], publisher)) {
+                return false;
+            }
+            TitleKey key{{offsets[0], offsets[1], offsets[2], offsets[3]}, year,
+                         make_shared<Title>(ISBN, name, author, publisher, year)};
+            cached = titles.insert_or_assign(offsets[0], move(key)).first;
+        }
+        string borrower;
+        if (!HeapString(heap, heapSize, BinaryCodec::GetUint32(record + 25), borrower)) {
+            return false;
+        }
+        book = Book((int) BinaryCodec::GetUint32(record), cached->second.title, (flags & FlagBorrowed) != 0, borrower);
+        color = (flags & FlagBlack) ? Black : Red;
+        hasLeft = (flags & FlagLeft) != 0;
+        hasRight = (flags & FlagRight) != 0;
+        record += RecordSize;
+        return true;
+    });
+    if (ok) {
+        maxId = savedMaxId;
+    }
+    return ok;
+}
+
+#endif //LIBRARYMANAGEMENT_BOOKSNAPSHOT_H
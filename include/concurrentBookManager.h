@@ -0,0 +1,57 @@
+#ifndef LIBRARYMANAGEMENT_CONCURRENTBOOKMANAGER_H
+#define LIBRARYMANAGEMENT_CONCURRENTBOOKMANAGER_H
+
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "book.h"
+#include "bookManager.h"
+#include "title.h"
+using namespace std;
+
+// 线程安全的图书管理门面
+// 包装一个 BookManager, 读写的是同一份图书数据、书目表、二级索引和操作日志, 以读写锁同步:
+// - 读操作 (按编号查找、按 ISBN 查找、分页浏览、年份统计) 持共享锁, 多个线程可以并行
+// - 写操作 (添加、删除、借出、归还、提交) 持独占锁, 逐个执行
+// 包装期间 BookManager 处于共享读模式 (见 BookManager::SetSharedReads), 后台重建的冻结索引在 Sync 时接管,
+// 所有操作都必须经过门面, 不能再直接调用被包装的 BookManager
+// 读操作返回的 Book 是值, 引用的 Title 一经共享便不再修改 (修改描述信息时换用新的 Title),
+// 因此释放共享锁之后仍可以继续读取, 不受之后写操作的影响
+// 与 BookManager 的无交互接口一样, 这里的接口不做任何控制台交互
+// 开启 RBTREE_STATS 时各棵树的计数器会被读者并发修改, 统计值只作参考
+class ConcurrentBookManager {
+private:
+    BookManager& books;          // 被包装的图书管理器
+    mutable shared_mutex lock;   // 读者共享, 写者独占
+
+public:
+    // 包装 books (开启共享读模式)
+    explicit ConcurrentBookManager(BookManager& books);
+
+    // 析构函数, 关闭共享读模式
+    ~ConcurrentBookManager();
+
+    // 禁止复制
+    ConcurrentBookManager(const ConcurrentBookManager&) = delete;
+    ConcurrentBookManager& operator=(const ConcurrentBookManager&) = delete;
+
+    // 以下读操作持共享锁
+    BookManager::Status FindByID(int id, Book& book);
+    vector<Book> FindByISBN(const string& ISBN);
+    vector<Book> FindPage(size_t currPage, size_t pageSize);
+    vector<Book> FindLendPage(size_t currPage, size_t pageSize);
+    void CountByYear(int yearMin, int yearMax, size_t& available, size_t& borrowed);
+    size_t Size();
+    size_t LendCount();
+
+    // 以下写操作持独占锁
+    BookManager::Status Insert(const Title& title, int count, int& firstId);
+    BookManager::Status RemoveByID(int id);
+    BookManager::Status Lend(int id, const string& borrower);
+    BookManager::Status Return(int id);
+
+    // 提交日志并接管后台重建完成的冻结索引 (持独占锁), 写操作之后应定期调用
+    BookManager::Status Sync();
+};
+
+#endif //LIBRARYMANAGEMENT_CONCURRENTBOOKMANAGER_H
@@ -0,0 +1,22 @@
+#ifndef LIBRARYMANAGEMENT_DURABLEFILE_H
+#define LIBRARYMANAGEMENT_DURABLEFILE_H
+
+#include <string>
+using namespace std;
+
+// 文件落盘工具
+// 快照压缩按以下顺序进行, 任一步失败都保留原文件和日志:
+// 写临时文件 -> Sync 临时文件 -> Replace 覆盖目标文件 (同时刷新所在目录) -> 清空日志
+class DurableFile {
+public:
+    // 将文件内容刷入磁盘, 返回是否成功
+    static bool Sync(const string& file);
+
+    // 将目录项的修改 (创建、重命名) 刷入磁盘, 返回是否成功
+    static bool SyncDirectory(const string& dir);
+
+    // 用 from 原子地替换 to (不先删除 to, 崩溃后只会看到旧文件或新文件), 并刷新所在目录
+    static bool Replace(const string& from, const string& to);
+};
+
+#endif //LIBRARYMANAGEMENT_DURABLEFILE_H
@@ -0,0 +1,131 @@
+#ifndef LIBRARYMANAGEMENT_FROZENINDEX_H
+#define LIBRARYMANAGEMENT_FROZENINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// 预取一条缓存行 (GCC / Clang), 其他编译器上为空操作
+#if defined(__GNUC__)
+#define FROZEN_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define FROZEN_PREFETCH(p) ((void) 0)
+#endif
+
+// 只读的冻结索引: 由有序序列一次性构造, 之后只支持查找
+// 键值按 Eytzinger 顺序 (完全二叉树的层序, 下标从 1 开始, 节点 i 的子节点为 2i 和 2i + 1) 存放在连续数组中:
+// - 查找路径上前几层的键值集中在数组开头, 常驻缓存
+// - 每一步只计算 i = 2i + (keys[i] < k), 没有难以预测的分支
+// - 节点 i 往下第 PrefetchLevels 层的 2^PrefetchLevels 个后代在数组中相邻, 提前一次预取即可覆盖
+// 值按位置引用: values[i] 与 keys[i] 一一对应
+// 不支持修改, 内容变化后需重新构造 (见 build)
+template <class Key, class Value, class Compare = less<Key>>
+class FrozenIndex {
+private:
+    vector<Key> keys;      // keys[1..n] 为 Eytzinger 顺序的键值, keys[0] 不使用
+    vector<Value> values;  // values[i] 为 keys[i] 对应的值
+    size_t n;              // 元素个数
+    Compare keyCompare;    // 键值比较函数对象
+
+    // 提前预取的层数: 一条缓存行 (64 字节) 可容纳的键值个数取以 2 为底的对数, 至少 1
+    static constexpr size_t PrefetchLevels = sizeof(Key) <= 4 ? 4 : sizeof(Key) <= 8 ? 3 : sizeof(Key) <= 16 ? 2 : 1;
+
+    // 按中序填充以节点 i 为根的子树, next 依次给出有序的键值和值
+    template <class Next>
+    bool _fill(size_t i, Next &next);
+
+public:
+    // 构造函数, 索引为空
+    explicit FrozenIndex(const Compare &comp = Compare()) : n(0), keyCompare(comp) {}
+
+    // 由 count 个按键值严格递增的元素构造索引, 替换原有内容
+    // next(键值, 值) 依次填入每个元素, 返回 false 时中止构造 (例如后台构造被取消), 此时索引被清空并返回 false
+    template <class Next>
+    bool build(size_t count, Next next);
+
+    // 查找键值为 k 的元素, 返回值的指针, 没有找到时返回 nullptr
+    const Value *find(const Key &k) const;
+
+    // 元素个数
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    // 清空索引并释放内存
+    void clear();
+
+    // 交换两个索引的内容
+    void swap(FrozenIndex &other);
+};
+
+template <class Key, class Value, class Compare>
+template <class Next>
+bool FrozenIndex<Key, Value, Compare>::_fill(size_t i, Next &next) {
+    // 递归深度为树高 O(log n)
+    if (i > n) {
+        return true;
+    }
+    if (!_fill(2 * i, next) || !next(keys[i], values[i])) {
+        return false;
+    }
+    return _fill(2 * i + 1, next);
+}
+
+template <class Key, class Value, class Compare>
+template <class Next>
+bool FrozenIndex<Key, Value, Compare>::build(size_t count, Next next) {
+    clear();
+    n = count;
+    keys.resize(n + 1);
+    values.resize(n + 1);
+    if (!_fill(1, next)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+template <class Key, class Value, class Compare>
+const Value *FrozenIndex<Key, Value, Compare>::find(const Key &k) const {
+    if (n == 0) {
+        return nullptr;
+    }
+    const Key *base = keys.data();
+    size_t i = 1;
+    while (i <= n) {
+        // 预取 PrefetchLevels 层之后的后代 (越界的预取地址不会被访问, 也不会出错)
+        FROZEN_PREFETCH((const char *) base + sizeof(Key) * (i << PrefetchLevels));
+        i = 2 * i + keyCompare(base[i], k);  // keys[i] < k 时走右子节点, 否则走左子节点
+    }
+    // 路径末尾连续向右的步数加一即为回退的层数, 回退后 i 为首个 >= k 的节点 (不存在时为 0)
+#if defined(__GNUC__)
+    i >>= __builtin_ctzll(~(unsigned long long) i) + 1;
+#else
+    while (i & 1) {
+        i >>= 1;
+    }
+    i >>= 1;
+#endif
+    if (i == 0 || keyCompare(k, base[i])) {
+        return nullptr;
+    }
+    return &values[i];
+}
+
+template <class Key, class Value, class Compare>
+void FrozenIndex<Key, Value, Compare>::clear() {
+    vector<Key>().swap(keys);
+    vector<Value>().swap(values);
+    n = 0;
+}
+
+template <class Key, class Value, class Compare>
+void FrozenIndex<Key, Value, Compare>::swap(FrozenIndex &other) {
+    keys.swap(other.keys);
+    values.swap(other.values);
+    std::swap(n, other.n);
+    std::swap(keyCompare, other.keyCompare);
+}
+
+#endif //LIBRARYMANAGEMENT_FROZENINDEX_H
@@ -13,7 +13,7 @@ public:
     static void Main();
 
     // 查找菜单
-    // 提供查找功能的选项界面，例如按编号查找或按状态筛选
+    // 提供查找功能的选项界面，例如按编号查找或按作者、出版社、年份和状态筛选
     static void Find();
 
     // 更新菜单
@@ -0,0 +1,199 @@
+#ifndef LIBRARYMANAGEMENT_NODEPOOL_H
+#define LIBRARYMANAGEMENT_NODEPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+using namespace std;
+
+// 节点分配策略
+// 红黑树通过分配策略获取和归还节点的原始内存, 节点的构造与析构由红黑树自己完成
+// 一个分配策略需要提供:
+// - allocate():   分配一块可容纳 T 的原始内存
+// - deallocate(): 归还一块由 allocate() 分配的内存
+// - release():    一次性归还所有内存 (仅当 canRelease 为 true 时可用)
+// - share():      与另一个分配器共享内存, 之后两者分配的节点可以互相归还 (红黑树的拆分与连接在树之间移动节点时使用)
+
+// 直接使用 new / delete 的分配策略
+template <class T>
+class NewAllocator {
+public:
+    // 是否支持一次性释放所有节点
+    static const bool canRelease = false;
+
+    // 分配一块原始内存
+    T *allocate() { return static_cast<T *>(::operator new(sizeof(T))); }
+
+    // 归还一块内存
+    void deallocate(T *p) { ::operator delete(p); }
+
+    // 不支持一次性释放, 什么也不做
+    void release() {}
+
+    // 所有节点都来自全局堆, 本来就可以互相归还
+    void share(NewAllocator &) {}
+
+    // 当前占用的字节数 (无法统计, 返回 0)
+    size_t bytesReserved() const { return 0; }
+};
+
+// 节点池 (slab + 空闲链表)
+// 节点从大块连续内存中切分, 归还的节点挂入空闲链表以便复用
+// 每次申请的新块容量翻倍, 直到 MaxBlockNodes 为止
+// 内存块归属于一个所有者 (Arena), 通常只有本节点池持有; share() 之后多个节点池持有同一个所有者,
+// 空闲链表和切分游标仍各自独立 (分配和归还不加锁), 内存块在最后一个持有者释放时才归还
+template <class T, size_t MinBlockNodes = 64, size_t MaxBlockNodes = 65536>
+class NodePool {
+private:
+    // 一个槽位要么存放节点, 要么作为空闲链表的一环
+    union Slot {
+        Slot *next;                                    // 空闲链表的下一个槽位
+        alignas(T) unsigned char storage[sizeof(T)];   // 节点的原始存储空间
+    };
+
+    // 一块连续内存的头部, 槽位紧随其后
+    struct Block {
+        Block *next;     // 下一块内存
+        size_t capacity; // 本块的槽位数量
+        Slot *slots() { return reinterpret_cast<Slot *>(this + 1); }
+    };
+
+    // 内存块的所有者
+    // 两个所有者合并时, 一方的内存块全部移交另一方, 并记下转发指针 (类似并查集), 仍持有旧所有者的节点池沿转发指针找到新所有者
+    struct Arena {
+        Block *blocks = nullptr;   // 已申请的内存块链表
+        shared_ptr<Arena> forward; // 合并后的新所有者, 为空表示自己就是最终所有者
+
+        ~Arena() {
+            while (blocks != nullptr) {
+                Block *next = blocks->next;
+                ::operator delete(blocks);
+                blocks = next;
+            }
+        }
+    };
+
+    Slot *freeList;        // 空闲链表头
+    shared_ptr<Arena> arena; // 内存块的所有者 (第一次申请内存块时创建)
+    Slot *cursor;          // 当前块中尚未切分的第一个槽位
+    Slot *limit;           // 当前块的末尾
+    size_t nextBlockNodes; // 下一次申请的块容量
+    size_t reserved;       // 本节点池申请的总字节数
+
+    // 所有者的转发关系可能被其他线程中共享内存的节点池修改, 只在申请新块和合并时加锁, 两者都不频繁
+    static mutex &_arenaLock() {
+        static mutex lock;
+        return lock;
+    }
+
+    // 沿转发指针找到最终所有者, 并让本节点池直接持有它 (调用者需持有 _arenaLock)
+    Arena *_owner() {
+        if (arena == nullptr) {
+            arena = make_shared<Arena>();
+        }
+        while (arena->forward != nullptr) {
+            shared_ptr<Arena> next = arena->forward;  // 先取出, 旧所有者可能随赋值一起析构
+            arena = next;
+        }
+        return arena.get();
+    }
+
+    // 申请一个新的内存块, 并将切分游标指向它
+    void _grow() {
+        size_t bytes = sizeof(Block) + nextBlockNodes * sizeof(Slot);
+        Block *b = static_cast<Block *>(::operator new(bytes));
+        b->capacity = nextBlockNodes;
+        {
+            lock_guard<mutex> guard(_arenaLock());
+            Arena *owner = _owner();
+            b->next = owner->blocks;
+            owner->blocks = b;
+        }
+        cursor = b->slots();
+        limit = cursor + nextBlockNodes;
+        reserved += bytes;
+        if (nextBlockNodes < MaxBlockNodes) {
+            nextBlockNodes *= 2;  // 块容量翻倍, 减少申请次数
+        }
+    }
+
+public:
+    // 支持一次性释放所有节点
+    static const bool canRelease = true;
+
+    NodePool()
+            : freeList(nullptr), cursor(nullptr), limit(nullptr),
+              nextBlockNodes(MinBlockNodes), reserved(0) {}
+
+    // 共享内存需显式调用 share(), 禁止复制
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    ~NodePool() { release(); }
+
+    // 分配一块原始内存: 优先复用空闲链表, 其次从当前块切分, 最后申请新块
+    T *allocate() {
+        Slot *s;
+        if (freeList != nullptr) {
+            s = freeList;
+            freeList = freeList->next;
+        } else {
+            if (cursor == limit) {
+                _grow();
+            }
+            s = cursor++;
+        }
+        return reinterpret_cast<T *>(s->storage);
+    }
+
+    // 归还一块内存, 挂入空闲链表
+    void deallocate(T *p) {
+        Slot *s = reinterpret_cast<Slot *>(p);
+        s->next = freeList;
+        freeList = s;
+    }
+
+    // 一次性归还所有内存块 (调用者需保证本节点池分配出去的节点已析构)
+    // 与其他节点池共享内存时只放弃对所有者的持有: 内存块中可能还有其他节点池的节点, 等最后一个持有者释放时一起归还
+    void release() {
+        if (arena != nullptr) {
+            lock_guard<mutex> guard(_arenaLock());
+            arena.reset();  // 最后一个持有者放弃时所有者析构, 归还全部内存块
+        }
+        freeList = nullptr;
+        cursor = limit = nullptr;
+        nextBlockNodes = MinBlockNodes;
+        reserved = 0;
+    }
+
+    // 与 other 共享内存: 两者的内存块合并到同一个所有者, 之后任一方分配的节点都可以归还给另一方
+    // 耗时与 other 一方的内存块个数成正比 (块容量翻倍增长, 块数为 O(log n))
+    void share(NodePool &other) {
+        if (&other == this) {
+            return;
+        }
+        lock_guard<mutex> guard(_arenaLock());
+        Arena *mine = _owner();
+        Arena *theirs = other._owner();
+        if (mine == theirs) {
+            return;
+        }
+        if (theirs->blocks != nullptr) {  // 把对方的内存块链表接到本方链表之前
+            Block *last = theirs->blocks;
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            last->next = mine->blocks;
+            mine->blocks = theirs->blocks;
+            theirs->blocks = nullptr;
+        }
+        theirs->forward = arena;  // 仍持有旧所有者的节点池经由转发指针找到本方
+        other.arena = arena;
+    }
+
+    // 本节点池申请的字节数 (共享内存的其他节点池申请的不计入)
+    size_t bytesReserved() const { return reserved; }
+};
+
+#endif //LIBRARYMANAGEMENT_NODEPOOL_H
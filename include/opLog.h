@@ -0,0 +1,101 @@
+#ifndef LIBRARYMANAGEMENT_OPLOG_H
+#define LIBRARYMANAGEMENT_OPLOG_H
+
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "book.h"
+using namespace std;
+
+// 图书操作日志 (预写日志)
+// 每次修改图书数据时追加一条记录, 程序崩溃后可在启动时回放日志恢复数据
+// 记录格式 (小端序):
+// - uint32 负载长度
+// - uint32 负载的 CRC32 校验值
+// - 负载: 1 字节操作类型 + 操作数据
+// 记录先写入内存缓冲区, 调用 Commit 时一次性写入文件并刷盘 (组提交)
+class OpLog {
+public:
+    // 操作类型
+    enum OpType : unsigned char {
+        Put = 1,     // 写入一本书的完整信息 (新增、修改、借出、归还)
+        Remove = 2,  // 删除一本书, 只记录编号
+        Retitle = 3, // 修改一个 ISBN 的描述信息 (作用于该 ISBN 的所有副本), 记录原 ISBN 和新的描述信息
+        Checkpoint = 4, // 日志的第一条记录, 记录日志所接续的快照文件类型 (由 Reset 写入, 回放时跳过)
+    };
+
+    // 回放回调: 操作类型、书籍信息和原 ISBN
+    // Remove 时只有书籍编号有效; Retitle 时只有书籍的描述信息有效, 原 ISBN 只在 Retitle 时有效
+    typedef function<void(OpType, const Book&, const string&)> ApplyFunc;
+
+private:
+    FILE* file;              // 日志文件
+    bool failed;             // 写入或打开失败后置位, 之后的提交都失败, 直到 Reset 成功
+    string path;             // 日志文件路径
+    string buffer;           // 尚未提交的记录
+    size_t pendingCount;     // 缓冲区中的记录数
+    size_t recordCount;      // 自上次清空以来的记录数 (包括已提交和回放的)
+    size_t groupLimit;       // 缓冲区记录数达到该值时自动提交
+
+    // 向字符串追加一个带长度前缀的字符串
+    static void PutString(string& out, const string& s);
+    // 从缓冲区读取一个带长度前缀的字符串, 越界时返回 false
+    static bool GetString(const string& in, size_t& pos, string& s);
+
+    // 将负载封装为一条记录并追加到缓冲区
+    void Append(const string& payload);
+
+    // 解析一条记录的负载, 格式错误时返回 false
+    static bool Decode(const string& payload, OpType& type, Book& book, string& ISBN);
+
+public:
+    // 构造函数, groupLimit 为自动提交的记录数阈值
+    explicit OpLog(size_t groupLimit = 256);
+
+    // 析构函数, 提交剩余记录并关闭文件
+    ~OpLog();
+
+    // 禁止复制
+    OpLog(const OpLog&) = delete;
+    OpLog& operator=(const OpLog&) = delete;
+
+    // 以追加模式打开日志文件 (不存在则创建)
+    bool Open(const string& filePath);
+
+    // 提交剩余记录并关闭日志文件
+    void Close();
+
+    // 日志文件是否已打开
+    bool IsOpen() const;
+
+    // 追加一条写入记录
+    void AppendPut(const Book& book);
+
+    // 追加一条删除记录
+    void AppendRemove(int id);
+
+    // 追加一条描述信息修改记录, ISBN 为修改前的 ISBN
+    void AppendRetitle(const string& ISBN, const Title& title);
+
+    // 组提交: 把缓冲区中的记录一次性写入文件并刷盘
+    // 写入或刷盘失败时返回 false, 缓冲区中的记录被丢弃, 需要保存快照并 Reset 后才能恢复记录
+    bool Commit();
+
+    // 回放日志文件中所有完整且校验通过的记录
+    // 遇到不完整或校验失败的记录 (写入时崩溃) 即停止, 并截断文件的损坏尾部
+    // 校验通过却无法解析的记录说明日志已损坏, 此时不截断并返回 false; 截断失败也返回 false
+    bool Replay(const string& filePath, const ApplyFunc& apply);
+
+    // 清空日志 (快照写入完成后调用), 并写入一条接续 baseType 类型快照的检查点记录
+    // 打开或写入失败时返回 false
+    bool Reset(const string& baseType);
+
+    // 读取日志文件第一条检查点记录中的快照文件类型, 日志为空或没有检查点时返回空串
+    static string BaseType(const string& filePath);
+
+    // 自上次清空以来的记录数
+    size_t RecordCount() const;
+};
+
+#endif //LIBRARYMANAGEMENT_OPLOG_H
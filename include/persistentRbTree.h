@@ -0,0 +1,477 @@
+#ifndef LIBRARYMANAGEMENT_PERSISTENTRBTREE_H
+#define LIBRARYMANAGEMENT_PERSISTENTRBTREE_H
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "rbTree.h"
+using namespace std;
+
+// 持久化 (路径复制) 红黑树
+// 节点一经创建便不再修改, 插入和删除只复制根到目标节点路径上的 O(log n) 个节点,
+// 其余子树在新旧版本之间共享. 因此取得一个版本 (快照) 只需复制根指针, 为 O(1);
+// 读者持有快照期间看到的始终是同一份数据, 既不阻塞写者, 也不被写者阻塞.
+// 节点由引用计数管理, 没有任何版本引用的节点自动回收.
+// 写操作之间需要由调用者同步 (单写者); snapshot() 可以与写操作在不同线程并发调用.
+// 只支持键值唯一. 平衡算法参考 Okasaki 的插入与 Kahrs 的删除.
+//
+// 适用范围: 这里只提供容器本身, BookManager 没有使用它. BookManager 的二级索引 (ISBN、借出索引等)
+// 保存的是主索引的迭代器, 不可变节点无法被这样引用, 因此 Save、分页、报表和 PrintTreeStats
+// 仍然读取可变的主索引; 多线程访问 BookManager 请使用读写锁门面 ConcurrentBookManager.
+// 需要一致快照的独立数据 (例如只按编号查找的目录) 可以直接使用本容器, Snapshot 提供的 preorder()
+// 与 RbTree 相同, BookSnapshot::Write 可以直接写出一个固定的版本.
+// tests/persistentRbTreeTest.cpp (persistent_rbtree_test) 实例化并验证本容器, 包括以上用法.
+template <class Key, class Value, class KeyOfValue, class Compare>
+class PersistentRbTree {
+private:
+    struct Node;
+    typedef shared_ptr<const Node> NodePtr;
+
+    // 不可变节点
+    struct Node {
+        Color color;     // 节点颜色
+        NodePtr left;    // 左子树
+        NodePtr right;   // 右子树
+        size_t size;     // 子树的节点个数 (用于按名次查找)
+        Value value;     // 节点存储的值
+
+        Node(Color color, NodePtr left, const Value &value, NodePtr right)
+                : color(color),
+                  left(move(left)),
+                  right(move(right)),
+                  size(subtreeSize(this->left) + subtreeSize(this->right) + 1),
+                  value(value) {}
+    };
+
+public:
+    // 一个只读版本, 持有期间其中的所有节点都不会被回收或修改
+    class Snapshot {
+    private:
+        friend class PersistentRbTree;
+        NodePtr root;   // 该版本的根节点
+        Compare keyCompare;
+
+        Snapshot(NodePtr root, const Compare &comp) : root(move(root)), keyCompare(comp) {}
+
+    public:
+        // 中序迭代器, 只能在其所属的快照存活期间使用
+        class ConstIterator {
+        private:
+            friend class Snapshot;
+            vector<const Node *> path;  // 从根到当前节点的路径中尚未访问的祖先, 栈顶为当前节点
+
+            // 将 x 及其左侧链压栈, 栈顶为子树中的最小节点
+            void pushLeft(const Node *x) {
+                for (; x != nullptr; x = x->left.get()) {
+                    path.push_back(x);
+                }
+            }
+
+        public:
+            typedef forward_iterator_tag iterator_category;
+            typedef Value value_type;
+            typedef ptrdiff_t difference_type;
+            typedef const Value *pointer;
+            typedef const Value &reference;
+
+            const Value &operator*() const { return path.back()->value; }
+            const Value *operator->() const { return &path.back()->value; }
+
+            // 前进到中序后继
+            ConstIterator &operator++() {
+                const Node *x = path.back();
+                path.pop_back();
+                pushLeft(x->right.get());
+                return *this;
+            }
+
+            bool operator==(const ConstIterator &other) const {
+                return path.empty() ? other.path.empty()
+                                    : !other.path.empty() && path.back() == other.path.back();
+            }
+            bool operator!=(const ConstIterator &other) const { return !(*this == other); }
+        };
+
+        Snapshot() = default;
+
+        // 版本信息
+        bool empty() const { return root == nullptr; }
+        size_t size() const { return subtreeSize(root); }
+
+        // 迭代器
+        ConstIterator begin() const {
+            ConstIterator it;
+            it.pushLeft(root.get());
+            return it;
+        }
+        ConstIterator end() const { return ConstIterator(); }
+
+        // 查找键值为 k 的值, 不存在时返回 nullptr
+        const Value *find(const Key &k) const;
+        // 返回指向第一个键值不小于 k 的值的迭代器
+        ConstIterator lowerBound(const Key &k) const;
+        // 按名次查找, 返回第 k 小 (从 0 开始) 的值, 越界时返回 nullptr
+        const Value *select(size_t k) const;
+        // 求取键值小于 k 的值的个数
+        size_t rank(const Key &k) const;
+
+        // 先序遍历, 接口与 RbTree::preorder 相同, 可直接交给 BookSnapshot::Write 保存该版本
+        template <class Visit>
+        void preorder(Visit visit) const { _preorder(root, visit); }
+
+    private:
+        template <class Visit>
+        static void _preorder(const NodePtr &x, Visit &visit) {
+            if (x != nullptr) {
+                visit(x->value, x->color, x->left != nullptr, x->right != nullptr);
+                _preorder(x->left, visit);
+                _preorder(x->right, visit);
+            }
+        }
+    };
+
+private:
+    NodePtr root;        // 当前版本的根节点 (读写都通过 atomic_load / atomic_store)
+    Compare keyCompare;  // 键值比较
+
+    static size_t subtreeSize(const NodePtr &x) { return x == nullptr ? 0 : x->size; }
+    static bool isRed(const NodePtr &x) { return x != nullptr && x->color == Red; }
+    static bool isBlack(const NodePtr &x) { return x != nullptr && x->color == Black; }
+    static const Key &key(const NodePtr &x) { return KeyOfValue()(x->value); }
+
+    // 创建新节点
+    static NodePtr make(Color color, NodePtr left, const Value &value, NodePtr right) {
+        return make_shared<const Node>(color, move(left), value, move(right));
+    }
+    // 返回颜色改为黑色的节点 (已是黑色时原样返回)
+    static NodePtr blacken(const NodePtr &x) {
+        return isRed(x) ? make(Black, x->left, x->value, x->right) : x;
+    }
+    // 返回颜色改为红色的节点 (x 必须为黑色)
+    static NodePtr redden(const NodePtr &x) { return make(Red, x->left, x->value, x->right); }
+
+    // 以 a、x、b 构造黑色节点并消除红色节点相连的情况
+    static NodePtr _balance(const NodePtr &a, const Value &x, const NodePtr &b);
+    // 删除后左子树黑高减少 1 时的修正
+    static NodePtr _balanceLeft(const NodePtr &bl, const Value &x, const NodePtr &r);
+    // 删除后右子树黑高减少 1 时的修正
+    static NodePtr _balanceRight(const NodePtr &l, const Value &x, const NodePtr &bl);
+    // 连接两棵子树 (a 中的键值均小于 b), 用于删除节点
+    static NodePtr _append(const NodePtr &a, const NodePtr &b);
+
+    // 在 t 中插入 v, 返回新的子树; 键值已存在且 assign 为 false 时返回 t 本身
+    NodePtr _insert(const NodePtr &t, const Value &v, bool assign, bool &inserted) const;
+    // 在 t 中删除键值 k (k 必须存在), 返回新的子树
+    NodePtr _erase(const NodePtr &t, const Key &k) const;
+    // 由有序区间 [lo, hi) 构造子树, 最深一层 redDepth 染红
+    template <class RandomIt>
+    static NodePtr _buildSorted(RandomIt first, size_t lo, size_t hi, int depth, int redDepth);
+
+    // 检查以 x 为根的子树, 返回黑高, 不合法时返回 -1
+    int _verify(const NodePtr &x) const;
+
+public:
+    explicit PersistentRbTree(const Compare &comp = Compare()) : keyCompare(comp) {}
+
+    // 判断当前版本是否为合法的红黑树 (颜色、黑高、键值顺序和子树大小), 供测试调用, O(n)
+    bool _rb_verify() const;
+
+    // 取得当前版本的快照, O(1)
+    Snapshot snapshot() const { return Snapshot(atomic_load(&root), keyCompare); }
+
+    // 当前版本的信息
+    bool empty() const { return snapshot().empty(); }
+    size_t size() const { return snapshot().size(); }
+
+    // 插入新值, 键值已存在时不插入, 返回是否插入
+    bool insertUnique(const Value &v);
+    // 插入新值, 键值已存在时替换原有的值
+    void insertOrAssign(const Value &v);
+    // 删除键值为 k 的值, 返回是否删除
+    bool erase(const Key &k);
+    // 清空当前版本 (已取得的快照不受影响)
+    void clear() { atomic_store(&root, NodePtr()); }
+
+    // 由按键值严格递增的区间线性建树, 当前版本必须为空或将被替换
+    template <class RandomIt>
+    void buildUnique(RandomIt first, RandomIt last);
+};
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+const Value *PersistentRbTree<Key, Value, KeyOfValue, Compare>::Snapshot::find(const Key &k) const {
+    const Node *x = root.get();
+    while (x != nullptr) {
+        const Key &xk = KeyOfValue()(x->value);
+        if (keyCompare(k, xk)) {
+            x = x->left.get();
+        } else if (keyCompare(xk, k)) {
+            x = x->right.get();
+        } else {
+            return &x->value;
+        }
+    }
+    return nullptr;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::Snapshot::ConstIterator
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::Snapshot::lowerBound(const Key &k) const {
+    // 向左走的节点都在结果之后, 依次压栈, 栈顶即为第一个不小于 k 的节点
+    ConstIterator it;
+    const Node *x = root.get();
+    while (x != nullptr) {
+        if (!keyCompare(KeyOfValue()(x->value), k)) {
+            it.path.push_back(x);
+            x = x->left.get();
+        } else {
+            x = x->right.get();
+        }
+    }
+    return it;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+const Value *PersistentRbTree<Key, Value, KeyOfValue, Compare>::Snapshot::select(size_t k) const {
+    const Node *x = root.get();
+    while (x != nullptr) {
+        size_t leftSize = subtreeSize(x->left);
+        if (k < leftSize) {
+            x = x->left.get();
+        } else if (k == leftSize) {
+            return &x->value;
+        } else {
+            k -= leftSize + 1;
+            x = x->right.get();
+        }
+    }
+    return nullptr;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+size_t PersistentRbTree<Key, Value, KeyOfValue, Compare>::Snapshot::rank(const Key &k) const {
+    size_t r = 0;
+    const Node *x = root.get();
+    while (x != nullptr) {
+        if (keyCompare(KeyOfValue()(x->value), k)) {  // x 及其左子树都小于 k
+            r += subtreeSize(x->left) + 1;
+            x = x->right.get();
+        } else {
+            x = x->left.get();
+        }
+    }
+    return r;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_balance(const NodePtr &a, const Value &x,
+                                                             const NodePtr &b) {
+    if (isRed(a) && isRed(b)) {  // 两个子节点都为红色: 上移一层红色
+        return make(Red, blacken(a), x, blacken(b));
+    }
+    if (isRed(a) && isRed(a->left)) {  // 左左
+        return make(Red, blacken(a->left), a->value, make(Black, a->right, x, b));
+    }
+    if (isRed(a) && isRed(a->right)) {  // 左右
+        return make(Red, make(Black, a->left, a->value, a->right->left), a->right->value,
+                    make(Black, a->right->right, x, b));
+    }
+    if (isRed(b) && isRed(b->right)) {  // 右右
+        return make(Red, make(Black, a, x, b->left), b->value, blacken(b->right));
+    }
+    if (isRed(b) && isRed(b->left)) {  // 右左
+        return make(Red, make(Black, a, x, b->left->left), b->left->value,
+                    make(Black, b->left->right, b->value, b->right));
+    }
+    return make(Black, a, x, b);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_balanceLeft(const NodePtr &bl, const Value &x,
+                                                                 const NodePtr &r) {
+    if (isRed(bl)) {  // 左子树根为红色, 染黑即可补回黑高
+        return make(Red, blacken(bl), x, r);
+    }
+    if (isBlack(r)) {  // 右子树根为黑色, 将其染红后重新平衡
+        return _balance(bl, x, redden(r));
+    }
+    // 右子树根为红色, 其左子节点必为黑色: 旋转后在右侧重新平衡
+    return make(Red, make(Black, bl, x, r->left->left), r->left->value,
+                _balance(r->left->right, r->value, redden(r->right)));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_balanceRight(const NodePtr &l, const Value &x,
+                                                                  const NodePtr &bl) {
+    if (isRed(bl)) {  // 右子树根为红色, 染黑即可补回黑高
+        return make(Red, l, x, blacken(bl));
+    }
+    if (isBlack(l)) {  // 左子树根为黑色, 将其染红后重新平衡
+        return _balance(redden(l), x, bl);
+    }
+    // 左子树根为红色, 其右子节点必为黑色: 旋转后在左侧重新平衡
+    return make(Red, _balance(redden(l->left), l->value, l->right->left), l->right->value,
+                make(Black, l->right->right, x, bl));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_append(const NodePtr &a, const NodePtr &b) {
+    if (a == nullptr) {
+        return b;
+    }
+    if (b == nullptr) {
+        return a;
+    }
+    if (isRed(a) && isRed(b)) {
+        NodePtr bc = _append(a->right, b->left);
+        if (isRed(bc)) {
+            return make(Red, make(Red, a->left, a->value, bc->left), bc->value,
+                        make(Red, bc->right, b->value, b->right));
+        }
+        return make(Red, a->left, a->value, make(Red, bc, b->value, b->right));
+    }
+    if (isBlack(a) && isBlack(b)) {
+        NodePtr bc = _append(a->right, b->left);
+        if (isRed(bc)) {
+            return make(Red, make(Black, a->left, a->value, bc->left), bc->value,
+                        make(Black, bc->right, b->value, b->right));
+        }
+        return _balanceLeft(a->left, a->value, make(Black, bc, b->value, b->right));
+    }
+    if (isRed(b)) {
+        return make(Red, _append(a, b->left), b->value, b->right);
+    }
+    return make(Red, a->left, a->value, _append(a->right, b));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_insert(const NodePtr &t, const Value &v,
+                                                            bool assign, bool &inserted) const {
+    if (t == nullptr) {  // 新节点为红色
+        inserted = true;
+        return make(Red, nullptr, v, nullptr);
+    }
+    const Key &k = KeyOfValue()(v);
+    if (keyCompare(k, key(t))) {
+        NodePtr l = _insert(t->left, v, assign, inserted);
+        if (l == t->left) {
+            return t;  // 子树没有变化, 不必复制路径
+        }
+        return t->color == Black ? _balance(l, t->value, t->right) : make(Red, l, t->value, t->right);
+    }
+    if (keyCompare(key(t), k)) {
+        NodePtr r = _insert(t->right, v, assign, inserted);
+        if (r == t->right) {
+            return t;
+        }
+        return t->color == Black ? _balance(t->left, t->value, r) : make(Red, t->left, t->value, r);
+    }
+    // 键值已存在
+    return assign ? make(t->color, t->left, v, t->right) : t;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_erase(const NodePtr &t, const Key &k) const {
+    if (keyCompare(k, key(t))) {
+        if (isBlack(t->left)) {  // 从黑色子树中删除, 黑高减少 1, 需要修正
+            return _balanceLeft(_erase(t->left, k), t->value, t->right);
+        }
+        return make(Red, _erase(t->left, k), t->value, t->right);
+    }
+    if (keyCompare(key(t), k)) {
+        if (isBlack(t->right)) {
+            return _balanceRight(t->left, t->value, _erase(t->right, k));
+        }
+        return make(Red, t->left, t->value, _erase(t->right, k));
+    }
+    return _append(t->left, t->right);  // 删除 t, 连接左右子树
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+bool PersistentRbTree<Key, Value, KeyOfValue, Compare>::insertUnique(const Value &v) {
+    NodePtr t = atomic_load(&root);
+    bool inserted = false;
+    NodePtr r = _insert(t, v, false, inserted);
+    if (inserted) {
+        atomic_store(&root, blacken(r));  // 发布新版本, 根节点总为黑色
+    }
+    return inserted;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+void PersistentRbTree<Key, Value, KeyOfValue, Compare>::insertOrAssign(const Value &v) {
+    NodePtr t = atomic_load(&root);
+    bool inserted = false;
+    atomic_store(&root, blacken(_insert(t, v, true, inserted)));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+bool PersistentRbTree<Key, Value, KeyOfValue, Compare>::erase(const Key &k) {
+    Snapshot current = snapshot();
+    if (current.find(k) == nullptr) {  // 删除算法要求键值存在
+        return false;
+    }
+    atomic_store(&root, blacken(_erase(current.root, k)));
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+template <class RandomIt>
+typename PersistentRbTree<Key, Value, KeyOfValue, Compare>::NodePtr
+PersistentRbTree<Key, Value, KeyOfValue, Compare>::_buildSorted(RandomIt first, size_t lo, size_t hi,
+                                                                 int depth, int redDepth) {
+    if (lo >= hi) {
+        return nullptr;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    NodePtr l = _buildSorted(first, lo, mid, depth + 1, redDepth);
+    NodePtr r = _buildSorted(first, mid + 1, hi, depth + 1, redDepth);
+    return make(depth == redDepth ? Red : Black, move(l), first[mid], move(r));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+template <class RandomIt>
+void PersistentRbTree<Key, Value, KeyOfValue, Compare>::buildUnique(RandomIt first, RandomIt last) {
+    size_t n = last - first;
+    // 与 RbTree::buildUnique 相同: 树高 h = floor(log2 n), 最深一层染红
+    int h = 0;
+    while ((size_t(2) << h) <= n) {
+        ++h;
+    }
+    atomic_store(&root, _buildSorted(first, 0, n, 0, h > 0 ? h : -1));
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+int PersistentRbTree<Key, Value, KeyOfValue, Compare>::_verify(const NodePtr &x) const {
+    if (x == nullptr) {
+        return 0;
+    }
+    if (x->color == Red && (isRed(x->left) || isRed(x->right))) {
+        return -1;  // 两个连续的红色节点
+    }
+    if (x->size != subtreeSize(x->left) + subtreeSize(x->right) + 1) {
+        return -1;  // 子树大小错误
+    }
+    if ((x->left && !keyCompare(key(x->left), key(x))) || (x->right && !keyCompare(key(x), key(x->right)))) {
+        return -1;  // 键值顺序错误
+    }
+    int lh = _verify(x->left), rh = _verify(x->right);
+    if (lh < 0 || lh != rh) {
+        return -1;  // 左右黑高不同
+    }
+    return lh + (x->color == Black ? 1 : 0);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+bool PersistentRbTree<Key, Value, KeyOfValue, Compare>::_rb_verify() const {
+    NodePtr t = atomic_load(&root);
+    return !isRed(t) && _verify(t) >= 0;
+}
+
+#endif //LIBRARYMANAGEMENT_PERSISTENTRBTREE_H
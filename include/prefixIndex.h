@@ -0,0 +1,60 @@
+#ifndef LIBRARYMANAGEMENT_PREFIXINDEX_H
+#define LIBRARYMANAGEMENT_PREFIXINDEX_H
+
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+// 前缀索引 (压缩字典树 / radix trie), 用于输入过程中的即时补全
+// 键值为字符串 (书名或作者), 每个键值可对应多个值 (ISBN), 按字节比较, ASCII 字母不区分大小写
+// - 每条边上保存一段字符串, 只有一个子节点且没有值的节点总是与子节点合并
+//   因此每个内部节点至少有两个分支或带有值, 含 k 个键值的子树最多有 2k 个节点
+// - 子节点按边的首字节排序, 从前缀所在的节点开始深度优先遍历即按键值的字典序输出
+// 查找前缀的前 k 个结果: 定位前缀 O(前缀长度), 遍历子树直到收集满 k 个 O(k)
+class PrefixIndex {
+private:
+    // 字典树节点
+    struct Node {
+        string label;                     // 从父节点到该节点的边上的字符串 (根节点为空)
+        vector<unique_ptr<Node>> children;  // 子节点, 按 label 的首字节排序
+        vector<string> values;            // 键值恰好在该节点结束的值, 按字典序排列
+    };
+
+    Node root;     // 根节点
+    size_t count;  // (键值, 值) 对的个数
+
+    // 统一大小写后的键值
+    static string _normalize(const string& key);
+
+    // 在 node 的子节点中查找边的首字节为 c 的子节点, 返回其下标或应插入的位置
+    static size_t _childIndex(const Node& node, unsigned char c);
+
+    // 从 node 开始删除 key[pos..] 对应的值, 返回是否删除了
+    // 删除后没有值且没有子节点的子节点被移除, 只剩一个子节点且没有值的子节点与其子节点合并
+    bool _erase(Node& node, const string& key, size_t pos, const string& value);
+
+    // 按字典序遍历以 node 为根的子树, 收集值直到 result 中有 k 个
+    static void _collect(const Node& node, size_t k, vector<string>& result);
+
+public:
+    // 构造函数, 索引为空
+    PrefixIndex();
+
+    // 清空索引
+    void Clear();
+
+    // 登记 (key, value), 已存在时不做任何事
+    void Insert(const string& key, const string& value);
+
+    // 移除 (key, value), 不存在时不做任何事
+    void Erase(const string& key, const string& value);
+
+    // 返回键值以 prefix 开头的前 k 个值, 按键值的字典序 (键值相同时按值的字典序) 排列
+    vector<string> Complete(const string& prefix, size_t k) const;
+
+    // (键值, 值) 对的个数
+    size_t Size() const;
+};
+
+#endif //LIBRARYMANAGEMENT_PREFIXINDEX_H
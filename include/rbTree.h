@@ -1,10 +1,55 @@
 #ifndef LIBRARYMANAGEMENT_RBTREE_H
 #define LIBRARYMANAGEMENT_RBTREE_H
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include <utility>
+#include <type_traits>
+#include <vector>
+#include "nodePool.h"
 using namespace std;
 
+// 结构统计计数器 (旋转、重新着色、查找比较次数)
+// 编译时定义 RBTREE_STATS 开启 (CMake 选项 -DRBTREE_STATS=ON), 未定义时计数语句展开为空, 树中也不保存计数器
+#ifdef RBTREE_STATS
+#define RBTREE_COUNT(counter, n) (counters.counter += (n))
+#else
+#define RBTREE_COUNT(counter, n) ((void) 0)
+#endif
+
+// 红黑树的结构统计, 由 RbTree::stats() 返回
+struct RbTreeStats {
+    // 形状 (每次调用 stats() 时遍历整棵树计算, 与计数器开关无关)
+    size_t size = 0;            // 节点个数
+    size_t height = 0;          // 高度 (根节点深度为 1)
+    size_t blackHeight = 0;     // 黑高 (根到任一空叶子路径上的黑色节点个数)
+    double averageDepth = 0;    // 节点的平均深度
+
+    // 计数器 (自构造或上次 resetStats() 以来的累计值, 未开启 RBTREE_STATS 时均为 0)
+    bool counting = false;      // 是否开启了计数器
+    size_t rotateLeft = 0;      // 左旋次数
+    size_t rotateRight = 0;     // 右旋次数
+    size_t insertRecolors = 0;  // 插入后平衡 (Rebalance) 中的重新着色次数
+    size_t eraseRecolors = 0;   // 删除后平衡 (RebalanceForErase) 中的重新着色次数
+    size_t finds = 0;           // find 调用次数
+    size_t findCompares = 0;    // find 中的键值比较次数
+
+    // 输出统计
+    void print(ostream &out) const {
+        out << "节点数: " << size << "  高度: " << height << "  黑高: " << blackHeight
+            << "  平均深度: " << averageDepth << endl;
+        if (!counting) {
+            out << "计数器未开启 (编译时定义 RBTREE_STATS 开启)" << endl;
+            return;
+        }
+        out << "左旋: " << rotateLeft << "  右旋: " << rotateRight
+            << "  插入着色: " << insertRecolors << "  删除着色: " << eraseRecolors << endl
+            << "查找: " << finds << " 次, 平均比较 "
+            << (finds ? (double) findCompares / finds : 0) << " 次" << endl;
+    }
+};
+
 // 定义颜色类型，使用 bool 类型表示节点的颜色
 typedef bool Color;
 // 定义红色节点的颜色为 false
@@ -22,6 +67,7 @@ struct Node {
     NodePtr parent;  // 父节点指针
     NodePtr left;    // 左子节点指针
     NodePtr right;   // 右子节点指针
+    size_t size;     // 以该节点为根的子树的节点个数 (用于按名次查找)
     Value value;     // 节点存储的值
 
     // 构造函数，初始化节点时设置颜色为红色，父节点和子节点为空，值为传入的参数
@@ -30,8 +76,21 @@ struct Node {
               parent(nullptr),  // 父节点为空
               left(nullptr),    // 左子节点为空
               right(nullptr),   // 右子节点为空
+              size(1),          // 新节点的子树只有自己
               value(v) {}  // 节点的值为传入的参数值
 
+    // 原位构造: 以 args 直接构造节点中的值 (右值参数被移入), 不经过临时对象
+    template <class... Args>
+    explicit Node(in_place_t, Args &&...args)
+            : color(Red), parent(nullptr), left(nullptr), right(nullptr), size(1),
+              value(std::forward<Args>(args)...) {}
+
+    // 求取子树大小, 空子树为 0
+    static size_t subtreeSize(NodePtr x) { return x == nullptr ? 0 : x->size; }
+
+    // 由左右子树重新计算节点的子树大小
+    static void updateSize(NodePtr x) { x->size = subtreeSize(x->left) + subtreeSize(x->right) + 1; }
+
     // 求取最小节点
     static NodePtr minimum(NodePtr x) {
         // 一直走到最左边，找到极小值
@@ -71,8 +130,14 @@ struct Iterator {
     // 构造函数，初始化迭代器并将 node 指向给定节点
     Iterator(NodePtr x) { node = x; }
 
-    // 复制构造函数，从另一个迭代器复制节点
-    Iterator(const iterator &it) { node = it.node; }
+    // 复制构造函数和复制赋值，直接复制节点指针
+    Iterator(const Iterator &) = default;
+    Iterator &operator=(const Iterator &) = default;
+
+    // 转换构造函数，由普通迭代器构造常量迭代器
+    template <class R, class P, class = typename enable_if<
+            is_same<Iterator<Value, R, P>, iterator>::value && !is_same<iterator, Self>::value>::type>
+    Iterator(const Iterator<Value, R, P> &it) { node = it.node; }
 
     // 解引用运算符，返回当前节点的值
     Ref operator*() const { return node->value; }
@@ -163,8 +228,22 @@ bool operator!=(const Iterator<Value, Ref, Ptr> &x,
     return x.node != y.node;
 }
 
+// 子树聚合的默认策略: 不维护任何聚合值 (调用全部展开为空)
+// 自定义策略 (例如统计子树中满足某条件的节点数) 需提供:
+// - enabled: 为 true
+// - update(x): 由 x 自身的值和左右子节点 (其聚合值已是最新) 重新计算 x 的聚合值
+// 聚合值保存在值类型中 (不参与键值比较), 树在插入、删除、旋转和批量构造时自底向上调用 update
+template <class Value>
+struct NoAugment {
+    static constexpr bool enabled = false;
+    static void update(Node<Value> *) {}
+};
+
 // 红黑树
-template <class Key, class Value, class KeyOfValue, class Compare>
+// Alloc：节点分配策略, 默认使用节点池 (见 nodePool.h), 也可指定 NewAllocator 使用 new / delete
+// Augment：子树聚合策略, 默认不维护 (见 NoAugment); 子树大小 (用于按名次查找) 总是维护, 不经过该策略
+template <class Key, class Value, class KeyOfValue, class Compare,
+          class Alloc = NodePool<Node<Value>>, class Augment = NoAugment<Value>>
 class RbTree {
 public:
     // 类型定义部分
@@ -181,7 +260,11 @@ private:
     // 内部成员变量
     size_t nodeCount;      // 树的节点总数
     Compare keyCompare;    // 键值比较函数对象
-    NodePtr header;        // header 节点，简化边界处理
+    Alloc nodeAllocator;   // 节点分配器
+    NodePtr header;        // header 节点，简化边界处理 (不由分配器管理)
+#ifdef RBTREE_STATS
+    RbTreeStats counters;  // 结构统计计数器 (只使用其中的计数器字段)
+#endif
     // header 的作用：
     // 1. header->parent 指向根节点
     // 2. header->left 指向最小节点
@@ -203,26 +286,128 @@ private:
 
     // 树结构调整
     // 左旋（x 是旋转点, root 是根节点）
-    static void RotateLeft(NodePtr x, NodePtr &root);
+    // (以下四个函数为非静态成员, 以便累计本树的结构统计计数器)
+    void RotateLeft(NodePtr x, NodePtr &root);
     // 右旋（x 是旋转点, root 是根节点）
-    static void RotateRight(NodePtr x, NodePtr &root);
+    void RotateRight(NodePtr x, NodePtr &root);
     // 重新令红黑树平衡 (x 是新节点, root 是根节点)
-    static void Rebalance(NodePtr x, NodePtr &root);
+    void Rebalance(NodePtr x, NodePtr &root);
     // 移除节点后重新令树平衡
     // z：要移除的节点, root：是根节点, leftmost：是最左节点, rightmost：是最右节点
     // 返回移除的节点
-    static NodePtr RebalanceForErase(NodePtr z, NodePtr &root, NodePtr &leftmost, NodePtr &rightmost);
+    NodePtr RebalanceForErase(NodePtr z, NodePtr &root, NodePtr &leftmost, NodePtr &rightmost);
 
     // 内部操作
-    // 插入实现
-    iterator _insert(NodePtr x, NodePtr y, const Value &v);
+    // 自 x 起向上直到根, 逐个重新计算子树聚合值 (未启用聚合时为空操作)
+    void _augmentPath(NodePtr x) {
+        if (Augment::enabled) {
+            for (; x != header; x = parent(x)) {
+                Augment::update(x);
+            }
+        }
+    }
+    // 插入实现: 把已构造好的节点 z 链接到插入点 x (父节点为 y) 并重新平衡
+    iterator _insert(NodePtr x, NodePtr y, NodePtr z);
+    // 查找键值 k 不重复时的插入点: 返回 true 时新节点作为 y 的子节点插入; 返回 false 时 y 为键值重复的节点
+    bool _uniquePos(const Key &k, NodePtr &y);
+    // 查找键值 k 的插入点 (插在相同键值之后), 返回插入点的父节点
+    NodePtr _equalPos(const Key &k);
+    // 各插入操作的实现, v 为左值时复制, 为右值时移入节点
+    template <class V>
+    pair<iterator, bool> _insertUnique(V &&v);
+    template <class V>
+    iterator _insertEqual(V &&v);
+    template <class V>
+    iterator _insertUnique(iterator position, V &&v);
+    template <class V>
+    iterator _insertEqual(iterator position, V &&v);
+    // 查询操作的实现, k 可以是任何能与键值比较的类型
+    template <class K>
+    iterator _find(const K &k);
+    template <class K>
+    iterator _lowerBound(const K &k);
+    template <class K>
+    iterator _upperBound(const K &k);
     // 移除以 x 为根节点的整棵子树, 不进行平衡操作
     void _erase(NodePtr x);
+    // 析构以 x 为根节点的整棵子树中的值, 不归还内存 (配合分配器的一次性释放使用)
+    void _destroyValues(NodePtr x);
+    // 从分配器取得内存并以 args 原位构造节点的值
+    template <class... Args>
+    NodePtr _createNode(Args &&...args);
+    // 析构节点并将内存归还给分配器
+    void _destroyNode(NodePtr x);
     // 复制一个节点的值和颜色
     NodePtr _cloneNode(NodePtr x);
     // 复制以 x 为根节点的子树至另一棵树的节点 p 下
     // 返回复制子树的根节点 (父节点为 p)
     NodePtr _copy(NodePtr x, NodePtr p);
+    // 由有序区间 [first + lo, first + hi) 直接构造子树, 父节点为 p
+    // 取区间中点为子树根, 深度为 redDepth 的节点染为红色, 其余为黑色
+    // 返回构造出的子树根节点
+    template <class RandomIt>
+    NodePtr _buildSorted(RandomIt first, size_t lo, size_t hi, NodePtr p,
+                         int depth, int redDepth);
+    // 检查有序区间是否满足插入要求 (unique 为 true 时要求严格递增, 否则要求非递减)
+    template <class RandomIt>
+    bool _isSorted(RandomIt first, RandomIt last, bool unique) const;
+    // 批量构造的实现, unique 表示键值是否允许重复
+    template <class RandomIt>
+    bool _build(RandomIt first, RandomIt last, bool unique);
+    // 先序遍历以 x 为根的子树
+    template <class Visit>
+    void _preorder(NodePtr x, Visit &visit) const;
+    // 按先序序列重建以 x 为根的子树, 父节点为 p, remaining 为剩余可读取的节点数
+    // 返回子树根节点, 序列不合法时返回 nullptr
+    template <class Next>
+    NodePtr _buildPreorder(Next &next, NodePtr p, size_t &remaining, bool &ok);
+    // n 个节点按 _buildSorted 的形状构造时需要染红的深度 (不需要染红时为 -1)
+    static int _redDepth(size_t n);
+    // 以 x 为根重新设置整棵树: 根节点、最左与最右节点、节点总数 n
+    void _resetRoot(NodePtr x, size_t n);
+
+    // 区间删除与批量删除
+    // 以下函数操作的子树都是独立的红黑树: 根节点为黑色, 根节点的父指针为空
+    // 区间不短于该长度时按名次拆分后整段删除, 否则逐个删除
+    static constexpr size_t SplitEraseMin = 64;
+    // 节点 x 的中序名次 (从 0 开始), O(log n)
+    size_t _rankOf(NodePtr x) const;
+    // 子树的黑高 (沿最左路径数黑色节点, 空树为 0)
+    static int _blackHeight(NodePtr x);
+    // 以单个节点 k 连接两棵子树, 要求 l 中的键值都不大于 k, r 中的键值都不小于 k
+    // 沿较高子树的边界下降到黑高与较矮子树相同的黑色节点处接入 k, 再按插入的方式向上修复, 返回新的根节点
+    NodePtr _join(NodePtr l, NodePtr k, NodePtr r);
+    // 连接两棵子树 (l 中的键值都不大于 r 中的键值), 以 l 的最大节点作为连接点
+    NodePtr _join2(NodePtr l, NodePtr r);
+    // 按中序名次拆分子树 t: 前 n 个节点构成 l, 其余构成 r, O(log n)
+    void _splitAt(NodePtr t, size_t n, NodePtr &l, NodePtr &r);
+    // 移除区间 [first, last) 中的节点, 返回移除的节点个数
+    size_t _eraseRange(iterator first, iterator last);
+    // 中序遍历子树 x: pred 为真的节点析构, 其余节点借用 right 指针依次串到 tail 之后
+    template <class Pred>
+    void _sieve(NodePtr x, Pred &pred, NodePtr *&tail, size_t &kept);
+    // 从 right 指针串起的有序链表 list 中依次取出 n 个节点, 按 _buildSorted 的形状重建子树, 父节点为 p
+    NodePtr _buildFromList(NodePtr &list, size_t n, NodePtr p, int depth, int redDepth);
+
+    // 拆分、连接与合并
+    // 把 x 作为独立的子树取下 (根节点染黑, 黑高可能加一, 仍然合法), x 可以为空
+    static void _detach(NodePtr x) {
+        if (x != 0) {
+            parent(x) = 0;
+            color(x) = Black;
+        }
+    }
+    // 合并的子问题 (两棵子树的节点总数) 不少于该值时才分出线程, 更小的子问题创建线程的开销超过收益
+    static constexpr size_t ParallelUnionMin = 1 << 14;
+    // 按键值拆分子树 t: 键值小于 k 的节点构成 l, 大于 k 的构成 r, 等于 k 的节点 (至多一个) 单独取下放入 dup
+    void _splitKey(NodePtr t, const Key &k, NodePtr &l, NodePtr &r, NodePtr &dup);
+    // other 一侧的子树不超过该节点数时, 把其中的节点逐个链接进另一侧 (不再拆分, 省去连接时计算黑高的开销)
+    static constexpr size_t UnionLinkMax = 8;
+    // 把已取下的单个节点 z 链接进独立子树 t 并重新平衡 (键值不允许重复), 键值重复时不链接并返回 false
+    bool _linkUnique(NodePtr &t, NodePtr z);
+    // 合并两棵键值不重复的子树, a 中的节点优先; b 中与 a 重复的节点从树中取下放入 dups, 不在这里析构
+    // spawnDepth 为还可以分出线程的层数, 返回合并后的根节点
+    NodePtr _union(NodePtr a, NodePtr b, int spawnDepth, vector<NodePtr> &dups);
     // 空树的初始化
     void _emptyInitialize() {
         header = new Node();  // 构造 header 节点
@@ -234,19 +419,20 @@ private:
 
     // 调试和验证
     // 返回 node节点到根节点路径上的黑色节点个数
-    int _blackCount(NodePtr node, NodePtr root);
-    // 判断红黑树是否正确
-    bool _rb_verify() const;
+    static int _blackCount(NodePtr node, NodePtr root);
+    // 累计以 x 为根 (深度为 depth) 的子树的最大深度和深度之和
+    static void _depthStats(NodePtr x, size_t depth, size_t &height, size_t &depthSum);
 
 public:
     // 构造函数与析构函数
     explicit RbTree(const Compare &comp = Compare()) : nodeCount(0), keyCompare(comp) { _emptyInitialize(); }
     // 复制构造函数
-    RbTree(const RbTree<Key, Value, KeyOfValue, Compare> &t)
+    RbTree(const RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment> &t)
             : nodeCount(0), keyCompare(t.keyCompare) {
         if (t.root() == 0) {     // 如果 t 是空树
             _emptyInitialize();  // 则初始化一棵空树
         } else {                 // 如果 t 非空树则进行复制
+            header = new Node();  // 构造 header 节点
             color(header) = Red;
             root() = _copy(t.root(), header);  // 复制
             leftmost() = minimum(root());      // 设定最左节点
@@ -277,34 +463,120 @@ public:
     constIterator end() const { return header; }
 
     // 插入操作
-    // 插入新值, 节点键值不允许重复, 若重复则插入无效
+    // 以下各操作都有复制 (const Value &) 和移动 (Value &&) 两个版本, 右值参数直接移入新节点
+    // 插入新值, 节点键值不允许重复, 若重复则插入无效 (键值重复时不分配节点, 右值参数也保持不变)
     // 返回值是 pair, 第一个元素是指向新增节点 (或重复键值节点) 的迭代器；第二个元素表示插入是否成功
-    pair<iterator, bool> insertUnique(const Value &v);
+    pair<iterator, bool> insertUnique(const Value &v) { return _insertUnique(v); }
+    pair<iterator, bool> insertUnique(Value &&v) { return _insertUnique(std::move(v)); }
     // 插入新值, 节点键值允许重复
     // 返回指向新增节点的迭代器
-    iterator insertEqual(const Value &v);
+    iterator insertEqual(const Value &v) { return _insertEqual(v); }
+    iterator insertEqual(Value &&v) { return _insertEqual(std::move(v)); }
     // 在指定位置插入新值, 节点键值不允许重复, 若重复则插入无效
     // 先判断插入位置是否正确, 正确则直接插入；错误则会先寻找到正确的位置再插入
     // 返回指向新增节点 (或重复键值节点) 的迭代器
-    iterator insertUnique(iterator position, const Value &v);
+    iterator insertUnique(iterator position, const Value &v) { return _insertUnique(position, v); }
+    iterator insertUnique(iterator position, Value &&v) { return _insertUnique(position, std::move(v)); }
     // 在指定位置插入新值, 节点键值允许重复
     // 返回指向新增节点的迭代器
-    iterator insertEqual(iterator position, const Value &v);
+    iterator insertEqual(iterator position, const Value &v) { return _insertEqual(position, v); }
+    iterator insertEqual(iterator position, Value &&v) { return _insertEqual(position, std::move(v)); }
+    // 以 args 在新节点中原位构造值, 节点键值不允许重复
+    // 需要先构造出值才能取得键值, 因此键值重复时新节点会被立即析构 (已知不重复时比 insertUnique 少一次复制或移动)
+    // 返回值与 insertUnique 相同
+    template <class... Args>
+    pair<iterator, bool> emplaceUnique(Args &&...args);
+    // 以 args 在新节点中原位构造值, 节点键值允许重复
+    // 返回指向新增节点的迭代器
+    template <class... Args>
+    iterator emplaceEqual(Args &&...args);
+
+    // 批量构造
+    // 由按键值有序的区间 [first, last) 在 O(n) 时间内直接构造红黑树, 不做任何旋转
+    // 仅当树为空且区间有序时走线性构造; 否则退化为逐个插入 (结果相同, 只是更慢)
+    // 返回是否使用了线性构造
+    // 键值不允许重复 (区间需严格递增, 重复键值在退化路径中被忽略)
+    template <class RandomIt>
+    bool buildUnique(RandomIt first, RandomIt last) { return _build(first, last, true); }
+    // 键值允许重复 (区间需非递减)
+    template <class RandomIt>
+    bool buildEqual(RandomIt first, RandomIt last) { return _build(first, last, false); }
+
+    // 形状序列化
+    // 先序遍历整棵树, 对每个节点调用 visit(值, 颜色, 是否有左子节点, 是否有右子节点)
+    template <class Visit>
+    void preorder(Visit visit) const { _preorder(root(), visit); }
+    // 由 preorder 产生的 n 个节点的序列原样重建树的形状与颜色, 不做比较和平衡操作
+    // next(值, 颜色, 是否有左子节点, 是否有右子节点) 依次填入每个节点的信息, 读取失败时返回 false
+    // 仅用于空树; 序列不合法时清空已建的部分并返回 false
+    template <class Next>
+    bool buildPreorder(size_t n, Next next);
 
     // 删除操作
     // 移除指定位置的节点
     void erase(iterator position);
+    // 移除区间 [first, last) 中的 k 个节点
+    // 区间较短时逐个删除; 否则按名次把树拆成三段, 整段析构中间一段, 再把两端连接起来, O(log n + k)
+    void erase(iterator first, iterator last) { _eraseRange(first, last); }
+    // 移除键值为 k 的所有节点, 返回移除的节点个数, O(log n + k)
+    size_t erase(const Key &k) {
+        pair<iterator, iterator> range = equalRange(k);
+        return _eraseRange(range.first, range.second);
+    }
+    // 移除所有满足 pred(值) 的节点, 返回移除的节点个数
+    // 一次中序遍历析构被移除的节点并把保留的节点串成链表, 最后按批量构造的形状一次性重建, O(n), 不做旋转
+    // 总是遍历并重建整棵树: 移除约一半以上的节点时比逐个 erase 快, 只移除少数节点时逐个 erase 更合适
+    // pred 按中序对每个节点调用一次, 不能抛出异常, 也不能访问本树
+    template <class Pred>
+    size_t eraseIf(Pred pred);
+
+    // 拆分与连接
+    // 在两棵树之间整体移动节点, 不复制值, 只沿少数几条路径调整结构, O(log n)
+    // 有节点移动时两棵树的分配器共享内存 (见 NodePool::share): 之后任一方都可以归还对方的节点,
+    // 但一方清空时它的节点内存要等另一方也释放后才归还
+    // 把键值不小于 k 的节点移到 right, 本树保留键值小于 k 的节点
+    // right 必须是空树, 否则不做任何事并返回 false
+    bool split(const Key &k, RbTree &right);
+    // 把 right 的全部节点接到本树最大的节点之后, right 变为空树
+    // 要求 right 中的键值都不小于本树中的键值 (O(1) 检查), 否则不做任何事并返回 false
+    // 键值不允许重复的树还应保证两者没有相同的键值
+    bool join(RbTree &right);
+    // 把 other 的全部节点并入本树, other 变为空树; 返回新增的节点个数
+    // 仅用于键值不允许重复的树: 与本树重复的键值保留本树的节点, other 中的重复节点被析构
+    // 分治: 以本树的根节点拆分 other, 根的两侧各自递归合并后再以根节点连接, 两侧互不相交, 前几层在不同线程中同时进行
+    // 总工作量 O(m log(n / m + 1)) (m <= n 为两棵树中较小的节点数), 不分配节点, 也不复制值
+    // threads 为最多使用的线程数 (0 表示硬件线程数); 比较函数不能抛出异常, 也不能访问这两棵树
+    size_t unionWith(RbTree &other, unsigned threads = 0);
+
+    // 子树聚合
+    // 节点的值中参与聚合的字段 (不含键值) 被原地修改后调用, 重新计算该节点到根路径上的聚合值
+    void refresh(iterator position) { _augmentPath(position.node); }
 
     // 查询操作
+    // find、equalRange、lowerBound、upperBound 另有接受任意类型 k 的版本, 仅当比较函数是透明的
+    // (定义了 is_transparent, 例如 std::less<>) 时可用, 直接以 k 与键值比较, 不构造临时的 Key
+    // (例如键值为 string 时可以用 string_view 或字符串字面量查找而不分配内存)
     // 寻找键值为 k 的节点的迭代器
-    iterator find(const Key &k);
+    iterator find(const Key &k) { return _find(k); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K &k) { return _find(k); }
+    // 按名次查找, 返回中序第 k 个 (从 0 开始) 节点的迭代器, k 越界时返回 end()
+    iterator select(size_t k);
+    // 返回键值小于 k 的节点个数, 即 lowerBound(k) 的名次
+    size_t rank(const Key &k);
     // 返回键值为 k 的节点区间
     // 返回 pair, 第一个元素是首个 >= k 的节点的迭代器；第二个元素是首个 > k 的节点的迭代器
-    pair<iterator, iterator> equalRange(const Key &k);
+    pair<iterator, iterator> equalRange(const Key &k) { return {_lowerBound(k), _upperBound(k)}; }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    pair<iterator, iterator> equalRange(const K &k) { return {_lowerBound(k), _upperBound(k)}; }
     // 返回首个 >= k 的节点的迭代器
-    iterator lowerBound(const Key &k);
+    iterator lowerBound(const Key &k) { return _lowerBound(k); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator lowerBound(const K &k) { return _lowerBound(k); }
     // 返回首个 > k 的节点的迭代器
-    iterator upperBound(const Key &k);
+    iterator upperBound(const Key &k) { return _upperBound(k); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator upperBound(const K &k) { return _upperBound(k); }
 
     // 中序遍历函数
     void inOrderTraversal() const;
@@ -317,19 +589,29 @@ public:
     NodePtr rootNode() const {
         return root();
     }
+
+    // 调试和验证
+    // 判断红黑树是否正确 (颜色、黑高、键值顺序、子树大小和最左/最右节点), 供测试调用, O(n log n)
+    bool _rb_verify() const;
+
+    // 结构统计
+    // 返回树的形状 (高度、黑高、平均深度, O(n) 遍历) 以及计数器的累计值
+    RbTreeStats stats() const;
+    // 清零计数器
+    void resetStats();
 };
 
 #include "rbTree.h"
 
 // 红黑树的中序遍历函数定义
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::inOrderTraversal() const {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::inOrderTraversal() const {
     inOrderTraversal(root());
 }
 
 // 辅助函数的定义
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::inOrderTraversal(NodePtr root) const {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::inOrderTraversal(NodePtr root) const {
     if (root == nullptr) return;
 
     // 递归遍历左子树
@@ -344,8 +626,8 @@ void RbTree<Key, Value, KeyOfValue, Compare>::inOrderTraversal(NodePtr root) con
 }
 
 // 删除最右节点函数定义
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::removeRightmost() {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::removeRightmost() {
     if (empty()) {
         cout << "The tree is empty." << endl;
         return;
@@ -356,21 +638,19 @@ void RbTree<Key, Value, KeyOfValue, Compare>::removeRightmost() {
     cout << "Before removing, Rightmost Node ID: " << key(maxNode)
          << ", Color: " << (maxNode->color == Red ? "RED" : "BLACK") << endl;
 
+    Key removedKey = key(maxNode);  // 删除后节点内存会被回收, 先保存键值
     erase(iterator(maxNode));  // 删除节点
-    cout << "Removed the rightmost node: " << key(maxNode) << endl;
+    cout << "Removed the rightmost node: " << removedKey << endl;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::_insert(NodePtr x, NodePtr y,
-                                                 const Value &v) {
-    // x 是新值的插入点, y 是插入点的父节点, v 是新值
-    NodePtr z;
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insert(NodePtr x, NodePtr y, NodePtr z) {
+    // x 是新值的插入点, y 是插入点的父节点, z 是已构造好值的新节点
 
     // 如果 y 是 header 或者 x 不为 null（意味着找到插入点），并且新值小于父节点
     // 则将新节点作为左子节点插入
-    if (y == header || x != 0 || keyCompare(KeyOfValue()(v), key(y))) {
-        z = new Node(v);  // 创建新的节点 z
+    if (y == header || x != 0 || keyCompare(key(z), key(y))) {
         left(y) = z;      // 将父节点 y 的左子节点指向新节点 z
         // 如果 y 是 header，说明树为空，插入的节点成为根节点
         if (y == header) {
@@ -380,7 +660,6 @@ RbTree<Key, Value, KeyOfValue, Compare>::_insert(NodePtr x, NodePtr y,
             leftmost() = z;  // 更新 leftmost 为新节点 z
         }
     } else {  // 如果新值不小于父节点，则插入右子树
-        z = new Node(v);  // 创建新的节点 z
         right(y) = z;     // 将父节点 y 的右子节点指向新节点 z
         if (y == rightmost()) {  // 如果 y 为最右节点
             rightmost() = z;  // 更新 rightmost 为新节点 z
@@ -389,6 +668,11 @@ RbTree<Key, Value, KeyOfValue, Compare>::_insert(NodePtr x, NodePtr y,
     parent(z) = y;  // 设置新节点 z 的父节点为 y
     left(z) = 0;    // 设置新节点的左子节点为 nullptr
     right(z) = 0;   // 设置新节点的右子节点为 nullptr
+    // 新节点的所有祖先的子树大小加一, 之后的旋转会在局部修正大小
+    for (NodePtr p = y; p != header; p = parent(p)) {
+        ++p->size;
+    }
+    _augmentPath(z);  // 聚合值需要由下而上重新计算, 不能像大小那样逐个加一
 
     // 重新平衡树，保持红黑树的性质
     Rebalance(z, header->parent);  // 新节点的颜色在平衡过程中设定
@@ -398,24 +682,58 @@ RbTree<Key, Value, KeyOfValue, Compare>::_insert(NodePtr x, NodePtr y,
 }
 
 // 移除以 x 为根节点的整棵子树, 不进行平衡操作
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::_erase(NodePtr x) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_erase(NodePtr x) {
     while (x != 0) {
         _erase(right(x));  // 递归实现
         NodePtr y = left(x);
-        delete x;
+        _destroyNode(x);
         x = y;
     }
 }
 
+// 析构以 x 为根节点的整棵子树中的值, 内存留给分配器一次性回收
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_destroyValues(NodePtr x) {
+    while (x != 0) {
+        _destroyValues(right(x));  // 递归实现
+        NodePtr y = left(x);
+        x->~Node();
+        x = y;
+    }
+}
+
+// 从分配器取得内存并在其上构造节点
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class... Args>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_createNode(Args &&...args) {
+    NodePtr p = nodeAllocator.allocate();
+    try {
+        new (p) Node(in_place, std::forward<Args>(args)...);  // 在分配到的内存上直接构造值
+    } catch (...) {
+        nodeAllocator.deallocate(p);  // 构造失败时归还内存
+        throw;
+    }
+    return p;
+}
+
+// 析构节点并归还内存
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_destroyNode(NodePtr x) {
+    x->~Node();
+    nodeAllocator.deallocate(x);
+}
+
 // 克隆一个节点，并返回新创建的节点指针
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::NodePtr
-RbTree<Key, Value, KeyOfValue, Compare>::_cloneNode(NodePtr x) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_cloneNode(NodePtr x) {
     // 创建一个新的节点 tmp，值与原节点 x 相同
-    NodePtr tmp = new Node(x->value);
+    NodePtr tmp = _createNode(x->value);
     // 将新节点的颜色设置为原节点 x 的颜色
     tmp->color = x->color;
+    tmp->size = x->size;  // 子树结构相同, 大小也相同
     // 初始化新节点的左右子节点为 null（即没有子节点）
     tmp->left = 0;
     tmp->right = 0;
@@ -424,9 +742,9 @@ RbTree<Key, Value, KeyOfValue, Compare>::_cloneNode(NodePtr x) {
 }
 
 // 递归复制一棵子树，并返回复制后的子树根节点指针
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::NodePtr
-RbTree<Key, Value, KeyOfValue, Compare>::_copy(NodePtr x, NodePtr p) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_copy(NodePtr x, NodePtr p) {
     // 克隆当前节点 x，作为新树的根节点
     NodePtr top = _cloneNode(x);
     top->parent = p;  // 设置当前节点 top 的父节点为 p
@@ -456,10 +774,163 @@ RbTree<Key, Value, KeyOfValue, Compare>::_copy(NodePtr x, NodePtr p) {
     return top;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-RbTree<Key, Value, KeyOfValue, Compare>
-&RbTree<Key, Value, KeyOfValue, Compare>::operator=(
-        const RbTree<Key, Value, KeyOfValue, Compare> &x) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class RandomIt>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_buildSorted(RandomIt first, size_t lo, size_t hi,
+                                                             NodePtr p, int depth, int redDepth) {
+    if (lo >= hi) {
+        return 0;  // 空区间
+    }
+    size_t mid = lo + (hi - lo) / 2;  // 取中点作为子树根, 左右子树大小至多相差 1
+    NodePtr x = _createNode(first[mid]);
+    // 左右子树大小至多相差 1, 所有空链接都落在最后两层,
+    // 因此只需把最深一层 (不满的那一层) 染红, 即可使每条路径的黑色节点数相同
+    color(x) = depth == redDepth ? Red : Black;
+    x->size = hi - lo;  // 子树大小即区间长度
+    parent(x) = p;
+    left(x) = _buildSorted(first, lo, mid, x, depth + 1, redDepth);
+    right(x) = _buildSorted(first, mid + 1, hi, x, depth + 1, redDepth);
+    Augment::update(x);
+    return x;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class RandomIt>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_isSorted(RandomIt first, RandomIt last,
+                                                               bool unique) const {
+    if (first == last) {
+        return true;
+    }
+    for (RandomIt prev = first++; first != last; prev = first++) {
+        const Key &a = KeyOfValue()(*prev);
+        const Key &b = KeyOfValue()(*first);
+        // unique: 要求 a < b; 否则要求 !(b < a)
+        if (unique ? !keyCompare(a, b) : keyCompare(b, a)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class RandomIt>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_build(RandomIt first, RandomIt last,
+                                                            bool unique) {
+    if (!empty() || !_isSorted(first, last, unique)) {
+        // 退化路径: 逐个插入, 对有序输入以 end() 为提示可省去查找
+        for (; first != last; ++first) {
+            if (unique) {
+                insertUnique(end(), *first);
+            } else {
+                insertEqual(end(), *first);
+            }
+        }
+        return false;
+    }
+
+    size_t n = last - first;
+    if (n == 0) {
+        return true;
+    }
+    _resetRoot(_buildSorted(first, 0, n, header, 0, _redDepth(n)), n);
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+int RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_redDepth(size_t n) {
+    // 树高 h = floor(log2 n); 若最深一层不满, 该层节点染红
+    // 若树是满二叉树, 最深一层染红同样合法; 但只有一个节点时根必须为黑色
+    int h = 0;
+    while ((size_t(2) << h) <= n) {
+        ++h;
+    }
+    return h > 0 ? h : -1;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_resetRoot(NodePtr x, size_t n) {
+    root() = x;
+    if (x != 0) {
+        parent(x) = header;
+        color(x) = Black;
+        leftmost() = minimum(x);
+        rightmost() = maximum(x);
+    } else {
+        leftmost() = header;
+        rightmost() = header;
+    }
+    nodeCount = n;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class Visit>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_preorder(NodePtr x, Visit &visit) const {
+    while (x != 0) {
+        visit(value(x), x->color, left(x) != 0, right(x) != 0);
+        _preorder(left(x), visit);  // 先递归左子树
+        x = right(x);  // 右子树用循环代替尾递归
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class Next>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_buildPreorder(Next &next, NodePtr p,
+                                                               size_t &remaining, bool &ok) {
+    Value v;
+    Color c;
+    bool hasLeft, hasRight;
+    if (remaining == 0 || !next(v, c, hasLeft, hasRight)) {
+        ok = false;  // 序列提前结束或读取失败
+        return 0;
+    }
+    --remaining;
+    NodePtr x = _createNode(std::move(v));  // v 之后不再使用, 直接移入节点
+    color(x) = c;
+    parent(x) = p;
+    // 子树读取失败时仍返回已建的部分并挂到 x 上, 以便调用者整体释放
+    if (hasLeft && ok) {
+        left(x) = _buildPreorder(next, x, remaining, ok);
+    }
+    if (hasRight && ok) {
+        right(x) = _buildPreorder(next, x, remaining, ok);
+    }
+    Node::updateSize(x);
+    Augment::update(x);
+    return x;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class Next>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::buildPreorder(size_t n, Next next) {
+    if (!empty()) {
+        return false;
+    }
+    if (n == 0) {
+        return true;
+    }
+    size_t remaining = n;
+    bool ok = true;
+    NodePtr top = _buildPreorder(next, header, remaining, ok);
+    if (!ok || remaining != 0) {  // 序列不合法, 释放已建的部分
+        if (top != 0) {
+            _erase(top);
+        }
+        root() = 0;
+        return false;
+    }
+    root() = top;
+    leftmost() = minimum(root());
+    rightmost() = maximum(root());
+    nodeCount = n;
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>
+&RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::operator=(
+        const RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment> &x) {
     if (this != &x) {  // 检查自赋值，避免对自身赋值
         clear();  // 先移除当前红黑树的所有节点，恢复到初始状态
         keyCompare = x.keyCompare;  // 复制比较器对象，用于比较节点的键值
@@ -474,10 +945,18 @@ RbTree<Key, Value, KeyOfValue, Compare>
     return *this;  // 返回当前对象的引用，支持链式赋值
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::clear() {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::clear() {
     if (nodeCount != 0) {      // 如果树中有节点，即非空树
-        _erase(root());        // 调用 _erase 函数递归地移除整棵树
+        if (Alloc::canRelease) {  // 分配器支持一次性释放
+            // 值类型无需析构时不必遍历整棵树
+            if (!is_trivially_destructible<Value>::value) {
+                _destroyValues(root());
+            }
+            nodeAllocator.release();  // 一次性归还所有节点内存
+        } else {
+            _erase(root());        // 调用 _erase 函数递归地移除整棵树
+        }
         root() = 0;            // 清空根节点，表示树为空
         leftmost() = header;   // 将最左节点重置为 header，表示没有节点
         rightmost() = header;  // 将最右节点重置为 header，表示没有节点
@@ -485,17 +964,16 @@ void RbTree<Key, Value, KeyOfValue, Compare>::clear() {
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-std::pair<typename RbTree<Key, Value, KeyOfValue, Compare>::iterator, bool>
-RbTree<Key, Value, KeyOfValue, Compare>::insertUnique(const Value &v) {
-    NodePtr y = header;  // y 指向插入点的父节点，初始化为 header
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_uniquePos(const Key &k, NodePtr &y) {
+    y = header;          // y 指向插入点的父节点，初始化为 header
     NodePtr x = root();  // 从根节点开始查找合适的插入位置
     bool comp = true;     // comp 用于比较值的大小关系，初始化为 true
 
     // 往下寻找合适的插入点
     while (x != 0) {
         y = x;  // 记录父节点
-        comp = keyCompare(KeyOfValue()(v), key(x));  // 比较插入值与当前节点的键值
+        comp = keyCompare(k, key(x));  // 比较插入值与当前节点的键值
         // 如果插入值小于当前节点的键值，则往左走；否则往右走
         x = comp ? left(x) : right(x);
     }
@@ -504,7 +982,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::insertUnique(const Value &v) {
     if (comp) {  // 如果 comp 为 true，表示插入值应该在左子树
         if (j == begin()) {  // 如果插入点是最左边
             // 如果插入点的父节点是最左节点，说明键值不重复，可以插入
-            return pair<iterator, bool>(_insert(x, y, v), true);
+            return true;
         } else {
             // 如果插入点的父节点不是最左节点，可能存在重复键值，向前检查
             --j;  // 向前移动迭代器 j，检查是否存在相同的键值
@@ -513,55 +991,96 @@ RbTree<Key, Value, KeyOfValue, Compare>::insertUnique(const Value &v) {
 
     // 对于两种情况的判断
     // 1. comp = false, 表示插入值应该在右子树
-    // 2. comp = true, 此时 j 为祖父节点，可能存在重复键值
-    if (keyCompare(key(j.node), KeyOfValue()(v))) {
-        // 如果 j < v，说明插入的值比 j 小，可以插入
-        return pair<iterator, bool>(_insert(x, y, v), true);  // 插入成功
+    // 2. comp = true, 此时 j 为前驱节点，可能存在重复键值
+    if (keyCompare(key(j.node), k)) {
+        // 如果 j < k，说明键值不重复，可以插入
+        return true;
     }
 
     // 到这里说明插入的值与树中的值重复
-    return pair<iterator, bool>(j, false);  // 返回现有节点，并且插入失败
+    y = j.node;
+    return false;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::insertEqual(const Value &v) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_equalPos(const Key &k) {
     NodePtr y = header;  // y 指向 x 的父节点，初始化为 header
     NodePtr x = root();  // 从根节点开始查找合适的插入位置
 
     // 查找插入点
     while (x != 0) {  // 循环直到找到一个空的位置 (插入点)
         y = x;  // 更新父节点 y 为当前节点 x
-        // 如果 v < x，则往左走，否则往右走
-        x = keyCompare(KeyOfValue()(v), key(x)) ? left(x) : right(x);
+        // 如果 k < x，则往左走，否则往右走
+        x = keyCompare(k, key(x)) ? left(x) : right(x);
     }
+    return y;
+}
 
-    // 到这里，x 已经是空的位置，y 是 x 的父节点，v 是待插入的值
-    // _insert 用来插入新节点，x 是插入点，y 是插入点的父节点
-    return _insert(x, y, v);  // 调用 _insert 函数插入新值并返回迭代器
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class V>
+std::pair<typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator, bool>
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insertUnique(V &&v) {
+    NodePtr y;
+    if (!_uniquePos(KeyOfValue()(v), y)) {
+        return pair<iterator, bool>(iterator(y), false);  // 返回现有节点，并且插入失败
+    }
+    // 确认可以插入后才构造节点, 键值重复时不分配内存
+    return pair<iterator, bool>(_insert(0, y, _createNode(std::forward<V>(v))), true);  // 插入成功
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class V>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insertEqual(V &&v) {
+    // 先用 v 的键值找到插入点, 再把 v 移入新节点 (两者不能写在同一个表达式中, 求值顺序不确定)
+    NodePtr y = _equalPos(KeyOfValue()(v));
+    // _insert 用来插入新节点，0 是插入点，y 是插入点的父节点
+    return _insert(0, y, _createNode(std::forward<V>(v)));
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::insertUnique(iterator position,
-                                                      const Value &v) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class... Args>
+std::pair<typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator, bool>
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::emplaceUnique(Args &&...args) {
+    NodePtr z = _createNode(std::forward<Args>(args)...);  // 先构造节点才能取得键值
+    NodePtr y;
+    if (!_uniquePos(key(z), y)) {
+        _destroyNode(z);  // 键值重复, 丢弃新节点
+        return pair<iterator, bool>(iterator(y), false);
+    }
+    return pair<iterator, bool>(_insert(0, y, z), true);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class... Args>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::emplaceEqual(Args &&...args) {
+    NodePtr z = _createNode(std::forward<Args>(args)...);
+    return _insert(0, _equalPos(key(z)), z);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class V>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insertUnique(iterator position, V &&v) {
     // 检查插入位置是否为 begin()
     if (position.node == header->left) {
         if (size() > 0 &&                      // 树非空
             keyCompare(KeyOfValue()(v),        // 且 v 小于树中的第一个元素
                        key(position.node))) {  // 确保键值不重复且插入位置正确
-            return _insert(position.node, position.node, v);  // 插入新节点
+            return _insert(position.node, position.node, _createNode(std::forward<V>(v)));  // 插入新节点
         } else {  // 如果重复或者位置不正确
-            return insertUnique(v).first;  // 递归调用 insertUnique 插入新值
+            return _insertUnique(std::forward<V>(v)).first;  // 调用不带位置的版本插入新值
         }
     }
         // 检查插入位置是否为 end()
     else if (position.node == header) {   // 插入位置在 end()
         if (keyCompare(key(rightmost()),    // end() 位置小于 v
                        KeyOfValue()(v))) {  // 确保键值不重复且插入位置正确
-            return _insert(0, rightmost(), v);  // 在树的末尾插入新节点
+            return _insert(0, rightmost(), _createNode(std::forward<V>(v)));  // 在树的末尾插入新节点
         } else {  // 如果重复或者位置不正确
-            return insertUnique(v).first;  // 递归调用 insertUnique 插入新值
+            return _insertUnique(std::forward<V>(v)).first;  // 调用不带位置的版本插入新值
         }
     } else {  // 插入位置为其他中间位置
         iterator before = position;
@@ -571,29 +1090,29 @@ RbTree<Key, Value, KeyOfValue, Compare>::insertUnique(iterator position,
             keyCompare(KeyOfValue()(v),        // before < v < position
                        key(position.node))) {  // 确保键值不重复且插入位置正确
             if (right(before.node) == 0) {  // 如果 before 节点没有右子节点
-                return _insert(0, before.node, v);  // 插入到 before 的右子节点
+                return _insert(0, before.node, _createNode(std::forward<V>(v)));  // 插入到 before 的右子节点
             } else {  // 如果 before 节点有右子节点
-                return _insert(position.node, position.node, v);  // 插入到 position 位置
+                return _insert(position.node, position.node, _createNode(std::forward<V>(v)));  // 插入到 position 位置
             }
         } else {  // 如果重复或者位置不正确
-            return insertUnique(v).first;  // 递归调用 insertUnique 插入新值
+            return _insertUnique(std::forward<V>(v)).first;  // 调用不带位置的版本插入新值
         }
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::insertEqual(iterator position,
-                                                     const Value &v) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class V>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_insertEqual(iterator position, V &&v) {
     // 如果插入位置是树的最左边 (begin())
     if (position.node == header->left) {
         // 检查树是否为空且 v >= begin()，如果是，插入新节点
         if (size() > 0                          // 非空树
             && !keyCompare(key(position.node),  // begin() >= v
                            KeyOfValue()(v))) {  // 位置正确
-            return _insert(position.node, position.node, v);  // 插入新节点
-        } else {  // 如果位置不正确（可能 v 小于树中所有元素），递归调用 insertEqual 插入
-            return insertEqual(v);
+            return _insert(position.node, position.node, _createNode(std::forward<V>(v)));  // 插入新节点
+        } else {  // 如果位置不正确（可能 v 小于树中所有元素），调用不带位置的版本插入
+            return _insertEqual(std::forward<V>(v));
         }
     }
         // 如果插入位置是树的最右边 (end())
@@ -601,9 +1120,9 @@ RbTree<Key, Value, KeyOfValue, Compare>::insertEqual(iterator position,
         // 检查 v >= end()，如果是，插入新节点
         if (!keyCompare(KeyOfValue()(v),      // v >= end()
                         key(rightmost()))) {  // 位置正确
-            return _insert(0, rightmost(), v);  // 插入新节点
-        } else {  // 如果位置不正确（可能 v 大于树中所有元素），递归调用 insertEqual 插入
-            return insertEqual(v);
+            return _insert(0, rightmost(), _createNode(std::forward<V>(v)));  // 插入新节点
+        } else {  // 如果位置不正确（可能 v 大于树中所有元素），调用不带位置的版本插入
+            return _insertEqual(std::forward<V>(v));
         }
     }
         // 如果插入位置在树中的中间
@@ -616,32 +1135,428 @@ RbTree<Key, Value, KeyOfValue, Compare>::insertEqual(iterator position,
                         KeyOfValue()(v))) {  // 位置正确
             // 如果 before 没有右子节点，插入到 before 的右子节点
             if (right(before.node) == 0) {
-                return _insert(0, before.node, v);  // 插入新节点
+                return _insert(0, before.node, _createNode(std::forward<V>(v)));  // 插入新节点
             } else {  // 否则，插入到 position 位置
-                return _insert(position.node, position.node, v);  // 插入新节点
+                return _insert(position.node, position.node, _createNode(std::forward<V>(v)));  // 插入新节点
             }
-        } else {  // 如果位置不正确（即 v 不在 before 和 position 之间），递归调用 insertEqual 插入
-            return insertEqual(v);
+        } else {  // 如果位置不正确（即 v 不在 before 和 position 之间），调用不带位置的版本插入
+            return _insertEqual(std::forward<V>(v));
         }
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::erase(iterator position) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::erase(iterator position) {
     // 通过调用 RebalanceForErase 函数移除指定位置的节点并重新平衡树
     NodePtr y = RebalanceForErase(position.node, header->parent, header->left,
                                   header->right);
-    delete y;  // 删除节点 y
+    _destroyNode(y);  // 删除节点 y
     --nodeCount;  // 树的节点数量减一
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::find(const Key &k) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+size_t RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_rankOf(NodePtr x) const {
+    size_t r = Node::subtreeSize(left(x));  // x 的左子树都排在 x 之前
+    for (; x != root(); x = parent(x)) {
+        if (x == right(parent(x))) {  // x 是右子节点时, 父节点及其左子树也排在 x 之前
+            r += Node::subtreeSize(left(parent(x))) + 1;
+        }
+    }
+    return r;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+int RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_blackHeight(NodePtr x) {
+    int h = 0;
+    for (; x != 0; x = left(x)) {
+        h += color(x) == Black;
+    }
+    return h;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_join(NodePtr l, NodePtr k, NodePtr r) {
+    int hl = _blackHeight(l), hr = _blackHeight(r);
+    if (hl == hr) {  // 黑高相同: k 直接作为根, 染黑后黑高加一
+        left(k) = l;
+        right(k) = r;
+        if (l != 0) {
+            parent(l) = k;
+        }
+        if (r != 0) {
+            parent(r) = k;
+        }
+        parent(k) = 0;
+        color(k) = Black;
+        Node::updateSize(k);
+        Augment::update(k);
+        return k;
+    }
+
+    // 较高的子树为 top: l 较高时沿 l 的最右路径下降, 否则沿 r 的最左路径下降
+    bool alongRight = hl > hr;
+    NodePtr top = alongRight ? l : r;
+    NodePtr low = alongRight ? r : l;
+    int h = alongRight ? hl : hr;  // 当前节点 c 的黑高
+    int target = alongRight ? hr : hl;
+    NodePtr c = top, p = 0;
+    parent(top) = 0;
+    while (c != 0 && !(color(c) == Black && h == target)) {  // 空节点的黑高为 0, 必然停下
+        h -= color(c) == Black;
+        p = c;
+        c = alongRight ? right(c) : left(c);
+    }
+
+    // k 接替 c 的位置, c 与较矮的子树成为 k 的两个子节点 (此时两边黑高相同)
+    if (alongRight) {
+        left(k) = c;
+        right(k) = low;
+        right(p) = k;
+    } else {
+        left(k) = low;
+        right(k) = c;
+        left(p) = k;
+    }
+    if (c != 0) {
+        parent(c) = k;
+    }
+    if (low != 0) {
+        parent(low) = k;
+    }
+    parent(k) = p;
+    Node::updateSize(k);
+    Augment::update(k);
+    // 下降路径上的节点多了较矮的子树和 k
+    size_t added = Node::subtreeSize(low) + 1;
+    for (NodePtr q = p; q != 0; q = parent(q)) {
+        q->size += added;
+        Augment::update(q);
+    }
+    // k 染红后黑高不变, 只可能与父节点形成连续的红色节点, 按插入的方式向上修复
+    Rebalance(k, top);
+    parent(top) = 0;
+    return top;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_join2(NodePtr l, NodePtr r) {
+    if (l == 0) {
+        return r;
+    }
+    if (r == 0) {
+        return l;
+    }
+    NodePtr rest, last;
+    _splitAt(l, l->size - 1, rest, last);  // last 是只含 l 的最大节点的单节点树
+    return _join(rest, last, r);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_splitAt(NodePtr t, size_t n, NodePtr &l, NodePtr &r) {
+    if (t == 0) {
+        l = r = 0;
+        return;
+    }
+    // 取下 t 的左右子树, 各自作为独立的红黑树
+    NodePtr a = left(t), b = right(t);
+    _detach(a);
+    _detach(b);
+    size_t leftSize = Node::subtreeSize(a);
+    if (n <= leftSize) {  // 拆分点在左子树中, t 与右子树都归入 r
+        NodePtr mid;
+        _splitAt(a, n, l, mid);
+        r = _join(mid, t, b);
+    } else {  // 拆分点在右子树中, 左子树与 t 都归入 l
+        NodePtr mid;
+        _splitAt(b, n - leftSize - 1, mid, r);
+        l = _join(a, t, mid);
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+size_t RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_eraseRange(iterator first, iterator last) {
+    if (first == last) {
+        return 0;
+    }
+    if (first == begin() && last == end()) {  // 整棵树
+        size_t n = nodeCount;
+        clear();
+        return n;
+    }
+    size_t lo = _rankOf(first.node);
+    size_t hi = last == end() ? nodeCount : _rankOf(last.node);
+    size_t k = hi - lo;
+    if (k < SplitEraseMin) {  // 区间较短, 逐个删除更快
+        while (first != last) {
+            erase(first++);
+        }
+        return k;
+    }
+    // 按名次拆成 [0, lo)、[lo, hi)、[hi, n) 三段, 析构中间一段, 再连接两端
+    NodePtr t = root();
+    parent(t) = 0;
+    NodePtr l, rest, mid, r;
+    _splitAt(t, lo, l, rest);
+    _splitAt(rest, k, mid, r);
+    _erase(mid);
+    _resetRoot(_join2(l, r), nodeCount - k);
+    return k;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class Pred>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_sieve(NodePtr x, Pred &pred, NodePtr *&tail,
+                                                           size_t &kept) {
+    while (x != 0) {
+        NodePtr l = left(x), r = right(x);  // 处理 x 之前先取出子节点, 之后 x 可能被析构或改写
+        _sieve(l, pred, tail, kept);  // 递归处理左子树
+        if (pred(value(x))) {
+            _destroyNode(x);
+        } else {  // 保留的节点追加到链表末尾
+            *tail = x;
+            tail = &right(x);
+            ++kept;
+        }
+        x = r;  // 右子树用循环处理
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_buildFromList(NodePtr &list, size_t n, NodePtr p,
+                                                               int depth, int redDepth) {
+    if (n == 0) {
+        return 0;
+    }
+    size_t leftCount = n / 2;  // 与 _buildSorted 取中点的方式相同
+    NodePtr l = _buildFromList(list, leftCount, 0, depth + 1, redDepth);
+    NodePtr x = list;  // 左子树取完后链表的第一个节点即子树根
+    list = right(list);
+    left(x) = l;
+    if (l != 0) {
+        parent(l) = x;
+    }
+    right(x) = _buildFromList(list, n - leftCount - 1, x, depth + 1, redDepth);
+    parent(x) = p;
+    color(x) = depth == redDepth ? Red : Black;
+    x->size = n;
+    Augment::update(x);
+    return x;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class Pred>
+size_t RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::eraseIf(Pred pred) {
+    if (empty()) {
+        return 0;
+    }
+    NodePtr list = 0;
+    NodePtr *tail = &list;
+    size_t kept = 0;
+    _sieve(root(), pred, tail, kept);
+    *tail = 0;
+    size_t removed = nodeCount - kept;
+    _resetRoot(_buildFromList(list, kept, header, 0, _redDepth(kept)), kept);
+    return removed;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_splitKey(NodePtr t, const Key &k, NodePtr &l, NodePtr &r,
+                                                              NodePtr &dup) {
+    if (t == 0) {
+        l = r = dup = 0;
+        return;
+    }
+    NodePtr a = left(t), b = right(t);
+    _detach(a);
+    _detach(b);
+    if (keyCompare(k, key(t))) {  // k 在 t 之前: t 与右子树都归入 r
+        NodePtr mid;
+        _splitKey(a, k, l, mid, dup);
+        r = _join(mid, t, b);
+    } else if (keyCompare(key(t), k)) {  // k 在 t 之后: 左子树与 t 都归入 l
+        NodePtr mid;
+        _splitKey(b, k, mid, r, dup);
+        l = _join(a, t, mid);
+    } else {  // t 的键值等于 k, 左右子树即为结果
+        l = a;
+        r = b;
+        left(t) = right(t) = parent(t) = 0;
+        dup = t;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_linkUnique(NodePtr &t, NodePtr z) {
+    NodePtr y = 0, x = t;
+    bool comp = true;
+    while (x != 0) {
+        comp = keyCompare(key(z), key(x));
+        if (!comp && !keyCompare(key(x), key(z))) {  // 键值重复
+            return false;
+        }
+        y = x;
+        x = comp ? left(x) : right(x);
+    }
+    left(z) = right(z) = 0;
+    parent(z) = y;
+    z->size = 1;
+    Augment::update(z);
+    if (y == 0) {  // 空树
+        color(z) = Black;
+        t = z;
+        return true;
+    }
+    (comp ? left(y) : right(y)) = z;
+    for (NodePtr q = y; q != 0; q = parent(q)) {  // 路径上的子树都多了 z
+        ++q->size;
+        Augment::update(q);
+    }
+    Rebalance(z, t);
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_union(NodePtr a, NodePtr b, int spawnDepth,
+                                                       vector<NodePtr> &dups) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    if (b->size <= UnionLinkMax) {  // b 很小: 先取出它的全部节点, 再逐个链接进 a
+        NodePtr nodes[UnionLinkMax];
+        size_t count = 0;
+        NodePtr stack[UnionLinkMax];
+        size_t depth = 0;
+        for (NodePtr x = b; x != 0 || depth != 0;) {  // 中序遍历
+            if (x != 0) {
+                stack[depth++] = x;
+                x = left(x);
+            } else {
+                x = stack[--depth];
+                nodes[count++] = x;
+                x = right(x);
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!_linkUnique(a, nodes[i])) {
+                left(nodes[i]) = right(nodes[i]) = parent(nodes[i]) = 0;
+                dups.push_back(nodes[i]);
+            }
+        }
+        return a;
+    }
+    size_t work = a->size + b->size;
+    // 以 a 的根节点为界: 取下 a 的左右子树, 并按它的键值拆分 b
+    NodePtr l1 = left(a), r1 = right(a);
+    _detach(l1);
+    _detach(r1);
+    NodePtr l2, r2, dup;
+    _splitKey(b, key(a), l2, r2, dup);
+    if (dup != 0) {
+        dups.push_back(dup);
+    }
+    // 两侧的子问题没有共同的节点, 可以同时进行
+    NodePtr l, r;
+    if (spawnDepth > 0 && work >= ParallelUnionMin) {
+        vector<NodePtr> leftDups;  // 左侧在新线程中进行, 重复节点先记在自己的列表中
+        thread worker([&] { l = _union(l1, l2, spawnDepth - 1, leftDups); });
+        r = _union(r1, r2, spawnDepth - 1, dups);
+        worker.join();
+        dups.insert(dups.end(), leftDups.begin(), leftDups.end());
+    } else {
+        l = _union(l1, l2, 0, dups);
+        r = _union(r1, r2, 0, dups);
+    }
+    return _join(l, a, r);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::split(const Key &k, RbTree &right) {
+    if (&right == this || !right.empty()) {
+        return false;
+    }
+    size_t n = rank(k);  // 留在本树的节点个数
+    if (n == nodeCount) {  // 没有节点需要移动
+        return true;
+    }
+    right.nodeAllocator.share(nodeAllocator);  // right 之后要归还本树分配的节点
+    size_t total = nodeCount;
+    NodePtr t = root();
+    parent(t) = 0;
+    NodePtr l, r;
+    _splitAt(t, n, l, r);
+    _resetRoot(l, n);
+    right._resetRoot(r, total - n);
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::join(RbTree &right) {
+    if (&right == this) {
+        return false;
+    }
+    if (right.empty()) {
+        return true;
+    }
+    if (!empty() && keyCompare(key(right.leftmost()), key(rightmost()))) {  // 键值区间重叠
+        return false;
+    }
+    nodeAllocator.share(right.nodeAllocator);  // 本树之后要归还 right 分配的节点
+    size_t total = nodeCount + right.nodeCount;
+    NodePtr l = root(), r = right.root();
+    _detach(l);
+    _detach(r);
+    right._resetRoot(0, 0);
+    _resetRoot(_join2(l, r), total);
+    return true;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+size_t RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::unionWith(RbTree &other, unsigned threads) {
+    if (&other == this || other.empty()) {
+        return 0;
+    }
+    nodeAllocator.share(other.nodeAllocator);  // other 的节点移入本树后由本树归还
+    if (threads == 0) {
+        threads = thread::hardware_concurrency();
+    }
+    int spawnDepth = 0;  // 每层把一个子问题分给新线程, spawnDepth 层后共有 2^spawnDepth 个线程
+    for (unsigned t = 1; t < threads; t *= 2) {
+        ++spawnDepth;
+    }
+#ifdef RBTREE_STATS
+    spawnDepth = 0;  // 计数器不是原子的, 统计时只用当前线程
+#endif
+    size_t before = nodeCount;
+    NodePtr a = root(), b = other.root();
+    _detach(a);
+    _detach(b);
+    other._resetRoot(0, 0);
+    vector<NodePtr> dups;
+    NodePtr t = _union(a, b, spawnDepth, dups);
+    for (NodePtr x : dups) {  // 所有线程结束后再析构重复的节点, 分配器不必考虑并发
+        _destroyNode(x);
+    }
+    _resetRoot(t, Node::subtreeSize(t));
+    return nodeCount - before;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class K>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_find(const K &k) {
     NodePtr y = header;  // y 最终指向最接近的 >= k 的节点
     NodePtr x = root();  // 从根节点开始查找
+    RBTREE_COUNT(finds, 1);
 
     while (x != 0) {  // 遍历树直到找到匹配节点或者到达空节点
+        RBTREE_COUNT(findCompares, 1);
         if (!keyCompare(key(x), k)) {  // 如果 k <= x
             y = x;  // 更新 y 为当前节点
             x = left(x);  // 在左子树中继续查找
@@ -651,13 +1566,51 @@ RbTree<Key, Value, KeyOfValue, Compare>::find(const Key &k) {
     }
 
     iterator j = iterator(y);  // 创建指向 y 的迭代器
+    RBTREE_COUNT(findCompares, j != end());  // 下面确认相等的一次比较
     // 如果没有找到匹配的节点，则返回 end()
     return (j == end() || keyCompare(k, key(j.node))) ? end() : j;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::lowerBound(const Key &k) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::select(size_t k) {
+    if (k >= nodeCount) {
+        return end();  // 名次越界
+    }
+    NodePtr x = root();
+    while (true) {
+        size_t leftSize = Node::subtreeSize(left(x));  // 左子树中的节点都排在 x 之前
+        if (k < leftSize) {  // 目标在左子树
+            x = left(x);
+        } else if (k == leftSize) {  // x 恰好是第 k 个
+            return iterator(x);
+        } else {  // 目标在右子树, 跳过左子树与 x 本身
+            k -= leftSize + 1;
+            x = right(x);
+        }
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+size_t RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::rank(const Key &k) {
+    size_t r = 0;        // 已确定小于 k 的节点个数
+    NodePtr x = root();  // 当前节点
+
+    while (x != 0) {
+        if (keyCompare(key(x), k)) {  // x < k, x 及其左子树都小于 k
+            r += Node::subtreeSize(left(x)) + 1;
+            x = right(x);
+        } else {  // k <= x, 继续在左子树查找
+            x = left(x);
+        }
+    }
+    return r;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class K>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_lowerBound(const K &k) {
     NodePtr y = header;  // 最终指向首个 >= k 的节点
     NodePtr x = root();  // 当前节点
 
@@ -672,9 +1625,10 @@ RbTree<Key, Value, KeyOfValue, Compare>::lowerBound(const Key &k) {
     return iterator(y);  // 返回首个 >= k 的节点的迭代器
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::iterator
-RbTree<Key, Value, KeyOfValue, Compare>::upperBound(const Key &k) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+template <class K>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::iterator
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_upperBound(const K &k) {
     NodePtr y = header;  // 最终指向首个 > k 的节点
     NodePtr x = root();  // 当前节点
 
@@ -689,16 +1643,8 @@ RbTree<Key, Value, KeyOfValue, Compare>::upperBound(const Key &k) {
     return iterator(y);  // 返回首个 > k 的节点的迭代器
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-pair<typename RbTree<Key, Value, KeyOfValue, Compare>::iterator,
-        typename RbTree<Key, Value, KeyOfValue, Compare>::iterator>
-RbTree<Key, Value, KeyOfValue, Compare>::equalRange(const Key &k) {
-    // 返回一个包含 [lowerBound(k), upperBound(k)) 范围的迭代器对
-    return pair<iterator, iterator>(lowerBound(k), upperBound(k));
-}
-
-template <class Key, class Value, class KeyOfValue, class Compare>
-bool RbTree<Key, Value, KeyOfValue, Compare>::_rb_verify() const {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+bool RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_rb_verify() const {
     // 判断红黑树是否合法
 
     // 判断空树的合法性
@@ -721,6 +1667,11 @@ bool RbTree<Key, Value, KeyOfValue, Compare>::_rb_verify() const {
             }
         }
 
+        // 判断子树大小是否正确
+        if (x->size != Node::subtreeSize(L) + Node::subtreeSize(R) + 1) {
+            return false;
+        }
+
         // 判断左子节点和右子节点的位置是否正确
         if (L && keyCompare(key(x), key(L))) {
             return false;  // 左子节点的键值比父节点大
@@ -746,8 +1697,8 @@ bool RbTree<Key, Value, KeyOfValue, Compare>::_rb_verify() const {
     return true;  // 如果通过了所有检查，返回 true
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-int RbTree<Key, Value, KeyOfValue, Compare>::_blackCount(NodePtr node, NodePtr root) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+int RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_blackCount(NodePtr node, NodePtr root) {
     if (node == nullptr) {
         return 0;  // 如果节点为空，黑色节点数为0
     } else {
@@ -760,8 +1711,9 @@ int RbTree<Key, Value, KeyOfValue, Compare>::_blackCount(NodePtr node, NodePtr r
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::RotateLeft(NodePtr x, NodePtr &root) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::RotateLeft(NodePtr x, NodePtr &root) {
+    RBTREE_COUNT(rotateLeft, 1);
     NodePtr y = x->right;      // 令 y 为旋转点的右子节点
     x->right = y->left;        // x 的右子节点更改为 y 的左子节点
     if (y->left != nullptr) {  // 如果 y 的左子节点存在
@@ -779,10 +1731,16 @@ void RbTree<Key, Value, KeyOfValue, Compare>::RotateLeft(NodePtr x, NodePtr &roo
     }
     y->left = x;  // 将 x 设置为 y 的左子节点
     x->parent = y;  // 更新 x 的父节点为 y
+    // 旋转后 y 接管了 x 原来的整棵子树, x 的子树大小需要重新计算
+    y->size = x->size;
+    Node::updateSize(x);
+    Augment::update(x);  // x 现在是 y 的子节点, 先算 x 再算 y
+    Augment::update(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::RotateRight(NodePtr x, NodePtr &root) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::RotateRight(NodePtr x, NodePtr &root) {
+    RBTREE_COUNT(rotateRight, 1);
     NodePtr y = x->left;        // 令 y 为旋转点的左子节点
     x->left = y->right;         // x 的左子节点更改为 y 的右子节点
     if (y->right != nullptr) {  // 如果 y 的右子节点存在
@@ -800,10 +1758,15 @@ void RbTree<Key, Value, KeyOfValue, Compare>::RotateRight(NodePtr x, NodePtr &ro
     }
     y->right = x;   // 将 x 设置为 y 的右子节点
     x->parent = y;  // 更新 x 的父节点为 y
+    // 旋转后 y 接管了 x 原来的整棵子树, x 的子树大小需要重新计算
+    y->size = x->size;
+    Node::updateSize(x);
+    Augment::update(x);  // x 现在是 y 的子节点, 先算 x 再算 y
+    Augment::update(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::Rebalance(NodePtr x, NodePtr &root) {
     x->color = Red;  // 设置新节点颜色为红色, 因为如果插入的节点是黑色, 必然会导致树不平衡
     while (x != root && x->parent->color == Red) {  // 当 x 非根节点且 x 的父节点为红色时需要进行平衡操作
         // 一: 父节点是祖父节点的左子节点
@@ -813,6 +1776,7 @@ void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root
                 x->parent->color = Black;  // 更改父节点为黑色
                 y->color = Black;  // 更改伯父节点为黑色
                 x->parent->parent->color = Red;  // 更改祖父节点为红色
+                RBTREE_COUNT(insertRecolors, 3);
                 x = x->parent->parent;  // 祖父颜色由黑变红可能会破坏上层平衡，将当前节点更改为祖父节点继续往上检查
             } else {
                 if (x == x->parent->right) {  // 2: 伯父节点不存在或为黑色
@@ -821,6 +1785,7 @@ void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root
                 }
                 x->parent->color = Black;  // 更改父节点为黑色
                 x->parent->parent->color = Red;  // 更改祖父节点为红色
+                RBTREE_COUNT(insertRecolors, 2);
                 RotateRight(x->parent->parent, root);  // 右旋
             }
         } else {  // 二: 父节点是祖父节点的右子节点
@@ -829,6 +1794,7 @@ void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root
                 x->parent->color = Black;  // 更改父节点为黑色
                 y->color = Black;  // 更改伯父节点为黑色
                 x->parent->parent->color = Red;  // 更改祖父节点为红色
+                RBTREE_COUNT(insertRecolors, 3);
                 x = x->parent->parent;  // 祖父颜色由黑变红可能会破坏上层平衡，将当前节点更改为祖父节点继续往上检查
             } else {
                 if (x == x->parent->left) {  // 2: 伯父节点不存在或为黑色
@@ -837,6 +1803,7 @@ void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root
                 }
                 x->parent->color = Black;  // 更改父节点为黑色
                 x->parent->parent->color = Red;  // 更改祖父节点为红色
+                RBTREE_COUNT(insertRecolors, 2);
                 RotateLeft(x->parent->parent, root);  // 左旋
             }
         }
@@ -844,9 +1811,9 @@ void RbTree<Key, Value, KeyOfValue, Compare>::Rebalance(NodePtr x, NodePtr &root
     root->color = Black;  // 根节点永远为黑色
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename RbTree<Key, Value, KeyOfValue, Compare>::NodePtr
-RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+typename RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::NodePtr
+RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::RebalanceForErase(NodePtr z,
                                                            NodePtr &root,
                                                            NodePtr &leftmost,
                                                            NodePtr &rightmost) {
@@ -868,6 +1835,12 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
         x = y->right;  // 令 x 为后继节点的右子节点 (可能为空)
     }
 
+    // 真正从树中摘下的位置是 y, 在调整指针前先让 y 的所有祖先的子树大小减一
+    for (NodePtr p = y; p != root;) {
+        p = p->parent;
+        --p->size;
+    }
+
     if (y != z) {  // 如果 z 有两个子节点 (后继节点被用来取代 z)
         // 用后继节点 y 取代 z 的位置
         z->left->parent = y;  // 调整 z 的左子节点的父节点指向 y
@@ -893,6 +1866,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
             z->parent->right = y;  // 如果 z 是父节点的右子节点，将 y 设置为父节点的右子节点
         }
         y->parent = z->parent;  // 将 y 的父节点指向 z 的父节点
+        y->size = z->size;  // y 占据 z 的位置, 子树大小也随之继承
         std::swap(y->color, z->color);  // 交换 z 和 y 的颜色
         y = z;  // 重新指向需要删除的节点
     } else {  // 如果 z 只有一个子节点 (x)，用 x 取代 z
@@ -929,6 +1903,9 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
         }
     }
 
+    // 摘下节点后, 自最低的变动位置向上重新计算聚合值, 之后的旋转会在局部维护
+    _augmentPath(xParent);
+
     // 重新平衡红黑树
     // 删除红色节点不会破坏平衡
     if (y->color != Red) {
@@ -939,6 +1916,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                 if (w->color == Red) {  // 兄弟节点为红色
                     w->color = Black;
                     xParent->color = Red;
+                    RBTREE_COUNT(eraseRecolors, 2);
                     RotateLeft(xParent, root);  // 对父节点进行左旋
                     w = xParent->right;  // 重新设置 w
                 }
@@ -946,6 +1924,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                 if ((w->left == nullptr || w->left->color == Black) &&
                     (w->right == nullptr || w->right->color == Black)) {
                     w->color = Red;
+                    RBTREE_COUNT(eraseRecolors, 1);
                     x = xParent;  // 将 x 移动到父节点
                     xParent = xParent->parent;
                 } else {
@@ -955,6 +1934,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                             w->left->color = Black;
                         }
                         w->color = Red;
+                        RBTREE_COUNT(eraseRecolors, 1 + (w->left != nullptr));
                         RotateRight(w, root);
                         w = xParent->right;
                     }
@@ -963,6 +1943,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                     if (w->right) {
                         w->right->color = Black;  // 兄弟的右子节点变为黑色
                     }
+                    RBTREE_COUNT(eraseRecolors, 2 + (w->right != nullptr));
                     RotateLeft(xParent, root);  // 对父节点进行左旋
                     break;  // 结束修复
                 }
@@ -971,12 +1952,14 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                 if (w->color == Red) {
                     w->color = Black;
                     xParent->color = Red;
+                    RBTREE_COUNT(eraseRecolors, 2);
                     RotateRight(xParent, root);
                     w = xParent->left;
                 }
                 if ((w->right == nullptr || w->right->color == Black) &&
                     (w->left == nullptr || w->left->color == Black)) {
                     w->color = Red;
+                    RBTREE_COUNT(eraseRecolors, 1);
                     x = xParent;
                     xParent = xParent->parent;
                 } else {
@@ -985,6 +1968,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                             w->right->color = Black;
                         }
                         w->color = Red;
+                        RBTREE_COUNT(eraseRecolors, 1 + (w->right != nullptr));
                         RotateLeft(w, root);
                         w = xParent->left;
                     }
@@ -993,6 +1977,7 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
                     if (w->left) {
                         w->left->color = Black;
                     }
+                    RBTREE_COUNT(eraseRecolors, 2 + (w->left != nullptr));
                     RotateRight(xParent, root);
                     break;
                 }
@@ -1000,9 +1985,48 @@ RbTree<Key, Value, KeyOfValue, Compare>::RebalanceForErase(NodePtr z,
         }
         if (x) {
             x->color = Black;  // 如果 x 不为空，设置 x 为黑色
+            RBTREE_COUNT(eraseRecolors, 1);
         }
     }
     return y;  // 返回被删除的节点
 }
 
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::_depthStats(NodePtr x, size_t depth,
+                                                          size_t &height, size_t &depthSum) {
+    while (x != nullptr) {  // 右子树递归, 左子树迭代, 递归深度不超过树高
+        height = max(height, depth);
+        depthSum += depth;
+        _depthStats(x->right, depth + 1, height, depthSum);
+        x = x->left;
+        ++depth;
+    }
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+RbTreeStats RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::stats() const {
+#ifdef RBTREE_STATS
+    RbTreeStats result = counters;
+    result.counting = true;
+#else
+    RbTreeStats result;
+#endif
+    result.size = nodeCount;
+    size_t depthSum = 0;
+    _depthStats(root(), 1, result.height, depthSum);
+    result.averageDepth = nodeCount ? (double) depthSum / nodeCount : 0;
+    // 红黑树各路径的黑色节点数相同, 沿最左路径统计即可
+    for (NodePtr x = root(); x != nullptr; x = x->left) {
+        result.blackHeight += x->color == Black;
+    }
+    return result;
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, class Augment>
+void RbTree<Key, Value, KeyOfValue, Compare, Alloc, Augment>::resetStats() {
+#ifdef RBTREE_STATS
+    counters = RbTreeStats();
+#endif
+}
+
 #endif //LIBRARYMANAGEMENT_RBTREE_H
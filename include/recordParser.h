@@ -0,0 +1,78 @@
+#ifndef LIBRARYMANAGEMENT_RECORDPARSER_H
+#define LIBRARYMANAGEMENT_RECORDPARSER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "admin.h"
+#include "book.h"
+using namespace std;
+
+// 文本数据文件的记录解析器
+// 直接在原始字节缓冲区上按行切分, 字段以 string_view 引用缓冲区, 数值字段用 from_chars 解析,
+// 解析过程本身不分配内存; 格式错误的行会连同行号记录下来并跳过, 不会被误读
+// 图书文件每行: 编号 ISBN 书名 作者 出版社 出版年份 借阅状态(0/1) [借阅人]
+// 管理员文件每行: 用户名 密码
+class RecordParser {
+public:
+    // 一条图书记录的字段视图 (字符串字段指向原始缓冲区)
+    struct BookFields {
+        int id = 0;
+        string_view ISBN, name, author, publisher;
+        int year = 0;
+        bool borrowStatus = false;
+        string_view borrower;
+
+        // 转换为 Book 对象
+        Book ToBook() const;
+    };
+
+    // 一条管理员记录的字段视图
+    struct AdminFields {
+        string_view name, password;
+
+        // 转换为 Admin 对象
+        Admin ToAdmin() const;
+    };
+
+    // 格式错误的行
+    struct Error {
+        size_t line;     // 行号 (从 1 开始)
+        string message;  // 错误原因
+    };
+
+private:
+    const char* pos;       // 当前读取位置
+    const char* end;       // 缓冲区末尾
+    size_t firstLine;      // 第一行的行号
+    size_t line;           // 下一行的行号
+    vector<Error> errors;  // 格式错误的行
+
+    // 每行最多的字段数 (多出的字段视为格式错误)
+    static constexpr size_t MaxTokens = 9;
+
+    // 取出下一行并切分为字段, 跳过空行; 没有更多行时返回 false
+    // count 为字段数, 行号记录在 lineNo 中
+    bool NextLine(string_view* tokens, size_t& count, size_t& lineNo);
+
+    // 解析整数字段
+    static bool ParseInt(string_view s, int& value);
+
+public:
+    // 在 [data, data + size) 上构造解析器, firstLine 为第一行的行号
+    RecordParser(const char* data, size_t size, size_t firstLine = 1);
+
+    // 解析下一条图书记录, 格式错误的行被记录并跳过; 没有更多记录时返回 false
+    bool NextBook(BookFields& fields);
+
+    // 解析下一条管理员记录, 格式错误的行被记录并跳过; 没有更多记录时返回 false
+    bool NextAdmin(AdminFields& fields);
+
+    // 已读取的行数
+    size_t LinesRead() const;
+
+    // 格式错误的行
+    const vector<Error>& Errors() const;
+};
+
+#endif //LIBRARYMANAGEMENT_RECORDPARSER_H
@@ -0,0 +1,118 @@
+#ifndef LIBRARYMANAGEMENT_TEXTINDEX_H
+#define LIBRARYMANAGEMENT_TEXTINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "title.h"
+using namespace std;
+
+// 书名、作者、出版社的全文倒排索引
+// 以书目 (一个 ISBN 的描述信息) 为单位建立索引, 同一 ISBN 的副本共享同一条记录
+// 分词: 连续的 ASCII 字母数字为一个词 (不区分大小写), 其他字符 (中文等) 每个字为一个词, 标点和空白忽略
+// 每个词对应一条倒排表, 表项为书目的内部编号 (文档号) 和该词出现在哪些字段:
+// - 文档号递增分配, 新书目总是追加到倒排表末尾, 倒排表始终有序
+// - 表项按 "与前一项的文档号差 (变长整数) + 字段掩码 (1 字节)" 压缩存放, 每 SkipInterval 项记录一个跳跃点
+// - 描述信息变化时旧文档号作废、分配新文档号重新登记, 作废的表项在查询时跳过, 过多时整体压缩并重新编号
+// 多词查询取交集 (各词都要出现): 从最短的倒排表出发, 在其余倒排表中用跳跃点倍增查找下一个候选
+// 结果按相关度排序: 每个词按 idf 加权, 出现在书名、作者、出版社中分别计 3、2、1 倍
+class TextIndex {
+private:
+    // 字段掩码
+    enum Field : uint8_t {
+        NameField = 1,       // 书名
+        AuthorField = 2,     // 作者
+        PublisherField = 4,  // 出版社
+    };
+
+    // 跳跃点: 第 k * SkipInterval 项的文档号、起始字节偏移和前一项的文档号
+    struct Skip {
+        uint32_t doc;
+        uint32_t offset;
+        uint32_t prevDoc;
+    };
+
+    // 压缩的倒排表
+    struct PostingList {
+        vector<uint8_t> bytes;  // 压缩的表项
+        vector<Skip> skips;     // 跳跃点
+        uint32_t count = 0;     // 表项个数 (含已作废的)
+        uint32_t last = 0;      // 最后一项的文档号
+
+        // 在末尾追加一项 (doc 必须大于已有的各项)
+        void Append(uint32_t doc, uint8_t fields);
+    };
+
+    // 倒排表上的游标
+    class Cursor {
+    private:
+        const PostingList* list;  // 遍历的倒排表
+        size_t offset;            // 下一项的字节偏移
+        uint32_t index;           // 下一项的序号
+
+    public:
+        uint32_t doc;             // 当前项的文档号
+        uint8_t fields;           // 当前项的字段掩码
+
+        // 构造函数, 位于第一项之前
+        explicit Cursor(const PostingList& list);
+
+        // 移到下一项, 已到末尾时返回 false
+        bool Next();
+
+        // 移到文档号不小于 target 的第一项 (只向后移动), 不存在时返回 false
+        bool Seek(uint32_t target);
+    };
+
+    // 每隔多少项记录一个跳跃点
+    static constexpr uint32_t SkipInterval = 64;
+
+    // 作废的文档超过 max(CompactMinDocs, 有效文档数) 时压缩
+    static constexpr size_t CompactMinDocs = 1024;
+
+    unordered_map<string, PostingList> terms;     // 词 -> 倒排表
+    unordered_map<string, uint32_t> docOfISBN;    // ISBN -> 当前文档号
+    vector<string> isbnOfDoc;                     // 文档号 -> ISBN
+    vector<string> textOfDoc;                     // 文档号 -> 登记时的书名、作者、出版社 (用于判断是否需要重新登记)
+    vector<uint8_t> alive;                        // 文档号 -> 是否有效
+    size_t live;                                  // 有效文档数
+
+    // 对 text 分词, 依次以 emit(词) 报告
+    template <class Emit>
+    static void _tokenize(const string& text, Emit emit);
+
+    // 书名、作者、出版社拼接为一个字符串, 用于比较描述信息是否变化
+    static string _textOf(const Title& title);
+
+    // 作废一个文档
+    void _retire(uint32_t doc);
+
+    // 作废的文档过多时, 去掉所有作废的文档, 有效文档按原顺序重新编号
+    void _compactIfNeeded();
+
+public:
+    // 构造函数, 索引为空
+    TextIndex();
+
+    // 清空索引
+    void Clear();
+
+    // 登记或更新一个书目, 书名、作者、出版社都没有变化时不做任何事
+    void Put(const Title& title);
+
+    // 移除一个 ISBN 的书目
+    void Remove(const string& ISBN);
+
+    // 查找包含 query 中所有词的书目, 返回按相关度从高到低排列的 ISBN (相关度相同时按 ISBN 排列)
+    // query 中没有任何词时返回空
+    vector<string> Search(const string& query) const;
+
+    // 有效的书目数
+    size_t Size() const;
+
+    // 不同的词数
+    size_t TermCount() const;
+};
+
+#endif //LIBRARYMANAGEMENT_TEXTINDEX_H
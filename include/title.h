@@ -0,0 +1,64 @@
+#ifndef LIBRARYMANAGEMENT_TITLE_H
+#define LIBRARYMANAGEMENT_TITLE_H
+
+#include <iostream>
+using namespace std;
+
+// Title 类表示一种书 (一个 ISBN) 的描述信息
+// 同一 ISBN 的所有副本共享同一个 Title, 描述信息在内存中只存一份
+class Title {
+private:
+    string ISBN;        // 国际标准书号
+    string name;        // 书名
+    string author;      // 作者
+    string publisher;   // 出版社
+    int year;           // 出版年份
+
+public:
+    // 默认构造函数
+    Title();
+
+    // 带参数的构造函数
+    Title(const string& ISBN, const string& name, const string& author,
+          const string& publisher, int year);
+
+    // 析构函数
+    ~Title();
+
+    // 复制与移动 (声明了析构函数后编译器不再隐式生成移动操作, 需要显式默认, 否则右值也只能复制)
+    Title(const Title& other) = default;
+    Title(Title&& other) noexcept = default;
+    Title& operator=(const Title& other) = default;
+    Title& operator=(Title&& other) noexcept = default;
+
+    // 获取 ISBN
+    const string& GetISBN() const;
+    // 设置 ISBN
+    void SetISBN(const string& ISBN);
+
+    // 获取书名
+    const string& GetName() const;
+    // 设置书名
+    void SetName(const string& name);
+
+    // 获取作者
+    const string& GetAuthor() const;
+    // 设置作者
+    void SetAuthor(const string& author);
+
+    // 获取出版社
+    const string& GetPublisher() const;
+    // 设置出版社
+    void SetPublisher(const string& publisher);
+
+    // 获取出版年份
+    int GetYear() const;
+    // 设置出版年份
+    void SetYear(int year);
+
+    // 比较两个 Title 的描述信息是否完全相同
+    bool operator==(const Title& other) const;
+    bool operator!=(const Title& other) const;
+};
+
+#endif //LIBRARYMANAGEMENT_TITLE_H
@@ -0,0 +1,81 @@
+#ifndef LIBRARYMANAGEMENT_YEARINDEX_H
+#define LIBRARYMANAGEMENT_YEARINDEX_H
+
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "rbTree.h"
+using namespace std;
+
+// 出版年份二级索引
+// 以 (出版年份, 书籍编号) 为键值的红黑树, 每本书一项, 支持:
+// - 按年份区间顺序遍历: 由名次直接定位到区间内的第 offset 项, O(log n + 返回的项数)
+// - 区间计数: 区间内的书数由名次相减得到, 其中已借出的书数由子树聚合值 (子树中已借出的书数) 得到, 均为 O(log n)
+// 子树聚合值由 RbTree 在插入、删除和旋转时维护 (见 BorrowedCount), 借阅状态变化后沿路径向上刷新
+class YearIndex {
+public:
+    // 批量构造时的一本书
+    struct Item {
+        int year;       // 出版年份
+        int id;         // 书籍编号
+        bool borrowed;  // 借阅状态
+    };
+
+private:
+    // 索引项
+    struct Entry {
+        pair<int, int> key;    // (出版年份, 书籍编号)
+        bool borrowed;         // 借阅状态
+        size_t borrowedCount;  // 以该项为根的子树中已借出的书数 (由 BorrowedCount 维护)
+    };
+
+    // 用于从索引项中提取键值
+    struct KeyOfEntry {
+        const pair<int, int>& operator()(const Entry& entry) const { return entry.key; }
+    };
+
+    // 子树聚合策略: 子树中已借出的书数
+    struct BorrowedCount {
+        static constexpr bool enabled = true;
+        static void update(Node<Entry>* x) {
+            x->value.borrowedCount = x->value.borrowed
+                                     + (x->left ? x->left->value.borrowedCount : 0)
+                                     + (x->right ? x->right->value.borrowedCount : 0);
+        }
+    };
+
+    typedef RbTree<pair<int, int>, Entry, KeyOfEntry, std::less<>, NodePool<Node<Entry>>, BorrowedCount> Tree;
+
+    Tree tree;  // 索引项
+
+    // 键值小于 k 的项数和其中已借出的项数
+    void _prefix(const pair<int, int>& k, size_t& total, size_t& borrowed);
+
+public:
+    // 由 items 重建索引 (排序后线性建树), 替换原有内容
+    void Build(const vector<Item>& items);
+
+    // 登记一本书
+    void Insert(int year, int id, bool borrowed);
+
+    // 移除一本书 (year 为登记时的出版年份), 不存在时不做任何事
+    void Erase(int year, int id);
+
+    // 修改一本书的借阅状态
+    void SetBorrowed(int year, int id, bool borrowed);
+
+    // 出版年份在 [yearMin, yearMax] 内的书数, 分为在库和已借出两部分
+    void Count(int yearMin, int yearMax, size_t& available, size_t& borrowed);
+
+    // 出版年份在 [yearMin, yearMax] 内的书按 (年份, 编号) 排列, 返回从第 offset 项开始的至多 limit 个编号
+    vector<int> Range(int yearMin, int yearMax, size_t offset, size_t limit);
+
+    // 清空索引
+    void Clear();
+
+    // 索引项个数
+    size_t Size() const;
+};
+
+#endif //LIBRARYMANAGEMENT_YEARINDEX_H
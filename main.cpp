@@ -1,15 +1,57 @@
 #include <iostream>
+#include <string>
+#include "../include/batchRunner.h"
 #include "../include/menu.h"
 #include "../include/adminManager.h"
 #include "../include/bookManager.h"
 using namespace std;
 
-int main()
+int main(int argc, char* argv[])
 {
+    // 批处理模式: LibraryManagement --batch <命令文件> [-v] [--admin <用户名>]
+    // 不显示菜单, 按文件中的命令调用无交互接口, 结束后输出统计
+    // 默认只执行查询命令; 指定 --admin 时从标准输入读取密码, 验证通过后才允许修改数据
+    if (argc >= 3 && string(argv[1]) == "--batch") {
+        bool verbose = false, readOnly = true;
+        for (int i = 3; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "-v") {
+                verbose = true;
+            } else if (arg == "--admin" && i + 1 < argc) {
+                AdminManager admin;
+                admin.Init("../data/admin",".txt");
+                string password;
+                cout << "请输入密码: " << endl;
+                getline(cin, password);
+                if (!admin.Verify(argv[++i], password)) {
+                    cout << "用户名或密码不正确!" << endl;
+                    return 1;
+                }
+                readOnly = false;
+            } else {
+                cout << "未知参数: " << arg << endl;
+                return 1;
+            }
+        }
+        BookManager book;
+        if (book.Init("../data/book",".bin") != BookManager::Ok) {
+            return 1;
+        }
+        BatchRunner runner(book, verbose, readOnly);
+        if (!runner.Run(argv[2])) {
+            cout << "无法打开命令文件: " << argv[2] << endl;
+            return 1;
+        }
+        runner.PrintSummary(cout);
+        return 0;
+    }
+
     AdminManager admin;
     BookManager book;
     admin.Init("../data/admin",".txt");
-    book.Init("../data/book",".txt");
+    if (book.Init("../data/book",".bin") != BookManager::Ok) {
+        return 1;
+    }
 
     Menu::Start();
     int choice;
@@ -55,6 +97,26 @@ int main()
                                         book.FindByPage(1, 20);
                                         break;
                                     }
+                                    case 4: {
+                                        // 多条件筛选
+                                        book.FindWhere();
+                                        break;
+                                    }
+                                    case 5: {
+                                        // 关键词检索
+                                        book.Search();
+                                        break;
+                                    }
+                                    case 6: {
+                                        // 按书名或作者前缀查找
+                                        book.Suggest();
+                                        break;
+                                    }
+                                    case 7: {
+                                        // 按出版年份查找
+                                        book.FindByYear();
+                                        break;
+                                    }
                                     default: {
                                         cout << "非法输入，请重试!" << endl;
                                         break;
@@ -151,6 +213,16 @@ int main()
                             }
                             break;
                         }
+                        case 6: {
+                            // 红黑树结构统计
+                            book.PrintTreeStats(cout);
+                            break;
+                        }
+                        case 7: {
+                            // 导入分馆图书
+                            book.Import();
+                            break;
+                        }
                         default: {
                             cout << "非法输入，请重试!" << endl;
                             break;
@@ -180,8 +252,9 @@ int main()
     }
 
     admin.Save("../data/admin",".txt");
-    book.Save("../data/book",".txt");
+    // 修改已随操作写入日志, 退出时只需提交剩余记录
+    BookManager::Status synced = book.Sync();
     cout << "欢迎下次再来!" << endl;
 
-    return 0;
+    return synced == BookManager::Ok ? 0 : 1;
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include "adminManager.h"
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <vector>
 #include "rbTree.h"
+#include "recordParser.h"
 using namespace std;
 
 // 使用默认构造函数
@@ -17,26 +20,31 @@ void AdminManager::Init(string path, string fileType) {
 
     // 打开文件读取数据
     ifstream in;
-    in.open(file, ios::in);  // 以输入模式打开文件
+    in.open(file, ios::in | ios::binary);  // 以输入模式打开文件
     if (!in.is_open()) {  // 如果文件无法打开，说明文件可能不存在
         // 如果文件不存在，创建文件并立即关闭
         ofstream out;
         out.open(file, ios::out | ios::app);  // 以追加模式打开文件
         out.close();  // 创建文件后关闭
-        in.open(file, ios::in);  // 重新以输入模式打开文件
+        in.open(file, ios::in | ios::binary);  // 重新以输入模式打开文件
     }
 
+    // 一次读入整个文件, 交给记录解析器逐行解析
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();  // 关闭文件
+    RecordParser parser(data.data(), data.size());
+
     // 临时存储管理员信息的变量
-    Admin user;
-    // 读取文件内容直到文件末尾
-    while (in.peek() != EOF) {  // 使用 peek 检查是否到文件末尾
-        in >> user;  // 从文件中读取管理员数据到 user
-        // 将读取到的管理员数据插入到 adminManager 容器中
-        adminManager.insertUnique(adminManager.end(), user);
+    vector<Admin> users;
+    RecordParser::AdminFields fields;
+    while (parser.NextAdmin(fields)) {
+        users.push_back(fields.ToAdmin());
     }
-
-    // 关闭文件
-    in.close();
+    for (const RecordParser::Error& e : parser.Errors()) {  // 报告格式错误的行
+        cout << file << " 第 " << e.line << " 行格式错误 (已跳过): " << e.message << endl;
+    }
+    // Save 按用户名顺序写出, 通常可以线性批量建树; 若顺序被打乱则自动退化为逐个插入
+    adminManager.buildUnique(users.begin(), users.end());
 }
 
 // 管理员注册功能
@@ -69,9 +77,8 @@ bool AdminManager::Register() {
         return false;
     }
 
-    // 创建新的管理员对象并插入到管理员管理器中
-    Admin user(name, password);
-    adminManager.insertUnique(adminManager.end(), user);
+    // 在红黑树的新节点中直接构造管理员对象 (上面已确认用户名不重复)
+    adminManager.emplaceUnique(name, password);
     cout << "恭喜你!账号注册成功" << endl;
     return true;
 }
@@ -86,15 +93,8 @@ bool AdminManager::Login() {
     cout << "请输入您的密码: ";
     cin >> password;
 
-    // 查找输入的用户名是否存在
-    auto it = adminManager.find(name);
-    if (it == adminManager.end()) {  // 用户名不存在
-        cout << "用户名或密码不正确!请重试" << endl;
-        return false;
-    }
-
-    // 检查输入的密码是否与注册的密码匹配
-    if ((*it).GetAdminPassword() != password) {  // 密码不匹配
+    // 用户名不存在或密码不匹配时给出相同的提示
+    if (!Verify(name, password)) {
         cout << "用户名或密码不正确!请重试" << endl;
         return false;
     }
@@ -103,6 +103,17 @@ bool AdminManager::Login() {
     return true;
 }
 
+// 校验用户名和密码
+bool AdminManager::Verify(string_view name, string_view password) {
+    // 查找输入的用户名是否存在
+    auto it = adminManager.find(name);
+    if (it == adminManager.end()) {  // 用户名不存在
+        return false;
+    }
+    // 检查输入的密码是否与注册的密码匹配
+    return it->GetAdminPassword() == password;
+}
+
 // 保存管理员数据到文件
 void AdminManager::Save(string filePath, string fileType) {
     // 打开临时文件进行数据写入，使用追加模式
@@ -0,0 +1,294 @@
+#include "batchRunner.h"
+#include <chrono>
+#include <fstream>
+using namespace std;
+
+// 构造函数
+BatchRunner::BatchRunner(BookManager& books, bool verbose, bool readOnly)
+        : books(books), verbose(verbose), readOnly(readOnly) {}
+
+// 命令名称
+const char* BatchRunner::CommandName(Command command) {
+    static const char* names[CommandCount] = {
+            "add", "find id", "find isbn", "find page", "lend", "return", "remove id", "remove isbn", "save", "stats",
+            "filter", "search", "suggest", "years", "import",
+    };
+    return names[command];
+}
+
+// 是否为修改数据的命令
+bool BatchRunner::IsWrite(const string& op) {
+    return op == "add" || op == "lend" || op == "return" || op == "remove" || op == "save" || op == "import";
+}
+
+// 记录一条命令的执行结果
+void BatchRunner::Record(Command command, BookManager::Status status) {
+    ++stats.count[command];
+    ++stats.total;
+    if (status != BookManager::Ok) {
+        ++stats.failed[command];
+    }
+    if (verbose) {
+        cout << CommandName(command) << ": " << BookManager::StatusText(status) << endl;
+    }
+}
+
+// 提交日志, 失败时计入统计
+void BatchRunner::Sync() {
+    if (books.Sync() != BookManager::Ok) {
+        ++stats.syncFailed;
+    }
+}
+
+// 输出一组查找结果
+void BatchRunner::Print(const vector<Book>& found) const {
+    if (verbose) {
+        for (const Book& book : found) {
+            cout << book << endl;
+        }
+    }
+}
+
+// 解析并执行一行命令
+bool BatchRunner::Execute(const string& line) {
+    fields.clear();
+    fields.str(line);
+    string op, arg;
+    if (!(fields >> op) || op[0] == '#') {
+        return true;  // 空行或注释
+    }
+    if (readOnly && IsWrite(op)) {  // 未验证管理员身份, 不执行修改
+        ++stats.denied;
+        if (verbose) {
+            cout << op << ": 只读模式, 已拒绝" << endl;
+        }
+        return true;
+    }
+
+    if (op == "add") {
+        string ISBN, name, author, publisher;
+        int year, count, firstId;
+        if (!(fields >> ISBN >> name >> author >> publisher >> year >> count)) {
+            return false;
+        }
+        Record(Add, books.Insert(Title(ISBN, name, author, publisher, year), count, firstId));
+    } else if (op == "find") {
+        if (!(fields >> arg)) {
+            return false;
+        }
+        if (arg == "id") {
+            int id;
+            Book book;
+            if (!(fields >> id)) {
+                return false;
+            }
+            BookManager::Status status = books.FindByID(id, book);
+            Record(FindId, status);
+            if (status == BookManager::Ok) {
+                Print({book});
+            }
+        } else if (arg == "isbn") {
+            string ISBN;
+            if (!(fields >> ISBN)) {
+                return false;
+            }
+            vector<Book> found = books.FindByISBN(ISBN);
+            Record(FindISBN, found.empty() ? BookManager::NotFound : BookManager::Ok);
+            Print(found);
+        } else if (arg == "page") {
+            size_t page, pageSize = 20;
+            if (!(fields >> page)) {
+                return false;
+            }
+            fields >> pageSize;  // 每页数量可省略
+            vector<Book> found = books.FindPage(page, pageSize);
+            Record(FindPage, found.empty() ? BookManager::NotFound : BookManager::Ok);
+            Print(found);
+        } else {
+            return false;
+        }
+    } else if (op == "lend") {
+        int id;
+        string borrower;
+        if (!(fields >> id >> borrower)) {
+            return false;
+        }
+        Record(Lend, books.Lend(id, borrower));
+    } else if (op == "return") {
+        int id;
+        if (!(fields >> id)) {
+            return false;
+        }
+        Record(Return, books.Return(id));
+    } else if (op == "remove") {
+        if (!(fields >> arg)) {
+            return false;
+        }
+        if (arg == "id") {
+            int id;
+            if (!(fields >> id)) {
+                return false;
+            }
+            Record(RemoveId, books.RemoveByID(id));
+        } else if (arg == "isbn") {
+            string ISBN;
+            if (!(fields >> ISBN)) {
+                return false;
+            }
+            Record(RemoveISBN, books.RemoveByISBN(ISBN, true));
+        } else {
+            return false;
+        }
+    } else if (op == "save") {
+        string path, fileType;
+        if (!(fields >> path >> fileType)) {
+            return false;
+        }
+        BookManager::Status status = books.Sync();  // 先提交之前的修改
+        Record(Save, status == BookManager::Ok ? books.Save(path, fileType) : status);
+    } else if (op == "stats") {
+        Record(TreeStats, BookManager::Ok);
+        books.PrintTreeStats(cout);
+    } else if (op == "filter") {
+        BookColumns::Query query;
+        while (fields >> arg) {
+            if (arg == "author" && fields >> query.author) {
+                query.byAuthor = true;
+            } else if (arg == "publisher" && fields >> query.publisher) {
+                query.byPublisher = true;
+            } else if (arg == "year" && fields >> query.yearMin >> query.yearMax) {
+                continue;
+            } else if (arg == "available") {
+                query.availability = BookColumns::Available;
+            } else if (arg == "borrowed") {
+                query.availability = BookColumns::BorrowedOnly;
+            } else {
+                return false;
+            }
+        }
+        size_t count = books.CountWhere(query);
+        Record(Filter, count > 0 ? BookManager::Ok : BookManager::NotFound);
+        if (verbose) {
+            cout << "共 " << count << " 本" << endl;
+            Print(books.FindWhere(query, FilterPrintLimit));
+        }
+    } else if (op == "search") {
+        size_t page, total;
+        string text;
+        if (!(fields >> page) || !getline(fields, text)) {
+            return false;
+        }
+        vector<Book> found = books.Search(text, page, SearchPageSize, total);
+        Record(Search, found.empty() ? BookManager::NotFound : BookManager::Ok);
+        if (verbose) {
+            cout << "共 " << total << " 本" << endl;
+            Print(found);
+        }
+    } else if (op == "suggest") {
+        string prefix;
+        if (!(fields >> arg) || (arg != "name" && arg != "author") || !(fields >> ws) || !getline(fields, prefix)) {
+            return false;
+        }
+        vector<Title> found = books.Suggest(prefix, SuggestLimit, arg == "author");
+        Record(Suggest, found.empty() ? BookManager::NotFound : BookManager::Ok);
+        if (verbose) {
+            for (const Title& title : found) {
+                cout << "  " << title.GetName() << "  " << title.GetAuthor() << "  ISBN: " << title.GetISBN() << endl;
+            }
+        }
+    } else if (op == "years") {
+        int yearMin, yearMax;
+        size_t page = 1, available, borrowed;
+        if (!(fields >> yearMin >> yearMax)) {
+            return false;
+        }
+        fields >> page;  // 页码可省略
+        books.CountByYear(yearMin, yearMax, available, borrowed);
+        Record(YearRange, available + borrowed > 0 ? BookManager::Ok : BookManager::NotFound);
+        if (verbose) {
+            cout << "在库 " << available << " 本, 借出 " << borrowed << " 本" << endl;
+            Print(books.FindByYear(yearMin, yearMax, page, SearchPageSize));
+        }
+    } else if (op == "import") {
+        string file;
+        if (!(fields >> file)) {
+            return false;
+        }
+        bool dedupe = fields >> arg && arg == "dedupe";
+        ostream discard(nullptr);  // 非 verbose 模式不输出进度
+        BookManager::ImportStats imported;
+        BookManager::Status status = books.Import(file, dedupe, imported, verbose ? cout : discard);
+        if (status == BookManager::Ok) {
+            status = books.Sync();  // 整批一次提交, 日志过长时随之压缩为快照
+        }
+        Record(Import, status);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 执行命令文件
+bool BatchRunner::Run(const string& file) {
+    ifstream in(file);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    stats = Stats();
+    errors.clear();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    string line;
+    size_t lineNumber = 0;
+    size_t synced = 0;  // 上次提交时已执行的命令数
+    while (getline(in, line)) {
+        ++lineNumber;
+        if (!Execute(line)) {
+            errors.push_back({lineNumber, "无法识别的命令: " + line});
+        }
+        if (stats.total - synced >= SyncInterval) {
+            Sync();
+            synced = stats.total;
+        }
+    }
+    Sync();  // 提交剩余的修改
+
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// 获取最近一次执行的统计
+const BatchRunner::Stats& BatchRunner::GetStats() const {
+    return stats;
+}
+
+// 输出执行统计
+void BatchRunner::PrintSummary(ostream& out, size_t maxErrors) const {
+    out << "批处理完成: 共执行 " << stats.total << " 条命令, 耗时 " << stats.seconds * 1000 << " ms";
+    if (stats.seconds > 0) {
+        out << " (" << (size_t) (stats.total / stats.seconds) << " 条/秒)";
+    }
+    out << endl;
+    for (int c = 0; c < CommandCount; ++c) {
+        if (stats.count[c]) {
+            out << "  " << CommandName((Command) c) << ": " << stats.count[c] << " 条";
+            if (stats.failed[c]) {
+                out << ", 其中失败 " << stats.failed[c] << " 条";
+            }
+            out << endl;
+        }
+    }
+    if (stats.denied) {
+        out << "  只读模式下拒绝修改命令 " << stats.denied << " 条 (需以管理员身份运行)" << endl;
+    }
+    if (stats.syncFailed) {
+        out << "  日志提交失败 " << stats.syncFailed << " 次, 部分修改未能保存" << endl;
+    }
+    for (size_t i = 0; i < errors.size() && i < maxErrors; ++i) {
+        out << "第 " << errors[i].line << " 行格式错误 (已跳过): " << errors[i].message << endl;
+    }
+    if (errors.size() > maxErrors) {
+        out << "另有 " << errors.size() - maxErrors << " 行格式错误" << endl;
+    }
+}
@@ -0,0 +1,50 @@
+#include "binaryCodec.h"
+#include <array>
+using namespace std;
+
+// 向字符串追加一个 32 位整数 (小端序)
+void BinaryCodec::PutUint32(string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back((char) ((v >> (8 * i)) & 0xFF));
+    }
+}
+
+// 从 p 处读取一个 32 位整数 (小端序)
+uint32_t BinaryCodec::GetUint32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        v |= (uint32_t) (unsigned char) p[i] << (8 * i);
+    }
+    return v;
+}
+
+// 从缓冲区读取一个 32 位整数
+bool BinaryCodec::GetUint32(const string& in, size_t& pos, uint32_t& v) {
+    if (in.size() - pos < 4) {
+        return false;
+    }
+    v = GetUint32(in.data() + pos);
+    pos += 4;
+    return true;
+}
+
+// 计算 CRC32 校验值 (多项式 0xEDB88320)
+uint32_t BinaryCodec::Crc32(const char* data, size_t len) {
+    // 查找表在首次调用时生成 (局部静态变量的初始化是线程安全的)
+    static const array<uint32_t, 256> table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ (unsigned char) data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
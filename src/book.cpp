@@ -1,61 +1,77 @@
 #include "book.h"
 
-// 默认构造函数
-Book::Book() = default;
+// 默认构造函数, 数值字段初始化为 0, 借阅状态为在库中, 描述信息为空
+Book::Book() : id(0), borrowStatus(false) {
+    static const shared_ptr<const Title> empty = make_shared<Title>();  // 所有默认对象共享
+    title = empty;
+}
 
-// 有参构造函数
+// 有参构造函数, 为这本书单独创建描述信息
 Book::Book(int id, const string& ISBN, const string& name, const string& author,
            const string& publisher, int year, bool borrowStatus,
            const string& borrower)
         : id(id),                          // 初始化编号
-          ISBN(ISBN),                      // 初始化 ISBN
-          name(name),                      // 初始化书名
-          author(author),                  // 初始化作者
-          publisher(publisher),            // 初始化出版社
-          year(year),                      // 初始化出版年份
+          title(make_shared<Title>(ISBN, name, author, publisher, year)),  // 初始化描述信息
           borrowStatus(borrowStatus),      // 初始化借阅状态
           borrower(borrower) {}            // 初始化借阅人
 
+// 引用已有描述信息的构造函数
+Book::Book(int id, shared_ptr<const Title> title, bool borrowStatus, const string& borrower)
+        : id(id), title(move(title)), borrowStatus(borrowStatus), borrower(borrower) {}
+
 // 默认析构函数
 Book::~Book() = default;
 
+// 复制一份自己的描述信息
+Title& Book::_ownTitle() {
+    shared_ptr<Title> own = make_shared<Title>(*title);
+    title = own;
+    return *own;
+}
+
 // 获取编号
 const int& Book::GetId() const { return id; }
 
 // 设置编号
 void Book::SetId(int id) { Book::id = id; }
 
+// 获取描述信息
+const shared_ptr<const Title>& Book::GetTitle() const { return title; }
+
+// 设置描述信息
+void Book::SetTitle(shared_ptr<const Title> title) { Book::title = move(title); }
+
 // 获取 ISBN
-const string& Book::GetISBN() const { return ISBN; }
+const string& Book::GetISBN() const { return title->GetISBN(); }
 
 // 设置 ISBN
-void Book::SetISBN(const string& ISBN) { Book::ISBN = ISBN; }
+void Book::SetISBN(const string& ISBN) { _ownTitle().SetISBN(ISBN); }
 
 // 获取书名
-const string& Book::GetName() const { return name; }
+const string& Book::GetName() const { return title->GetName(); }
 
 // 设置书名
-void Book::SetName(const string& name) { Book::name = name; }
+void Book::SetName(const string& name) { _ownTitle().SetName(name); }
 
 // 获取作者
-const string& Book::GetAuthor() const { return author; }
+const string& Book::GetAuthor() const { return title->GetAuthor(); }
 
 // 设置作者
-void Book::SetAuthor(const string& author) { Book::author = author; }
+void Book::SetAuthor(const string& author) { _ownTitle().SetAuthor(author); }
 
 // 获取出版社
-const string& Book::GetPublisher() const { return publisher; }
+const string& Book::GetPublisher() const { return title->GetPublisher(); }
 
 // 设置出版社
 void Book::SetPublisher(const string& publisher) {
-    Book::publisher = publisher;
+    _ownTitle().SetPublisher(publisher);
 }
 
 // 获取出版年份
-int Book::GetYear() const { return year; }
+int Book::GetYear() const { return title->GetYear(); }
 
 // 设置出版年份
-void Book::SetYear(int year) { Book::year = year; }
+void Book::SetYear(int year) { _ownTitle().SetYear(year); }
 
 // 获取借阅状态
 bool Book::GetBorrowStatus() const { return borrowStatus; }
@@ -72,8 +88,10 @@ void Book::SetBorrower(const string& borrower) { Book::borrower = borrower; }
 // 重载输入流运算符，用于输入书的相关信息
 istream& operator>>(istream& in, Book& book) {
     // 输入编号、ISBN、书名、作者、出版社、出版年份和借阅状态
-    in >> book.id >> book.ISBN >> book.name >> book.author >> book.publisher >>
-       book.year >> book.borrowStatus;
+    string ISBN, name, author, publisher;
+    int year = 0;
+    in >> book.id >> ISBN >> name >> author >> publisher >> year >> book.borrowStatus;
+    book.title = make_shared<Title>(ISBN, name, author, publisher, year);
 
     // 如果书处于借阅状态，还需输入借阅人信息
     if (book.borrowStatus) {
@@ -89,11 +107,11 @@ ostream& operator<<(ostream& out, const Book& book) {
     // 判断是否为标准输出
     if (&out == &cout) {
         out << "  书籍编号: " << book.id
-            << "  ISBN: " << book.ISBN
-            << "  书名: " << book.name
-            << "  作者: " << book.author
-            << "  出版社: " << book.publisher
-            << "  出版年份: " << book.year
+            << "  ISBN: " << book.GetISBN()
+            << "  书名: " << book.GetName()
+            << "  作者: " << book.GetAuthor()
+            << "  出版社: " << book.GetPublisher()
+            << "  出版年份: " << book.GetYear()
             << "  借阅状态: " << (book.borrowStatus ? "已借出" : "在库中");
 
         if (book.borrowStatus) {
@@ -101,8 +119,8 @@ ostream& operator<<(ostream& out, const Book& book) {
         }
     } else {
         // 格式化输出到文件，字段以空格分隔
-        out << book.id << " " << book.ISBN << " " << book.name << " "
-            << book.author << " " << book.publisher << " " << book.year << " "
+        out << book.id << " " << book.GetISBN() << " " << book.GetName() << " "
+            << book.GetAuthor() << " " << book.GetPublisher() << " " << book.GetYear() << " "
             << book.borrowStatus << " " << (book.borrowStatus ? book.borrower : "");
     }
     return out;
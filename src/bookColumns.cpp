@@ -0,0 +1,309 @@
+#include "bookColumns.h"
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+// 掩码中最低位的 1 的位置 (mask 不为 0)
+static inline int lowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int i = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+// 掩码中 1 的个数
+static inline int bitCount(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    int n = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// 返回字符串的编码, 不存在时分配新编码
+uint32_t BookColumns::Dictionary::Encode(const string& value) {
+    auto it = codes.find(value);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    uint32_t code = (uint32_t) values.size();
+    values.push_back(value);
+    codes.emplace(value, code);
+    return code;
+}
+
+// 查找字符串的编码
+bool BookColumns::Dictionary::Find(const string& value, uint32_t& code) const {
+    auto it = codes.find(value);
+    if (it == codes.end()) {
+        return false;
+    }
+    code = it->second;
+    return true;
+}
+
+// 字典中的字符串个数
+size_t BookColumns::Dictionary::Size() const { return values.size(); }
+
+// 清空字典
+void BookColumns::Dictionary::Clear() {
+    values.clear();
+    codes.clear();
+}
+
+// 构造函数
+BookColumns::BookColumns() : live(0) {}
+
+// 清空所有行和字典
+void BookColumns::Clear() {
+    ids.clear();
+    years.clear();
+    borrowed.clear();
+    authors.clear();
+    publishers.clear();
+    valid.clear();
+    live = 0;
+    authorDict.Clear();
+    publisherDict.Clear();
+}
+
+// 预留 n 行的空间
+void BookColumns::Reserve(size_t n) {
+    ids.reserve(n);
+    years.reserve(n);
+    borrowed.reserve(n);
+    authors.reserve(n);
+    publishers.reserve(n);
+    valid.reserve(n);
+}
+
+// 按编号定位行
+bool BookColumns::_findRow(int id, size_t& row) const {
+    // 最常见的情况: 编号大于所有已有行 (追加)
+    if (ids.empty() || ids.back() < id) {
+        row = ids.size();
+        return false;
+    }
+    row = (size_t) (lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+    return ids[row] == id;
+}
+
+// 用 book 的字段填写第 row 行
+void BookColumns::_fillRow(size_t row, const Book& book) {
+    ids[row] = book.GetId();
+    years[row] = book.GetYear();
+    borrowed[row] = book.GetBorrowStatus() ? 1 : 0;
+    authors[row] = authorDict.Encode(book.GetAuthor());
+    publishers[row] = publisherDict.Encode(book.GetPublisher());
+    if (!valid[row]) {
+        valid[row] = 1;
+        ++live;
+    }
+}
+
+// 按编号加入一本书
+void BookColumns::Put(const Book& book) {
+    size_t row;
+    if (!_findRow(book.GetId(), row)) {
+        // 编号不存在: 在 row 处插入新行 (编号递增时 row 为末尾, 不移动任何元素)
+        ids.insert(ids.begin() + row, book.GetId());
+        years.insert(years.begin() + row, 0);
+        borrowed.insert(borrowed.begin() + row, 0);
+        authors.insert(authors.begin() + row, 0);
+        publishers.insert(publishers.begin() + row, 0);
+        valid.insert(valid.begin() + row, 0);
+    }
+    _fillRow(row, book);
+}
+
+// 按编号删除一本书
+void BookColumns::Remove(int id) {
+    size_t row;
+    if (!_findRow(id, row) || !valid[row]) {
+        return;
+    }
+    valid[row] = 0;
+    --live;
+    // 空行过多时压缩, 平摊到每次删除为 O(1)
+    if (ids.size() - live > max(CompactMinRows, live)) {
+        _compact();
+    }
+}
+
+// 修改一本书的借阅状态
+void BookColumns::SetBorrowed(int id, bool status) {
+    size_t row;
+    if (_findRow(id, row) && valid[row]) {
+        borrowed[row] = status ? 1 : 0;
+    }
+}
+
+// 去掉所有空行
+void BookColumns::_compact() {
+    size_t out = 0;
+    for (size_t row = 0; row < ids.size(); ++row) {
+        if (!valid[row]) {
+            continue;
+        }
+        ids[out] = ids[row];
+        years[out] = years[row];
+        borrowed[out] = borrowed[row];
+        authors[out] = authors[row];
+        publishers[out] = publishers[row];
+        valid[out] = 1;
+        ++out;
+    }
+    ids.resize(out);
+    years.resize(out);
+    borrowed.resize(out);
+    authors.resize(out);
+    publishers.resize(out);
+    valid.resize(out);
+}
+
+// 把筛选条件编码为 Predicate
+bool BookColumns::_compile(const Query& query, Predicate& predicate) const {
+    predicate.byAuthor = query.byAuthor;
+    predicate.byPublisher = query.byPublisher;
+    predicate.byYear = query.yearMin != INT_MIN || query.yearMax != INT_MAX;
+    predicate.byStatus = query.availability != AnyStatus;
+    predicate.author = predicate.publisher = 0;
+    predicate.yearMin = query.yearMin;
+    predicate.yearMax = query.yearMax;
+    predicate.status = query.availability == BorrowedOnly ? 1 : 0;
+    // 字典中没有的作者或出版社不可能匹配任何行
+    if (query.byAuthor && !authorDict.Find(query.author, predicate.author)) {
+        return false;
+    }
+    if (query.byPublisher && !publisherDict.Find(query.publisher, predicate.publisher)) {
+        return false;
+    }
+    return query.yearMin <= query.yearMax;
+}
+
+// 单行是否满足条件
+bool BookColumns::_match(const Predicate& predicate, size_t row) const {
+    return valid[row]
+           && (!predicate.byStatus || borrowed[row] == predicate.status)
+           && (!predicate.byAuthor || authors[row] == predicate.author)
+           && (!predicate.byPublisher || publishers[row] == predicate.publisher)
+           && (!predicate.byYear || (years[row] >= predicate.yearMin && years[row] <= predicate.yearMax));
+}
+
+// 扫描所有行
+template <class Emit>
+void BookColumns::_scan(const Predicate& predicate, Emit emit) const {
+    size_t rows = ids.size();
+    size_t row = 0;
+#if defined(__SSE2__)
+    // 每块 16 行: 8 位的列一次比较 16 行, 32 位的列分 4 次, 每次 4 行
+    // 每列的比较结果用 movemask 压成 16 位掩码后按位与, 掩码已为 0 时跳过剩余的列
+    const __m128i status = _mm_set1_epi8((char) predicate.status);
+    const __m128i author = _mm_set1_epi32((int) predicate.author);
+    const __m128i publisher = _mm_set1_epi32((int) predicate.publisher);
+    const __m128i yearMin = _mm_set1_epi32(predicate.yearMin);
+    const __m128i yearMax = _mm_set1_epi32(predicate.yearMax);
+    const __m128i one = _mm_set1_epi8(1);
+
+    // 4 行 32 位值的比较结果 (每行 32 位全 1 或全 0) 转为 4 位掩码
+    auto mask4 = [](__m128i cmp) { return (unsigned) _mm_movemask_ps(_mm_castsi128_ps(cmp)); };
+
+    for (; row + 16 <= rows; row += 16) {
+        unsigned mask = (unsigned) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (valid.data() + row)), one));
+        if (mask != 0 && predicate.byStatus) {
+            mask &= (unsigned) _mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (borrowed.data() + row)), status));
+        }
+        if (mask != 0 && predicate.byAuthor) {
+            unsigned m = 0;
+            for (int k = 0; k < 4; ++k) {
+                __m128i v = _mm_loadu_si128((const __m128i*) (authors.data() + row + 4 * k));
+                m |= mask4(_mm_cmpeq_epi32(v, author)) << (4 * k);
+            }
+            mask &= m;
+        }
+        if (mask != 0 && predicate.byPublisher) {
+            unsigned m = 0;
+            for (int k = 0; k < 4; ++k) {
+                __m128i v = _mm_loadu_si128((const __m128i*) (publishers.data() + row + 4 * k));
+                m |= mask4(_mm_cmpeq_epi32(v, publisher)) << (4 * k);
+            }
+            mask &= m;
+        }
+        if (mask != 0 && predicate.byYear) {
+            // yearMin <= year <= yearMax 等价于 !(year < yearMin || year > yearMax)
+            unsigned m = 0;
+            for (int k = 0; k < 4; ++k) {
+                __m128i v = _mm_loadu_si128((const __m128i*) (years.data() + row + 4 * k));
+                __m128i out = _mm_or_si128(_mm_cmplt_epi32(v, yearMin), _mm_cmpgt_epi32(v, yearMax));
+                m |= (~mask4(out) & 0xFu) << (4 * k);
+            }
+            mask &= m;
+        }
+        if (mask != 0 && !emit(row, (uint32_t) mask)) {
+            return;
+        }
+    }
+#endif
+    // 剩余不足一块的行 (或不支持 SSE2 的平台上的全部行) 逐行比较
+    while (row < rows) {
+        size_t base = row;
+        uint32_t mask = 0;
+        for (size_t i = 0; i < 16 && row < rows; ++i, ++row) {
+            if (_match(predicate, row)) {
+                mask |= 1u << i;
+            }
+        }
+        if (mask != 0 && !emit(base, mask)) {
+            return;
+        }
+    }
+}
+
+// 返回满足条件的书籍编号
+vector<int> BookColumns::Select(const Query& query, size_t limit) const {
+    vector<int> result;
+    Predicate predicate;
+    if (limit == 0 || !_compile(query, predicate)) {
+        return result;
+    }
+    // 收集到 limit 个后停止扫描
+    _scan(predicate, [this, &result, limit](size_t base, uint32_t mask) {
+        while (mask != 0 && result.size() < limit) {
+            result.push_back(ids[base + lowestBit(mask)]);
+            mask &= mask - 1;  // 去掉最低位的 1
+        }
+        return result.size() < limit;
+    });
+    return result;
+}
+
+// 返回满足条件的书籍个数
+size_t BookColumns::Count(const Query& query) const {
+    Predicate predicate;
+    if (!_compile(query, predicate)) {
+        return 0;
+    }
+    size_t count = 0;
+    _scan(predicate, [&count](size_t, uint32_t mask) {
+        count += bitCount(mask);
+        return true;
+    });
+    return count;
+}
+
+// 有效行数
+size_t BookColumns::Size() const { return live; }
@@ -0,0 +1,212 @@
+#include "bookLoader.h"
+#include <chrono>
+#include <fstream>
+#include <thread>
+using namespace std;
+
+// 有界队列构造函数
+BookLoader::BlockQueue::BlockQueue(size_t capacity) : capacity(capacity), closed(false) {}
+
+// 放入一个数据块, 队列满时等待解析线程取走
+void BookLoader::BlockQueue::Push(Block block) {
+    unique_lock<mutex> guard(lock);
+    notFull.wait(guard, [this] { return blocks.size() < capacity; });
+    blocks.push_back(move(block));
+    notEmpty.notify_one();
+}
+
+// 取出一个数据块
+bool BookLoader::BlockQueue::Pop(Block& block) {
+    unique_lock<mutex> guard(lock);
+    notEmpty.wait(guard, [this] { return !blocks.empty() || closed; });
+    if (blocks.empty()) {
+        return false;  // 队列已关闭且没有剩余数据
+    }
+    block = move(blocks.front());
+    blocks.pop_front();
+    notFull.notify_one();
+    return true;
+}
+
+// 关闭队列, 唤醒所有等待的解析线程
+void BookLoader::BlockQueue::Close() {
+    lock_guard<mutex> guard(lock);
+    closed = true;
+    notEmpty.notify_all();
+}
+
+// 构造函数
+BookLoader::BookLoader(size_t threads, size_t blockSize)
+        : threads(threads), blockSize(blockSize) {
+    if (this->threads == 0) {
+        this->threads = max(1u, thread::hardware_concurrency());
+    }
+}
+
+// 解析一个数据块中的所有记录
+void BookLoader::ParseBlock(const string& data, Run& run) {
+    RecordParser parser(data.data(), data.size());
+    RecordParser::BookFields fields;
+    shared_ptr<const Title> last;  // 上一条记录的描述信息
+    while (parser.NextBook(fields)) {
+        // 同一 ISBN 的副本编号连续, 通常相邻出现, 直接共享上一条记录的描述信息
+        if (last && fields.ISBN == last->GetISBN() && fields.name == last->GetName() &&
+            fields.author == last->GetAuthor() && fields.publisher == last->GetPublisher() &&
+            fields.year == last->GetYear()) {
+            run.books.emplace_back(fields.id, last, fields.borrowStatus, string(fields.borrower));
+        } else {
+            run.books.push_back(fields.ToBook());
+            last = run.books.back().GetTitle();
+        }
+    }
+    run.errors = parser.Errors();
+    run.lines = parser.LinesRead();
+}
+
+// 加载文件
+bool BookLoader::Load(const string& file, const BuildFunc& build) {
+    typedef chrono::steady_clock Clock;
+    auto seconds = [](Clock::time_point from) {
+        return chrono::duration<double>(Clock::now() - from).count();
+    };
+
+    ifstream in(file, ios::in | ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    stats = Stats();
+    stats.threads = threads;
+    errors.clear();
+    Clock::time_point start = Clock::now();
+
+    BlockQueue queue(threads * 2);
+    vector<Run> runs;            // 每个数据块的解析结果, 按块序号存放
+    vector<bool> parsed;         // 对应的数据块是否已解析完
+    size_t running = threads;    // 尚未退出的解析线程数
+    mutex runsLock;
+    condition_variable runDone;  // 一个数据块解析完或一个解析线程退出
+    vector<double> parseSeconds(threads, 0);
+
+    // 阶段 1: 读取线程, 按块读取并在最后一个换行处切分, 剩余部分留给下一块
+    thread reader([&] {
+        string carry;
+        size_t index = 0;
+        vector<char> buffer(blockSize);
+        while (true) {
+            Clock::time_point t = Clock::now();
+            in.read(buffer.data(), (streamsize) buffer.size());
+            size_t got = (size_t) in.gcount();
+            stats.readSeconds += seconds(t);
+            if (got == 0) {
+                break;
+            }
+            stats.bytes += got;
+            carry.append(buffer.data(), got);
+            size_t cut = carry.rfind('\n');
+            if (cut == string::npos) {
+                continue;  // 块内没有完整的行, 继续读取
+            }
+            Block block{index++, carry.substr(0, cut + 1)};
+            carry.erase(0, cut + 1);
+            queue.Push(move(block));
+        }
+        if (!carry.empty()) {  // 文件末尾没有换行的最后一行
+            queue.Push(Block{index++, move(carry)});
+        }
+        stats.blocks = index;
+        queue.Close();
+    });
+
+    // 阶段 2: 解析线程池, 并行解码数据块
+    vector<thread> parsers;
+    for (size_t i = 0; i < threads; ++i) {
+        parsers.emplace_back([&, i] {
+            Block block;
+            while (queue.Pop(block)) {
+                Clock::time_point t = Clock::now();
+                Run run;
+                ParseBlock(block.data, run);
+                parseSeconds[i] += seconds(t);
+                lock_guard<mutex> guard(runsLock);
+                if (runs.size() <= block.index) {
+                    runs.resize(block.index + 1);
+                    parsed.resize(block.index + 1);
+                }
+                runs[block.index] = move(run);
+                parsed[block.index] = true;
+                runDone.notify_one();
+            }
+            lock_guard<mutex> guard(runsLock);
+            --running;
+            runDone.notify_one();
+        });
+    }
+
+    // 阶段 3: 调用线程按块序号拼接各段有序序列, 下一块尚未解析完时等待
+    vector<Book> books;
+    size_t next = 0;        // 下一个要拼接的块序号
+    size_t lineOffset = 0;  // 当前块之前的总行数, 用于把错误行号换算为文件中的行号
+    unique_lock<mutex> guard(runsLock);
+    while (true) {
+        runDone.wait(guard, [&] { return (next < parsed.size() && parsed[next]) || running == 0; });
+        if (next >= parsed.size() || !parsed[next]) {
+            break;  // 解析线程都已退出, 所有块都已拼接
+        }
+        Run run = move(runs[next++]);
+        guard.unlock();  // 拼接时不持锁, 解析线程可以继续登记结果
+        Clock::time_point t = Clock::now();
+        books.insert(books.end(), make_move_iterator(run.books.begin()),
+                     make_move_iterator(run.books.end()));
+        for (RecordParser::Error& e : run.errors) {
+            e.line += lineOffset;
+            errors.push_back(move(e));
+        }
+        lineOffset += run.lines;
+        stats.mergeSeconds += seconds(t);
+        guard.lock();
+    }
+    guard.unlock();
+    reader.join();
+    for (thread& t : parsers) {
+        t.join();
+    }
+    for (double s : parseSeconds) {
+        stats.parseSeconds += s;
+    }
+
+    // 阶段 4: 交给调用者批量建树
+    Clock::time_point t = Clock::now();
+    stats.records = books.size();
+    build(books);
+    stats.buildSeconds = seconds(t);
+    stats.totalSeconds = seconds(start);
+    return true;
+}
+
+// 获取最近一次加载的统计
+const BookLoader::Stats& BookLoader::GetStats() const {
+    return stats;
+}
+
+// 获取最近一次加载中格式错误的行
+const vector<RecordParser::Error>& BookLoader::GetErrors() const {
+    return errors;
+}
+
+// 输出最近一次加载的各阶段耗时
+void BookLoader::PrintStats(ostream& out, size_t maxErrors) const {
+    out << "加载 " << stats.records << " 本图书 (" << stats.blocks << " 块, "
+        << stats.threads << " 个解析线程): "
+        << "读取 " << stats.readSeconds * 1000 << " ms, "
+        << "解析 " << stats.parseSeconds * 1000 << " ms (各线程合计), "
+        << "拼接 " << stats.mergeSeconds * 1000 << " ms, "
+        << "建树 " << stats.buildSeconds * 1000 << " ms, "
+        << "总计 " << stats.totalSeconds * 1000 << " ms" << endl;
+    for (size_t i = 0; i < errors.size() && i < maxErrors; ++i) {
+        out << "第 " << errors[i].line << " 行格式错误 (已跳过): " << errors[i].message << endl;
+    }
+    if (errors.size() > maxErrors) {
+        out << "另有 " << errors.size() - maxErrors << " 行格式错误" << endl;
+    }
+}
@@ -1,46 +1,100 @@
 #include "bookManager.h"
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 #include "rbTree.h"
+#include "bookSnapshot.h"
+#include "bookLoader.h"
+#include "durableFile.h"
 using namespace std;
 
 // 使用构造函数
-BookManager::BookManager()  : currentMaxId(0) {
+BookManager::BookManager()  : currentMaxId(0), frozenValid(false), freezeCancel(false), freezeDone(false),
+                               sharedReads(false) {
     LoadMaxId("../data/book_max_id.txt");
 }
 
 // 使用析构函数
 BookManager::~BookManager() {
+    _invalidateFrozen();  // 等待后台重建线程结束
     UpdateMaxId("../data/book_max_id.txt");
 }
 
 // 初始化图书数据
-void BookManager::Init(string path,string fileType) {
+BookManager::Status BookManager::Init(string path,string fileType) {
     // 拼接文件路径
     string file = path + fileType;
+    string logFile = path + ".log";
+    if (!ifstream(file).is_open()) {
+        // 日志以检查点声明接续的是该文件: 快照写出后又丢失, 任何旧数据加上日志都不是正确的图书数据
+        if (OpLog::BaseType(logFile) == fileType) {
+            cout << "数据文件缺失: " << file << ", 但操作日志接续的是该文件, 拒绝加载" << endl;
+            return IoError;
+        }
+        // 二进制快照尚不存在时, 从同名的文本文件导入 (下一次压缩时会写出二进制快照)
+        if (fileType == ".bin" && ifstream(path + ".txt").is_open()) {
+            // 留有压缩的临时文件说明快照曾在写出过程中, 文本文件可能已过时
+            if (ifstream(path + ".temp").is_open()) {
+                cout << "数据文件缺失: " << file << ", 且存在未完成的临时文件 " << path << ".temp, 拒绝退回加载 "
+                     << path << ".txt" << endl;
+                return IoError;
+            }
+            file = path + ".txt";
+        }
+    }
+
+    // 根据文件头判断格式: 二进制快照直接按原形状重建, 否则按文本格式解析
+    _invalidateFrozen();
+    if (BookSnapshot::IsSnapshot(file)) {
+        int savedMaxId = 0;
+        if (!BookSnapshot::Read(file, libraryManager, savedMaxId)) {
+            // 不能以空树继续: 之后的日志压缩会用空快照覆盖原文件, 因此保留文件原样并放弃初始化
+            cout << "快照文件已损坏: " << file << ", 拒绝加载" << endl;
+            return IoError;
+        }
+        currentMaxId = max(currentMaxId, savedMaxId);
+    } else {
+        _loadText(file);
+    }
+    _rebuildIndexes();  // 建立书目表和 ISBN 二级索引
+
+    // 回放快照之后的操作日志, 然后以追加模式打开日志
+    dataPath = path;
+    dataType = fileType;
+    bool replayed = opLog.Replay(logFile, [this](OpLog::OpType type, const Book& b, const string& ISBN) {
+        _applyLog(type, b, ISBN);
+    });
+    if (!replayed) {
+        // 不能跳过损坏的记录继续: 之后的记录依赖它, 压缩时会把不完整的数据写成快照
+        cout << "操作日志已损坏: " << logFile << ", 拒绝加载" << endl;
+        return IoError;
+    }
+    if (!opLog.Open(logFile)) {
+        cout << "无法打开操作日志: " << logFile << endl;
+        return IoError;
+    }
+    return _commit();  // 回放的记录过多时立即压缩
+}
 
-    ifstream in;
-    // 尝试以读取模式打开文件
-    in.open(file, ios::in);
-    // 如果文件无法打开
-    if (!in.is_open()) {
-        // 如果文件不存在，则创建文件并打开
+// 从文本文件加载图书
+void BookManager::_loadText(const string& file) {
+    // 如果文件不存在，则创建空文件
+    if (!ifstream(file).is_open()) {
         ofstream out;
         out.open(file, ios::out | ios::app); // 以追加模式打开
         out.close();  // 创建文件后立即关闭
-        // 再次尝试以读取模式打开文件
-        in.open(file, ios::in);
     }
 
-    Book book;
-    // 读取文件内容，直到文件末尾
-    while (in.peek() != EOF) {  // 使用 peek 检查文件末尾
-        in >> book;  // 通过流读取每个 Book 对象
-        libraryManager.insertUnique(libraryManager.end(), book);  // 插入到图书管理容器中
-    }
-
-    // 关闭文件
-    in.close();
+    // 读取与解析由加载器的流水线并行完成, 最后按文件顺序交给红黑树
+    // Save 总是按编号顺序写出, 因此通常可以线性批量建树; 若文件被手动改乱则自动退化为逐个插入
+    BookLoader loader;
+    loader.Load(file, [this](vector<Book>& books) {
+        libraryManager.buildUnique(books.begin(), books.end());
+    });
+    loader.PrintStats(cout);
 }
 
 // 加载图书最大ID
@@ -69,190 +123,1082 @@ void BookManager::UpdateMaxId(string filePath) {
     }
 }
 
-// 添加书籍到图书馆
-void BookManager::Insert() {
-    string ISBN, name, author, publisher;
-    int year, count;
+// 按编号查找
+BookManager::BookRef BookManager::_findBook(int id) {
+    if (!sharedReads && freezeDone.load(memory_order_acquire)) {  // 共享读模式下由提交时接管
+        _adoptFrozen();
+    }
+    if (!frozenValid) {
+        return libraryManager.find(id);
+    }
+    const BookRef* ref = frozen.find(id);
+    return ref != nullptr ? *ref : libraryManager.end();
+}
 
-    cout << "请输入ISBN编号: ";
-    cin >> ISBN;
+// 主索引即将增删书籍, 冻结索引失效
+void BookManager::_invalidateFrozen() {
+    if (freezer.joinable()) {
+        freezeCancel.store(true, memory_order_relaxed);
+        freezer.join();
+        freezeDone.store(false, memory_order_relaxed);
+        freezing.clear();
+    }
+    if (frozenValid) {
+        frozen.clear();
+        frozenValid = false;
+    }
+}
 
-    cout << "请输入图书名称: ";
-    cin >> name;
+// 按需启动冻结索引的后台重建
+void BookManager::_scheduleFreeze() {
+    if (freezeDone.load(memory_order_acquire)) {
+        _adoptFrozen();
+    }
+    if (frozenValid || freezer.joinable() || libraryManager.size() < FreezeMinBooks) {
+        return;
+    }
+    freezeCancel.store(false, memory_order_relaxed);
+    size_t n = libraryManager.size();
+    freezer = thread([this, n] {
+        // 按编号顺序遍历主索引, 主线程在本线程结束前不会增删书籍
+        BookRef it = libraryManager.begin();
+        bool built = freezing.build(n, [this, &it](int& id, BookRef& ref) {
+            if (freezeCancel.load(memory_order_relaxed)) {
+                return false;
+            }
+            id = it->GetId();
+            ref = it++;
+            return true;
+        });
+        freezeDone.store(built, memory_order_release);
+    });
+}
 
-    cout << "请输入作者: ";
-    cin >> author;
+// 接管后台构造完成的冻结索引
+void BookManager::_adoptFrozen() {
+    freezer.join();
+    freezeDone.store(false, memory_order_relaxed);
+    frozen.swap(freezing);
+    freezing.clear();
+    frozenValid = true;
+}
 
-    cout << "请输入出版社: ";
-    cin >> publisher;
+// 插入一本书并登记到 ISBN 索引
+BookManager::BookRef BookManager::_insertBook(const Book& book) {
+    BookRef it = _findBook(book.GetId());
+    if (it != libraryManager.end()) {  // 编号重复, 返回已有的书
+        return it;
+    }
+    // 副本只保存编号和借阅信息, 描述信息引用书目表中的 Title
+    Book copy(book.GetId(), _internTitle(*book.GetTitle()), book.GetBorrowStatus(), book.GetBorrower());
+    _invalidateFrozen();
+    it = libraryManager.insertUnique(libraryManager.end(), move(copy));  // 移入节点, 不再复制借阅人等字段
+    _indexISBN(it);
+    if (it->GetBorrowStatus()) {
+        lendIndex.insertUnique(it);
+    }
+    columns.Put(*it);
+    yearIndex.Insert(it->GetYear(), it->GetId(), it->GetBorrowStatus());
+    return it;
+}
 
-    cout << "请输入出版年份: ";
-    cin >> year;
+// 删除一本书, 同时从 ISBN 索引中移除
+void BookManager::_eraseBook(BookRef it) {
+    string ISBN = it->GetISBN();  // 删除后 it 失效, 先保存 ISBN
+    _unindexISBN(it);
+    _setBorrowed(it, false, "");  // 从借出索引中移除
+    columns.Remove(it->GetId());
+    yearIndex.Erase(it->GetYear(), it->GetId());
+    _invalidateFrozen();
+    libraryManager.erase(it);
+    _releaseTitle(ISBN);
+}
 
-    cout << "请输入图书数量: ";
-    cin >> count;
+// 将一本书登记到 ISBN 索引
+void BookManager::_indexISBN(BookRef it) {
+    isbnIndex.insertEqual(it);
+}
 
-    cout << "请确认图书信息（输入y/yes确认）: " << endl
-         << "ISBN: " << ISBN << "  图书名称: " << name
-         << "  作者: " << author << "  出版社: " << publisher
-         << "  出版年份: " << year << "  数量: " << count << "\n> ";
+// 从 ISBN 索引中移除一本书
+void BookManager::_unindexISBN(BookRef it) {
+    // 在相同 ISBN 的副本中找到指向这本书的索引项
+    auto range = isbnIndex.equalRange(it->GetISBN());
+    for (auto ref = range.first; ref != range.second; ++ref) {
+        if (*ref == it) {
+            isbnIndex.erase(ref);
+            return;
+        }
+    }
+}
 
-    string confirm;
-    cin.get();  // 清除上一次输入的换行符
-    getline(cin, confirm);  // 获取用户的确认输入
+// 在书目表中登记描述信息
+shared_ptr<const Title> BookManager::_internTitle(const Title& title) {
+    auto it = titles.find(title.GetISBN());
+    if (it == titles.end()) {  // 新的 ISBN
+        textIndex.Put(title);
+        _indexPrefix(title);
+        return *titles.insertUnique(make_shared<const Title>(title)).first;
+    }
+    if (**it != title) {  // 描述信息以最后一次写入为准
+        _replaceTitle(it, title);
+    }
+    return *it;
+}
 
-    // 如果用户确认，开始添加图书
-    if (confirm == "y" || confirm == "yes") {
-        // 根据数量逐个添加图书
-        while (count--) {
-            libraryManager.insertUnique(libraryManager.end(),
-                                        Book(currentMaxId + 1, ISBN, name,
-                                             author, publisher, year, false, ""));
-            currentMaxId++;
-        }
-        cout << "添加成功" << endl;
-    } else {
-        cout << "添加已取消" << endl;
+// 以新的 Title 替换书目表中的一项, 该 ISBN 的所有副本改为引用新 Title
+void BookManager::_replaceTitle(TitleTable::iterator it, const Title& title) {
+    // 已共享出去的 Title 不再修改: 之前返回的 Book (可能正被其他线程读取) 仍引用原 Title
+    int oldYear = (*it)->GetYear();
+    _unindexPrefix(**it);
+    *it = make_shared<const Title>(title);
+    auto range = isbnIndex.equalRange(title.GetISBN());
+    for (auto ref = range.first; ref != range.second; ++ref) {
+        (*ref)->SetTitle(*it);
     }
+    _indexPrefix(title);
+    textIndex.Put(title);
+    _refreshCopies(title.GetISBN(), oldYear);
+}
 
-    cout << "是否继续添加？（输入y/yes继续;输入n/no取消）\n> ";
-    getline(cin, confirm);
+// 该 ISBN 已没有副本时, 从书目表中移除
+void BookManager::_releaseTitle(const string& ISBN) {
+    // 以 ISBN 索引判断是否还有副本 (调用者须先移出索引); 不能看 Title 的引用计数,
+    // 查询返回的 Book 副本也持有引用, 调用者可以任意长时间保留它们
+    auto it = titles.find(ISBN);
+    if (it != titles.end() && isbnIndex.find(ISBN) == isbnIndex.end()) {
+        _unindexPrefix(**it);
+        titles.erase(it);
+        textIndex.Remove(ISBN);
+    }
+}
 
-    if (confirm == "y" || confirm == "yes") {
-        Insert();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
+// 按 book 更新已有的副本
+void BookManager::_putBook(BookRef it, const Book& book) {
+    if (it->GetISBN() != book.GetISBN()) {  // ISBN 变化, 改为引用新 ISBN 的描述信息并重新登记索引
+        string oldISBN = it->GetISBN();
+        int oldYear = it->GetYear();
+        _unindexISBN(it);
+        it->SetTitle(_internTitle(*book.GetTitle()));
+        _indexISBN(it);
+        _releaseTitle(oldISBN);
+        _refreshCopy(it, oldYear);
+    } else if (it->GetTitle() != book.GetTitle()) {
+        _internTitle(*book.GetTitle());  // 原地修改共享的描述信息
     }
+    _setBorrowed(it, book.GetBorrowStatus(), book.GetBorrower());
 }
 
-// 检查图书馆是否为空
-bool BookManager::Empty() {
-    return libraryManager.empty();
+// 设置一本书的借阅状态, 同时维护借出索引
+void BookManager::_setBorrowed(BookRef it, bool borrowed, const string& borrower) {
+    if (borrowed && !it->GetBorrowStatus()) {  // 借出
+        lendIndex.insertUnique(it);
+    } else if (!borrowed && it->GetBorrowStatus()) {  // 归还
+        lendIndex.erase(lendIndex.find(it->GetId()));
+    }
+    if (borrowed != it->GetBorrowStatus()) {
+        columns.SetBorrowed(it->GetId(), borrowed);
+        yearIndex.SetBorrowed(it->GetYear(), it->GetId(), borrowed);
+    }
+    it->SetBorrowStatus(borrowed);
+    it->SetBorrower(borrower);
 }
 
-// 分页查询所有书籍，currPage 为当前页码，pageSize 为每页显示数量
-void BookManager::FindByPage(int currPage, int pageSize) {
-    size_t size = libraryManager.size(); // 获取图书总数
-    size_t totalPages = (size - 1) / pageSize + 1; // 计算总页数
+// 将书目登记到书名和作者的前缀索引
+void BookManager::_indexPrefix(const Title& title) {
+    namePrefix.Insert(title.GetName(), title.GetISBN());
+    authorPrefix.Insert(title.GetAuthor(), title.GetISBN());
+}
+
+// 从书名和作者的前缀索引中移除书目
+void BookManager::_unindexPrefix(const Title& title) {
+    namePrefix.Erase(title.GetName(), title.GetISBN());
+    authorPrefix.Erase(title.GetAuthor(), title.GetISBN());
+}
+
+// 描述信息变化后刷新一本书在列式存储和年份索引中的记录
+void BookManager::_refreshCopy(BookRef it, int oldYear) {
+    columns.Put(*it);
+    if (it->GetYear() != oldYear) {  // 年份索引的键值变化, 按原年份移除后重新登记
+        yearIndex.Erase(oldYear, it->GetId());
+        yearIndex.Insert(it->GetYear(), it->GetId(), it->GetBorrowStatus());
+    }
+}
+
+// 按 ISBN 索引刷新该 ISBN 的所有副本
+void BookManager::_refreshCopies(const string& ISBN, int oldYear) {
+    auto range = isbnIndex.equalRange(ISBN);
+    for (auto ref = range.first; ref != range.second; ++ref) {
+        _refreshCopy(*ref, oldYear);
+    }
+}
+
+// 修改一个 ISBN 的描述信息
+void BookManager::_retitle(const string& ISBN, const Title& title) {
+    auto it = titles.find(ISBN);
+    if (it == titles.end()) {
+        return;
+    }
+    if (title.GetISBN() == ISBN) {  // ISBN 不变, 换用新的描述信息
+        _replaceTitle(it, title);
+        return;
+    }
 
-    // 检查输入的页码是否合法
-    if (currPage < 0 || currPage > totalPages) {
-        cout << "输入的页码不正确，请重新输入（输入0退出）\n> ";
-        if (cin >> currPage && currPage) { // 如果输入合法且不为0，递归调用
-            FindByPage(currPage, pageSize);
+    // ISBN 变化: 书目表和 ISBN 索引的键值都会改变, 先将该 ISBN 的副本全部移出
+    int oldYear = (*it)->GetYear();
+    _unindexPrefix(**it);
+    titles.erase(it);
+    vector<BookRef> copies;
+    auto range = isbnIndex.equalRange(ISBN);
+    for (auto ref = range.first; ref != range.second; ++ref) {
+        copies.push_back(*ref);
+    }
+    isbnIndex.erase(range.first, range.second);
+
+    // 原 Title 可能仍被查询返回的 Book 引用, 不修改它, 副本改为引用新 ISBN 的 Title
+    textIndex.Remove(ISBN);
+    auto target = titles.find(title.GetISBN());
+    if (target == titles.end()) {  // 新 ISBN 不存在, 登记新的 Title
+        target = titles.insertUnique(make_shared<const Title>(title)).first;
+        textIndex.Put(title);
+        _indexPrefix(title);
+    } else {  // 新 ISBN 已存在, 副本并入已有的书目 (已有的副本随之换用新的描述信息)
+        _replaceTitle(target, title);
+    }
+    for (BookRef copy : copies) {
+        copy->SetTitle(*target);
+        _indexISBN(copy);
+        _refreshCopy(copy, oldYear);
+    }
+}
+
+// 由主索引重建书目表和 ISBN 索引
+void BookManager::_rebuildIndexes() {
+    titles.clear();
+    isbnIndex.clear();
+    lendIndex.clear();
+    vector<BookRef> refs, lent;
+    refs.reserve(libraryManager.size());
+    for (BookRef it = libraryManager.begin(); it != libraryManager.end(); ++it) {
+        refs.push_back(it);
+        if (it->GetBorrowStatus()) {
+            lent.push_back(it);  // 按编号顺序遍历, 借出的书天然有序
+        }
+    }
+    lendIndex.buildUnique(lent.begin(), lent.end());
+    // 按 ISBN 稳定排序, 同一 ISBN 的副本保持编号顺序
+    stable_sort(refs.begin(), refs.end(), [](const BookRef& a, const BookRef& b) {
+        return a->GetISBN() < b->GetISBN();
+    });
+
+    // 每个 ISBN 只保留一份描述信息 (以编号最小的副本为准), 其余副本改为共享它
+    vector<shared_ptr<const Title>> table;
+    for (BookRef ref : refs) {
+        if (table.empty() || table.back()->GetISBN() != ref->GetISBN()) {
+            table.push_back(make_shared<const Title>(*ref->GetTitle()));
         }
-        return; // 退出当前调用
+        ref->SetTitle(table.back());
     }
 
-    // 计算当前页的起始索引
-    int firstIndex = (currPage - 1) * pageSize;
-    auto it = libraryManager.begin();
-    while (firstIndex--) {
-        ++it; // 将迭代器移动到当前页的起始位置
+    // 两者都已按 ISBN 有序, 线性批量建树
+    titles.buildUnique(table.begin(), table.end());
+    isbnIndex.buildEqual(refs.begin(), refs.end());
+
+    textIndex.Clear();
+    namePrefix.Clear();
+    authorPrefix.Clear();
+    for (const shared_ptr<const Title>& title : table) {
+        textIndex.Put(*title);
+        _indexPrefix(*title);
     }
 
-    // 输出当前页的图书信息
-    cout << "-------------------------------" << endl;
-    int n = pageSize;
-    while (n-- && it != libraryManager.end()) {
-        cout << *(it++) << endl;
+    // 列式存储和年份索引在描述信息共享之后建立 (各副本的年份等已以共享的 Title 为准)
+    columns.Clear();
+    columns.Reserve(libraryManager.size());
+    vector<YearIndex::Item> years;
+    years.reserve(libraryManager.size());
+    for (BookRef it = libraryManager.begin(); it != libraryManager.end(); ++it) {
+        columns.Put(*it);  // 按编号顺序遍历, 每一行都追加到末尾
+        years.push_back({it->GetYear(), it->GetId(), it->GetBorrowStatus()});
     }
-    cout << "-------------------------------" << endl;
+    yearIndex.Build(years);
+}
 
-    // 提示用户当前所在页，并允许跳转到其他页
-    cout << "当前为第 " << currPage << " 页，共 " << totalPages
-         << " 页，请输入跳转页码（输入0退出）\n> ";
-    if (cin >> currPage && currPage) {
-        FindByPage(currPage, pageSize); // 递归调用以跳转到指定页码
+// 读出待导入文件中的书
+bool BookManager::_readImport(const string& file, vector<Book>& books, ostream& progress) {
+    if (BookSnapshot::IsSnapshot(file)) {
+        // 快照按树的形状保存, 先原样重建到临时树中, 再按编号顺序取出
+        RbTree staged;
+        int savedMaxId;
+        if (!BookSnapshot::Read(file, staged, savedMaxId)) {
+            progress << "快照文件已损坏: " << file << endl;
+            return false;
+        }
+        books.reserve(staged.size());
+        for (BookRef it = staged.begin(); it != staged.end(); ++it) {
+            books.push_back(*it);
+        }
+        return true;
+    }
+    // 文本格式由加载器的流水线并行解析, 结果按文件顺序交回
+    BookLoader loader;
+    if (!loader.Load(file, [&books](vector<Book>& parsed) { books.swap(parsed); })) {
+        return false;
     }
+    loader.PrintStats(progress);
+    return true;
 }
 
-// 根据书籍编号查找书籍
-void BookManager::FindByID() {
-    int id;
-    cout << "请输入要查找的图书ID: "; // 提示用户输入图书ID
-    cin >> id;
+// 把一批新书整体接到主索引之后
+BookManager::BookRef BookManager::_appendBooks(const vector<Book>& books) {
+    _invalidateFrozen();
+#ifdef BOOK_INDEX_BTREE
+    // B+ 树没有整体连接, 以 end() 为提示依次追加到最后一个叶子节点
+    for (const Book& book : books) {
+        libraryManager.insertUnique(libraryManager.end(), book);
+    }
+#else
+    // 编号连续递增, 先线性建树, 再以 O(log n) 的连接接到已有的书之后
+    RbTree batch;
+    batch.buildUnique(books.begin(), books.end());
+    libraryManager.join(batch);
+#endif
+    return libraryManager.find(books.front().GetId());
+}
+
+// 把导入的副本登记到 ISBN 索引和年份索引
+void BookManager::_indexImported(const vector<BookRef>& added) {
+    if (added.size() * ImportRebuildRatio < libraryManager.size() - added.size()) {  // 导入的较少, 逐个登记
+        for (BookRef it : added) {
+            _indexISBN(it);
+            yearIndex.Insert(it->GetYear(), it->GetId(), false);
+        }
+        return;
+    }
+    // ISBN 索引: 新副本按 ISBN 稳定排序后与已有的索引项线性归并, 相同 ISBN 时已有的副本 (编号较小) 在前
+    vector<BookRef> sorted(added);
+    stable_sort(sorted.begin(), sorted.end(), [](const BookRef& a, const BookRef& b) {
+        return a->GetISBN() < b->GetISBN();
+    });
+    vector<BookRef> merged;
+    merged.reserve(isbnIndex.size() + sorted.size());
+    auto old = isbnIndex.begin();
+    for (BookRef ref : sorted) {
+        while (old != isbnIndex.end() && (*old)->GetISBN() <= ref->GetISBN()) {
+            merged.push_back(*(old++));
+        }
+        merged.push_back(ref);
+    }
+    for (; old != isbnIndex.end(); ++old) {
+        merged.push_back(*old);
+    }
+    isbnIndex.clear();
+    isbnIndex.buildEqual(merged.begin(), merged.end());
+
+    // 年份索引: 由主索引重新批量构造
+    vector<YearIndex::Item> years;
+    years.reserve(libraryManager.size());
+    for (BookRef it = libraryManager.begin(); it != libraryManager.end(); ++it) {
+        years.push_back({it->GetYear(), it->GetId(), it->GetBorrowStatus()});
+    }
+    yearIndex.Build(years);
+}
 
-    auto it = libraryManager.find(id); // 根据ID查找图书
-    if (it != libraryManager.end()) {
-        cout << *it << endl; // 如果找到，输出图书信息
+// 回放一条日志记录
+void BookManager::_applyLog(OpLog::OpType type, const Book& book, const string& ISBN) {
+    if (type == OpLog::Retitle) {
+        _retitle(ISBN, *book.GetTitle());
+        return;
+    }
+    BookRef it = _findBook(book.GetId());
+    if (type == OpLog::Remove) {
+        if (it != libraryManager.end()) {
+            _eraseBook(it);
+        }
+        return;
+    }
+    if (it == libraryManager.end()) {  // 新增的书
+        _insertBook(book);
     } else {
-        cout << "该图书ID不存在" << endl; // 如果未找到，提示用户
+        _putBook(it, book);
+    }
+    if (book.GetId() > currentMaxId) {  // 恢复最大编号
+        currentMaxId = book.GetId();
     }
+}
 
-    // 提示用户是否继续查找
-    cout << "是否继续查找？（输入y/yes继续）\n> ";
+// 提交本次操作产生的日志记录
+BookManager::Status BookManager::_commit() {
+    Status status = Ok;
+    bool compact = opLog.IsOpen() && opLog.RecordCount() > max(CompactMinRecords, libraryManager.size());
+    if (!opLog.Commit()) {
+        compact = true;  // 日志写入失败时修改只在内存中, 立即写快照补救
+    }
+    if (compact && (status = Save(dataPath, dataType)) != Ok) {  // 压缩为新快照
+        cout << StatusText(status) << endl;
+    }
+    _scheduleFreeze();  // 一批修改已提交, 在后台重建冻结索引
+    return status;
+}
+
+// 状态码对应的提示信息
+const char* BookManager::StatusText(Status status) {
+    switch (status) {
+        case Ok:
+            return "成功";
+        case NotFound:
+            return "没有找到该书籍";
+        case Borrowed:
+            return "该书籍已经被借出";
+        case NotBorrowed:
+            return "该书籍未借出";
+        case Invalid:
+            return "参数不合法";
+        case IoError:
+            return "无法打开文件!请重试!";
+    }
+    return "未知错误";
+}
+
+// 询问是否继续当前操作
+bool BookManager::_askContinue(const string& prompt, bool verbose) {
+    cout << prompt;
     string confirm;
-    cin.get(); // 清除上一次输入的换行符
-    getline(cin, confirm); // 获取用户确认输入
+    getline(cin, confirm);
     if (confirm == "y" || confirm == "yes") {
-        FindByID(); // 递归调用以继续查找
+        return true;
     }
+    if (verbose) {
+        if (confirm == "n" || confirm == "no") {
+            cout << "取消操作成功" << endl;
+        } else {
+            cout << "无效输入，请重新输入!" << endl;
+        }
+    }
+    return false;
 }
 
-// 根据 ISBN 号查找书籍
-void BookManager::FindByISBN() {
-    string ISBN;
-    cout << "请输入要查询的ISBN号：";
-    cin >> ISBN;
+// 添加 count 本同一 ISBN 的副本
+BookManager::Status BookManager::Insert(const Title& title, int count, int& firstId) {
+    if (count <= 0) {
+        return Invalid;
+    }
+    // 所有副本共享同一份描述信息
+    shared_ptr<const Title> shared = _internTitle(title);
+    firstId = currentMaxId + 1;
+    while (count--) {
+        opLog.AppendPut(*_insertBook(Book(currentMaxId + 1, shared, false, "")));
+        currentMaxId++;
+    }
+    return Ok;
+}
 
-    bool find = false; // 表示是否找到书籍
-    int inCount = 0, outCount = 0; // 记录馆内和借出的书籍数量
-    auto it = libraryManager.begin(); // 初始化迭代器
-    while (it != libraryManager.end()) {
-        if (it->GetISBN() == ISBN) { // 如果找到ISBN匹配的书籍
-            if (!find) { // 如果是第一次找到，输出书籍信息
-                cout << "ISBN: " << it->GetISBN()
-                     << "  书名: " << it->GetName()
-                     << "  作者: " << it->GetAuthor()
-                     << "  出版社: " << it->GetPublisher()
-                     << "  出版年份: " << it->GetYear() << endl;
-                find = true; // 标记为已经找到
+// 导入外部文件中的图书
+BookManager::Status BookManager::Import(const string& file, bool dedupe, ImportStats& stats, ostream& progress) {
+    using Clock = chrono::steady_clock;
+    auto seconds = [](Clock::time_point since) { return chrono::duration<double>(Clock::now() - since).count(); };
+    // 吞吐量 (百万本/秒)
+    auto rate = [](size_t n, double sec) { return sec > 0 ? n / sec / 1e6 : 0.0; };
+    stats = ImportStats();
+    Clock::time_point start = Clock::now();
+
+    // 1. 读取与解析
+    vector<Book> incoming;
+    if (!_readImport(file, incoming, progress)) {
+        return IoError;
+    }
+    stats.records = incoming.size();
+    stats.readSeconds = seconds(start);
+    progress << "读取 " << stats.records << " 条记录: " << stats.readSeconds * 1000 << " ms ("
+             << rate(stats.records, stats.readSeconds) << " M 条/s)" << endl;
+
+    // 2. 按文件顺序重新编号, 同一 ISBN 的副本共享一个 Title
+    Clock::time_point mergeStart = Clock::now();
+    int lastId = libraryManager.empty() ? 0 : libraryManager.select(libraryManager.size() - 1)->GetId();
+    int nextId = max(currentMaxId, lastId) + 1;  // 新编号都大于已有编号, 整批排在主索引末尾
+    unordered_map<string, shared_ptr<const Title>> shared;  // ISBN -> 共享的描述信息, 为空表示跳过该 ISBN
+    vector<Book> copies;
+    copies.reserve(incoming.size());
+    for (const Book& book : incoming) {
+        auto found = shared.find(book.GetISBN());
+        if (found == shared.end()) {  // 本次导入中第一次出现的 ISBN
+            auto existing = titles.find(book.GetISBN());
+            shared_ptr<const Title> title;
+            if (existing == titles.end()) {
+                title = _internTitle(*book.GetTitle());
+                ++stats.newTitles;
+            } else if (!dedupe) {
+                title = *existing;
             }
-            if (it->GetBorrowStatus()) { // 如果书籍已经被借出
-                cout << "书籍ID: " << it->GetId()
-                     << "  借阅者: " << it->GetBorrower() << endl;
-                ++outCount; // 借出的书籍数量加1
+            found = shared.emplace(book.GetISBN(), move(title)).first;
+        }
+        if (found->second == nullptr) {
+            ++stats.skipped;
+            continue;
+        }
+        copies.emplace_back(nextId++, found->second, false, "");
+    }
+    incoming.clear();
+    incoming.shrink_to_fit();
+
+    // 3. 整批并入主索引, 然后登记日志、列式存储和二级索引 (借出索引不变: 导入的副本都在库)
+    if (!copies.empty()) {
+        // 记录数会超过压缩阈值时, 提交时必然压缩为新快照, 不必逐本写日志, 直接写快照
+        size_t total = libraryManager.size() + copies.size();
+        bool snapshot = opLog.IsOpen() && opLog.RecordCount() + copies.size() > max(CompactMinRecords, total);
+        BookRef it = _appendBooks(copies);
+        vector<BookRef> added;
+        added.reserve(copies.size());
+        columns.Reserve(libraryManager.size());
+        for (; it != libraryManager.end(); ++it) {
+            added.push_back(it);
+            columns.Put(*it);  // 编号都大于已有的行, 追加到末尾
+            if (!snapshot) {
+                opLog.AppendPut(*it);
+            }
+            if (added.size() % ImportProgressInterval == 0) {
+                progress << "已登记 " << added.size() << " / " << copies.size() << " 本" << endl;
+            }
+        }
+        _indexImported(added);
+        currentMaxId = nextId - 1;
+        if (snapshot && Save(dataPath, dataType) != Ok) {  // 快照写入失败时退回逐本写日志
+            for (BookRef ref : added) {
+                opLog.AppendPut(*ref);
+            }
+        }
+    }
+    stats.imported = copies.size();
+    stats.mergeSeconds = seconds(mergeStart);
+    stats.totalSeconds = seconds(start);
+    progress << "导入 " << stats.imported << " 本 (新书目 " << stats.newTitles << " 个, 跳过 " << stats.skipped
+             << " 本): 合并 " << stats.mergeSeconds * 1000 << " ms ("
+             << rate(stats.imported, stats.mergeSeconds) << " M 本/s), 总计 " << stats.totalSeconds * 1000
+             << " ms" << endl;
+    return Ok;
+}
+
+// 根据书籍编号查找
+BookManager::Status BookManager::FindByID(int id, Book& book) {
+    auto it = _findBook(id);
+    if (it == libraryManager.end()) {
+        return NotFound;
+    }
+    book = *it;
+    return Ok;
+}
+
+// 根据 ISBN 查找所有副本
+vector<Book> BookManager::FindByISBN(const string& ISBN) {
+    vector<Book> result;
+    auto range = isbnIndex.equalRange(ISBN);  // 通过 ISBN 索引取得所有副本
+    for (auto ref = range.first; ref != range.second; ++ref) {
+        result.push_back(**ref);
+    }
+    return result;
+}
+
+// 取第 currPage 页的书籍
+vector<Book> BookManager::FindPage(size_t currPage, size_t pageSize) {
+    vector<Book> result;
+    if (currPage == 0 || pageSize == 0) {
+        return result;
+    }
+    // 按名次直接定位到当前页的第一本书, 页码越界时 select 返回 end
+    auto it = libraryManager.select((currPage - 1) * pageSize);
+    while (result.size() < pageSize && it != libraryManager.end()) {
+        result.push_back(*(it++));
+    }
+    return result;
+}
+
+// 取已借出书籍的第 currPage 页
+vector<Book> BookManager::FindLendPage(size_t currPage, size_t pageSize) {
+    vector<Book> result;
+    if (currPage == 0 || pageSize == 0) {
+        return result;
+    }
+    auto it = lendIndex.select((currPage - 1) * pageSize);
+    while (result.size() < pageSize && it != lendIndex.end()) {
+        result.push_back(**(it++));
+    }
+    return result;
+}
+
+// 按 book 更新编号相同的书籍
+BookManager::Status BookManager::UpdateByID(const Book& book) {
+    auto it = _findBook(book.GetId());
+    if (it == libraryManager.end()) {
+        return NotFound;
+    }
+    // ISBN 变化时改为引用新 ISBN 的描述信息, 否则修改共享的描述信息
+    _putBook(it, book);
+    opLog.AppendPut(*it);
+    return Ok;
+}
+
+// 修改一个 ISBN 的描述信息
+BookManager::Status BookManager::UpdateByISBN(const string& ISBN, const Title& title) {
+    if (titles.find(ISBN) == titles.end()) {
+        return NotFound;
+    }
+    // 所有副本共享同一份描述信息, 只需一次写入和一条日志记录
+    opLog.AppendRetitle(ISBN, title);
+    _retitle(ISBN, title);
+    return Ok;
+}
+
+// 根据书籍编号删除
+BookManager::Status BookManager::RemoveByID(int id) {
+    auto it = _findBook(id);
+    if (it == libraryManager.end()) {
+        return NotFound;
+    }
+    opLog.AppendRemove(id);
+    _eraseBook(it);
+    return Ok;
+}
+
+// 删除一个 ISBN 的所有副本
+BookManager::Status BookManager::RemoveByISBN(const string& ISBN, bool removeBorrowed) {
+    auto range = isbnIndex.equalRange(ISBN);
+    if (range.first == range.second) {
+        return NotFound;
+    }
+    // 只遍历索引中该 ISBN 的副本, 先从 ISBN 索引中移除要删除的副本, 再删除书籍本身
+    vector<BookRef> removed;
+    if (removeBorrowed) {  // 全部删除: 索引中的整段一次移除
+        for (auto ref = range.first; ref != range.second; ++ref) {
+            removed.push_back(*ref);
+        }
+        isbnIndex.erase(range.first, range.second);
+    } else {  // 跳过借出中的副本
+        for (auto ref = range.first; ref != range.second;) {
+            if ((*ref)->GetBorrowStatus()) {
+                ++ref;
             } else {
-                ++inCount; // 馆内书籍数量加1
+                removed.push_back(*ref);
+                isbnIndex.erase(ref++);
             }
         }
-        ++it; // 移动到下一本书
     }
-    if (find) {
-        cout << "共 " << inCount + outCount << " 本书  ";
-        if (outCount) {
-            cout << "其中借出: " << outCount << " 本书  ";
+    _invalidateFrozen();
+    for (BookRef book : removed) {
+        opLog.AppendRemove(book->GetId());
+        _setBorrowed(book, false, ""); // 从借出索引中移除
+        columns.Remove(book->GetId()); // 从列式存储中移除
+        yearIndex.Erase(book->GetYear(), book->GetId()); // 从年份索引中移除
+        libraryManager.erase(book); // 删除书籍
+    }
+    _releaseTitle(ISBN);  // 副本全部删除后移除书目
+    return Ok;
+}
+
+// 借出书籍
+BookManager::Status BookManager::Lend(int id, const string& borrower) {
+    auto it = _findBook(id);
+    if (it == libraryManager.end()) {
+        return NotFound;
+    }
+    if (it->GetBorrowStatus()) {
+        return Borrowed;
+    }
+    _setBorrowed(it, true, borrower); // 设置书籍为已借出, 并登记借阅者
+    opLog.AppendPut(*it);
+    return Ok;
+}
+
+// 归还书籍
+BookManager::Status BookManager::Return(int id) {
+    auto it = _findBook(id);
+    if (it == libraryManager.end()) {
+        return NotFound;
+    }
+    if (!it->GetBorrowStatus()) {
+        return NotBorrowed;
+    }
+    _setBorrowed(it, false, ""); // 设置书籍为未借出, 并清空借阅者信息
+    opLog.AppendPut(*it);
+    return Ok;
+}
+
+// 全文检索, 按相关度排列的书目依次展开为各自的副本后分页
+vector<Book> BookManager::Search(const string& text, size_t currPage, size_t pageSize, size_t& total) {
+    vector<Book> result;
+    total = 0;
+    vector<string> ranked = textIndex.Search(text);
+    size_t skip = currPage == 0 ? SIZE_MAX : (currPage - 1) * pageSize;  // 当前页之前的副本数
+    for (const string& ISBN : ranked) {
+        // 由名次得到该 ISBN 的副本个数: 键值小于 ISBN + '\0' 的即不大于 ISBN 的
+        size_t first = isbnIndex.rank(ISBN);
+        size_t count = isbnIndex.rank(ISBN + '\0') - first;
+        total += count;
+        if (skip >= count) {  // 整个书目都在当前页之前
+            skip -= count;
+            continue;
         }
-        cout << "馆内: " << inCount << " 本书" << endl;
-    } else {
-        cout << "没有找到该ISBN号的书籍" << endl;
+        for (auto ref = isbnIndex.select(first + skip); result.size() < pageSize && skip < count; ++ref, ++skip) {
+            result.push_back(**ref);
+        }
+        skip = result.size() < pageSize ? 0 : SIZE_MAX;  // 当前页已满时只累计总数
+    }
+    return result;
+}
+
+// 输入补全, 由前缀索引得到 ISBN 后到书目表中取描述信息
+vector<Title> BookManager::Suggest(const string& prefix, size_t k, bool byAuthor) {
+    vector<Title> result;
+    for (const string& ISBN : (byAuthor ? authorPrefix : namePrefix).Complete(prefix, k)) {
+        result.push_back(**titles.find(ISBN));
     }
+    return result;
+}
 
-    // 是否继续查询
-    cout << "是否继续查询？（输入y/yes继续;输入n/no取消）\n> ";
-    string confirm;
-    cin.get(); // 读取多余的换行符
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        FindByISBN();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
+// 出版年份区间内的书数
+void BookManager::CountByYear(int yearMin, int yearMax, size_t& available, size_t& borrowed) {
+    yearIndex.Count(yearMin, yearMax, available, borrowed);
+}
+
+// 出版年份区间内的书籍分页, 由年份索引按名次定位后到主索引中取书
+vector<Book> BookManager::FindByYear(int yearMin, int yearMax, size_t currPage, size_t pageSize) {
+    vector<Book> result;
+    if (currPage == 0 || pageSize == 0) {
+        return result;
+    }
+    for (int id : yearIndex.Range(yearMin, yearMax, (currPage - 1) * pageSize, pageSize)) {
+        result.push_back(*_findBook(id));
+    }
+    return result;
+}
+
+// 多条件筛选, 在列式存储中扫描得到编号后再到主索引中取书
+vector<Book> BookManager::FindWhere(const BookColumns::Query& query, size_t limit) {
+    vector<Book> result;
+    for (int id : columns.Select(query, limit)) {
+        result.push_back(*_findBook(id));
+    }
+    return result;
+}
+
+// 满足筛选条件的书籍数
+size_t BookManager::CountWhere(const BookColumns::Query& query) {
+    return columns.Count(query);
+}
+
+// 图书总数
+size_t BookManager::Size() {
+    return libraryManager.size();
+}
+
+// 已借出的图书数
+size_t BookManager::LendCount() {
+    return lendIndex.size();
+}
+
+// 开启或关闭共享读模式
+void BookManager::SetSharedReads(bool shared) {
+    sharedReads = shared;
+}
+
+// 添加书籍到图书馆
+void BookManager::Insert() {
+    do {
+        string ISBN, name, author, publisher;
+        int year, count;
+
+        cout << "请输入ISBN编号: ";
+        cin >> ISBN;
+
+        cout << "请输入图书名称: ";
+        cin >> name;
+
+        cout << "请输入作者: ";
+        cin >> author;
+
+        cout << "请输入出版社: ";
+        cin >> publisher;
+
+        cout << "请输入出版年份: ";
+        cin >> year;
+
+        cout << "请输入图书数量: ";
+        cin >> count;
+
+        cout << "请确认图书信息（输入y/yes确认）: " << endl
+             << "ISBN: " << ISBN << "  图书名称: " << name
+             << "  作者: " << author << "  出版社: " << publisher
+             << "  出版年份: " << year << "  数量: " << count << "\n> ";
+
+        string confirm;
+        cin.get();  // 清除上一次输入的换行符
+        getline(cin, confirm);  // 获取用户的确认输入
+
+        // 如果用户确认，开始添加图书
+        if (confirm == "y" || confirm == "yes") {
+            // 描述信息按 ISBN 共享, 该 ISBN 已有的副本会随之更新 (数量不为正时不修改书目)
+            Title title(ISBN, name, author, publisher, year);
+            auto existing = titles.find(ISBN);
+            if (count > 0 && existing != titles.end() && **existing != title) {
+                cout << "该ISBN已有副本, 其书名等信息将一并更新" << endl;
+            }
+            int firstId;
+            Insert(title, count, firstId);
+            _commit();  // 所有副本一次提交
+            cout << "添加成功" << endl;
+        } else {
+            cout << "添加已取消" << endl;
+        }
+    } while (_askContinue("是否继续添加？（输入y/yes继续;输入n/no取消）\n> "));
+}
+
+// 从外部文件导入图书
+void BookManager::Import() {
+    string file;
+    cout << "请输入要导入的文件路径 (文本格式或二进制快照): ";
+    cin >> file;
+    cin.get();  // 清除上一次输入的换行符
+    bool dedupe = _askContinue("是否跳过本馆已有ISBN的图书？（输入y/yes跳过）\n> ", false);
+    ImportStats stats;
+    Status status = Import(file, dedupe, stats, cout);
+    if (status != Ok) {
+        cout << StatusText(status) << endl;
+        return;
     }
+    _commit();  // 整批一次提交, 日志过长时随之压缩为快照
+    cout << "导入成功, 共导入 " << stats.imported << " 本图书" << endl;
+}
+
+// 检查图书馆是否为空
+bool BookManager::Empty() {
+    return libraryManager.empty();
+}
+
+// 分页显示 pages 返回的书籍
+void BookManager::_browse(size_t total, int currPage, int pageSize,
+                          const function<vector<Book>(size_t, size_t)>& pages) {
+    size_t totalPages = (total - 1) / pageSize + 1; // 计算总页数
+    while (true) {
+        // 检查输入的页码是否合法 (先排除非正数, 再按无符号数与总页数比较)
+        if (currPage < 1 || (size_t) currPage > totalPages) {
+            cout << "输入的页码不正确，请重新输入（输入0退出）\n> ";
+            if (!(cin >> currPage && currPage)) { // 输入不合法或为0时退出
+                return;
+            }
+            continue;
+        }
+
+        // 输出当前页的图书信息
+        cout << "-------------------------------" << endl;
+        for (const Book& book : pages(currPage, pageSize)) {
+            cout << book << endl;
+        }
+        cout << "-------------------------------" << endl;
+
+        // 提示用户当前所在页，并允许跳转到其他页
+        cout << "当前为第 " << currPage << " 页，共 " << totalPages
+             << " 页，请输入跳转页码（输入0退出）\n> ";
+        if (!(cin >> currPage && currPage)) {
+            return;
+        }
+    }
+}
+
+// 分页查询所有书籍，currPage 为当前页码，pageSize 为每页显示数量
+void BookManager::FindByPage(int currPage, int pageSize) {
+    _browse(libraryManager.size(), currPage, pageSize, [this](size_t page, size_t size) {
+        return FindPage(page, size);
+    });
+}
+
+// 根据书籍编号查找书籍
+void BookManager::FindByID() {
+    do {
+        int id;
+        cout << "请输入要查找的图书ID: "; // 提示用户输入图书ID
+        cin >> id;
+
+        Book book;
+        if (FindByID(id, book) == Ok) {
+            cout << book << endl; // 如果找到，输出图书信息
+        } else {
+            cout << "该图书ID不存在" << endl; // 如果未找到，提示用户
+        }
+        cin.get(); // 清除上一次输入的换行符
+    } while (_askContinue("是否继续查找？（输入y/yes继续）\n> ", false));
+}
+
+// 根据 ISBN 号查找书籍
+void BookManager::FindByISBN() {
+    do {
+        string ISBN;
+        cout << "请输入要查询的ISBN号：";
+        cin >> ISBN;
+
+        vector<Book> copies = FindByISBN(ISBN); // 通过 ISBN 索引取得所有副本
+        int inCount = 0, outCount = 0; // 记录馆内和借出的书籍数量
+        if (!copies.empty()) { // 所有副本共享描述信息, 只输出一次
+            const Book& first = copies.front();
+            cout << "ISBN: " << first.GetISBN()
+                 << "  书名: " << first.GetName()
+                 << "  作者: " << first.GetAuthor()
+                 << "  出版社: " << first.GetPublisher()
+                 << "  出版年份: " << first.GetYear() << endl;
+        }
+        for (const Book& book : copies) {
+            if (book.GetBorrowStatus()) { // 如果书籍已经被借出
+                cout << "书籍ID: " << book.GetId()
+                     << "  借阅者: " << book.GetBorrower() << endl;
+                ++outCount; // 借出的书籍数量加1
+            } else {
+                ++inCount; // 馆内书籍数量加1
+            }
+        }
+        if (!copies.empty()) {
+            cout << "共 " << inCount + outCount << " 本书  ";
+            if (outCount) {
+                cout << "其中借出: " << outCount << " 本书  ";
+            }
+            cout << "馆内: " << inCount << " 本书" << endl;
+        } else {
+            cout << "没有找到该ISBN号的书籍" << endl;
+        }
+        cin.get(); // 读取多余的换行符
+    } while (_askContinue("是否继续查询？（输入y/yes继续;输入n/no取消）\n> "));
+}
+
+// 多条件筛选书籍
+void BookManager::FindWhere() {
+    do {
+        BookColumns::Query query;
+        string input;
+        cout << "请输入作者（输入-不限）：";
+        cin >> input;
+        if (input != "-") {
+            query.byAuthor = true;
+            query.author = input;
+        }
+        cout << "请输入出版社（输入-不限）：";
+        cin >> input;
+        if (input != "-") {
+            query.byPublisher = true;
+            query.publisher = input;
+        }
+        int yearMin, yearMax;
+        cout << "请输入出版年份范围，起始年份和结束年份以空格分隔（输入0 0不限）：";
+        cin >> yearMin >> yearMax;
+        if (yearMin != 0 || yearMax != 0) {
+            query.yearMin = yearMin;
+            query.yearMax = yearMax;
+        }
+        int status;
+        cout << "请输入借阅状态（0: 不限  1: 在库  2: 已借出）：";
+        cin >> status;
+        if (status == 1) {
+            query.availability = BookColumns::Available;
+        } else if (status == 2) {
+            query.availability = BookColumns::BorrowedOnly;
+        }
+
+        size_t count = CountWhere(query); // 先只计数, 命中为空时不取书籍
+        if (count == 0) {
+            cout << "没有满足条件的书籍" << endl;
+        } else {
+            cout << "共 " << count << " 本书满足条件" << endl;
+            // 命中按编号排列, 第 page 页取前 page * size 本中的最后一页
+            _browse(count, 1, 20, [this, &query](size_t page, size_t size) {
+                vector<Book> found = FindWhere(query, page * size);
+                found.erase(found.begin(), found.begin() + min(found.size(), (page - 1) * size));
+                return found;
+            });
+        }
+        cin.get(); // 读取多余的换行符
+    } while (_askContinue("是否继续筛选？（输入y/yes继续;输入n/no取消）\n> "));
+}
+
+// 全文检索书籍
+void BookManager::Search() {
+    do {
+        string text;
+        cout << "请输入关键词（多个关键词以空格分隔）：";
+        cin >> ws; // 跳过菜单选择留下的换行符
+        getline(cin, text);
+
+        size_t total;
+        Search(text, 1, 1, total); // 先取命中总数
+        if (total == 0) {
+            cout << "没有找到包含这些关键词的书籍" << endl;
+            continue;
+        }
+        cout << "共 " << total << " 本书包含这些关键词" << endl;
+        _browse(total, 1, 20, [this, &text](size_t page, size_t size) {
+            size_t found;
+            return Search(text, page, size, found);
+        });
+        cin.get(); // 读取多余的换行符
+    } while (_askContinue("是否继续检索？（输入y/yes继续;输入n/no取消）\n> "));
+}
+
+// 按前缀查找书目
+void BookManager::Suggest() {
+    do {
+        int field;
+        cout << "请选择匹配的字段（1: 书名  2: 作者）：";
+        cin >> field;
+        string prefix;
+        cout << "请输入前缀：";
+        cin >> ws; // 前缀可以包含空格, 读取整行
+        getline(cin, prefix);
+
+        vector<Title> found = Suggest(prefix, 20, field == 2); // 最多列出 20 个书目
+        if (found.empty()) {
+            cout << "没有以该前缀开头的书目" << endl;
+            continue;
+        }
+        for (const Title& title : found) {
+            cout << "ISBN: " << title.GetISBN()
+                 << "  书名: " << title.GetName()
+                 << "  作者: " << title.GetAuthor()
+                 << "  出版社: " << title.GetPublisher()
+                 << "  出版年份: " << title.GetYear()
+                 << "  共 " << FindByISBN(title.GetISBN()).size() << " 本" << endl;
+        }
+    } while (_askContinue("是否继续查找？（输入y/yes继续;输入n/no取消）\n> "));
+}
+
+// 按出版年份范围查找书籍
+void BookManager::FindByYear() {
+    do {
+        int yearMin, yearMax;
+        cout << "请输入出版年份范围，起始年份和结束年份以空格分隔：";
+        cin >> yearMin >> yearMax;
+
+        size_t available, borrowed;
+        CountByYear(yearMin, yearMax, available, borrowed); // 在年份索引上计数, 不遍历书籍
+        if (available + borrowed == 0) {
+            cout << "该年份范围内没有书籍" << endl;
+        } else {
+            cout << "共 " << available + borrowed << " 本书  其中借出: " << borrowed
+                 << " 本书  馆内: " << available << " 本书" << endl;
+            _browse(available + borrowed, 1, 20, [this, yearMin, yearMax](size_t page, size_t size) {
+                return FindByYear(yearMin, yearMax, page, size);
+            });
+        }
+        cin.get(); // 读取多余的换行符
+    } while (_askContinue("是否继续查找？（输入y/yes继续;输入n/no取消）\n> "));
 }
 
 // 根据书籍编号更新书籍信息
 void BookManager::UpdateByID() {
-    int id;
-    cout << "请输入要更新的书籍ID：";
-    cin >> id;
-
-    auto it = libraryManager.find(id); // 查找指定ID的书籍
-    if (it != libraryManager.end()) { // 如果找到该书籍
+    do {
+        int id;
+        cout << "请输入要更新的书籍ID：";
+        cin >> id;
+
+        auto it = _findBook(id); // 查找指定ID的书籍
+        if (it == libraryManager.end()) {
+            cout << "没有找到该书籍ID" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
+        }
         cout << "原书籍信息：" << endl
              << "ISBN: " << it->GetISBN() << "  书名: " << it->GetName()
              << "  作者: " << it->GetAuthor()
@@ -262,93 +1208,86 @@ void BookManager::UpdateByID() {
         string confirm;
         cin.get(); // 读取多余的换行符
         getline(cin, confirm); // 获取用户输入
-        if (confirm == "y" || confirm == "yes") { // 用户确认更新
-            string updateISBN, updateName, updateAuthor, updatePublisher;
-            int updateYear;
-
-            // 输入更新的内容，如果输入"0"则不更新
-            cout << "请输入更新后的ISBN号（输入0表示不更新）：";
-            cin >> updateISBN;
-            if (updateISBN == "0") {
-                updateISBN = it->GetISBN(); // 保持原ISBN
-            }
-            cout << "请输入更新后的书名（输入0表示不更新）：";
-            cin >> updateName;
-            if (updateName == "0") {
-                updateName = it->GetName(); // 保持原书名
-            }
-            cout << "请输入更新后的作者（输入0表示不更新）：";
-            cin >> updateAuthor;
-            if (updateAuthor == "0") {
-                updateAuthor = it->GetAuthor(); // 保持原作者
-            }
-            cout << "请输入更新后的出版社（输入0表示不更新）：";
-            cin >> updatePublisher;
-            if (updatePublisher == "0") {
-                updatePublisher = it->GetPublisher(); // 保持原出版社
-            }
-            cout << "请输入更新后的出版年份（输入0表示不更新）：";
-            cin >> updateYear;
-            if (updateYear == 0) {
-                updateYear = it->GetYear(); // 保持原出版年份
-            }
+        if (confirm != "y" && confirm != "yes") {
+            cout << "更新已取消" << endl;
+            continue;
+        }
 
-            // 输出更新后的书籍信息，确认是否更新
-            cout << "请确认更新后的书籍信息（输入y/yes确认）： " << endl
-                 << "ISBN: " << updateISBN << "  书名: " << updateName
-                 << "  作者: " << updateAuthor
-                 << "  出版社: " << updatePublisher
-                 << "  出版年份: " << updateYear << "\n> ";
-            cin.get(); // 读取多余的换行符
-            getline(cin, confirm); // 获取用户输入
-            if (confirm == "y" || confirm == "yes") { // 确认更新
-                // 设置更新后的书籍信息
-                it->SetISBN(updateISBN);
-                it->SetName(updateName);
-                it->SetAuthor(updateAuthor);
-                it->SetPublisher(updatePublisher);
-                it->SetYear(updateYear);
-                cout << "成功更新" << endl;
-            } else {
-                cout << "更新已取消" << endl;
-            }
+        string updateISBN, updateName, updateAuthor, updatePublisher;
+        int updateYear;
+
+        // 输入更新的内容，如果输入"0"则不更新
+        cout << "请输入更新后的ISBN号（输入0表示不更新）：";
+        cin >> updateISBN;
+        if (updateISBN == "0") {
+            updateISBN = it->GetISBN(); // 保持原ISBN
+        }
+        cout << "请输入更新后的书名（输入0表示不更新）：";
+        cin >> updateName;
+        if (updateName == "0") {
+            updateName = it->GetName(); // 保持原书名
+        }
+        cout << "请输入更新后的作者（输入0表示不更新）：";
+        cin >> updateAuthor;
+        if (updateAuthor == "0") {
+            updateAuthor = it->GetAuthor(); // 保持原作者
+        }
+        cout << "请输入更新后的出版社（输入0表示不更新）：";
+        cin >> updatePublisher;
+        if (updatePublisher == "0") {
+            updatePublisher = it->GetPublisher(); // 保持原出版社
+        }
+        cout << "请输入更新后的出版年份（输入0表示不更新）：";
+        cin >> updateYear;
+        if (updateYear == 0) {
+            updateYear = it->GetYear(); // 保持原出版年份
+        }
+
+        // 输出更新后的书籍信息，确认是否更新
+        cout << "请确认更新后的书籍信息（输入y/yes确认）： " << endl
+             << "ISBN: " << updateISBN << "  书名: " << updateName
+             << "  作者: " << updateAuthor
+             << "  出版社: " << updatePublisher
+             << "  出版年份: " << updateYear << endl;
+        // 描述信息按 ISBN 共享, 提示会一并更新的其他副本
+        size_t shared = 0;  // 该 ISBN 的副本数
+        auto copies = isbnIndex.equalRange(it->GetISBN());
+        for (auto ref = copies.first; ref != copies.second; ++ref) {
+            ++shared;
+        }
+        if (updateISBN == it->GetISBN() && shared > 1) {
+            cout << "注意: 该ISBN的 " << shared << " 本副本将一并更新" << endl;
+        } else if (titles.find(updateISBN) != titles.end() && updateISBN != it->GetISBN()) {
+            cout << "注意: 新ISBN已有副本, 其书名等信息将一并更新" << endl;
+        }
+        cout << "> ";
+        cin.get(); // 读取多余的换行符
+        getline(cin, confirm); // 获取用户输入
+        if (confirm == "y" || confirm == "yes") { // 确认更新
+            UpdateByID(Book(id, updateISBN, updateName, updateAuthor, updatePublisher,
+                            updateYear, it->GetBorrowStatus(), it->GetBorrower()));
+            _commit();
+            cout << "成功更新" << endl;
         } else {
             cout << "更新已取消" << endl;
         }
-    } else {
-        cout << "没有找到该书籍ID" << endl;
-        cin.get(); // 读取多余的换行符
-    }
-
-    // 是否继续更新
-    cout << "是否继续更新？（输入y/yes继续;输入n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm); // 获取用户输入
-    if (confirm == "y" || confirm == "yes") {
-        UpdateByID();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+    } while (_askContinue("是否继续更新？（输入y/yes继续;输入n/no取消）\n> "));
 }
 
 // 根据 ISBN 号更新书籍信息
 void BookManager::UpdateByISBN() {
-    string ISBN;
-    cout << "请输入要更新的书籍ISBN号：";
-    cin >> ISBN;
-
-    bool find = false; // 用于标记是否找到匹配的书籍
-    auto it = libraryManager.begin(); // 初始化迭代器，指向库中的第一个元素
-    while (it != libraryManager.end()) { // 遍历库中的书籍
-        if (it->GetISBN() == ISBN) { // 如果找到匹配的ISBN
-            find = true; // 标记为找到
-            break; // 退出循环
+    do {
+        string ISBN;
+        cout << "请输入要更新的书籍ISBN号：";
+        cin >> ISBN;
+
+        auto range = isbnIndex.equalRange(ISBN); // 通过 ISBN 索引查找
+        if (range.first == range.second) {
+            cout << "没有找到该ISBN号的书籍" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
         }
-        ++it; // 继续查找下一本书
-    }
-    if (find) { // 如果找到书籍
+        BookRef it = *range.first; // 取第一本副本展示信息
         cout << "原书籍信息：" << endl
              << "ISBN: " << it->GetISBN() << "  书名: " << it->GetName()
              << "  作者: " << it->GetAuthor()
@@ -358,326 +1297,273 @@ void BookManager::UpdateByISBN() {
         string confirm;
         cin.get(); // 读取多余的换行符
         getline(cin, confirm); // 获取用户输入
-        if (confirm == "y" || confirm == "yes") { // 用户确认更新
-            string updateISBN, updateName, updateAuthor, updatePublisher;
-            int updateYear;
-
-            // 提示用户输入更新的内容，如果输入"0"则不更新该项
-            cout << "请输入更新后的ISBN号（输入0表示不更新）：";
-            cin >> updateISBN;
-            if (updateISBN == "0") {
-                updateISBN = it->GetISBN(); // 保持原ISBN
-            }
-            cout << "请输入更新后的书名（输入0表示不更新）：";
-            cin >> updateName;
-            if (updateName == "0") {
-                updateName = it->GetName(); // 保持原书名
-            }
-            cout << "请输入更新后的作者（输入0表示不更新）：";
-            cin >> updateAuthor;
-            if (updateAuthor == "0") {
-                updateAuthor = it->GetAuthor(); // 保持原作者
-            }
-            cout << "请输入更新后的出版社（输入0表示不更新）：";
-            cin >> updatePublisher;
-            if (updatePublisher == "0") {
-                updatePublisher = it->GetPublisher(); // 保持原出版社
-            }
-            cout << "请输入更新后的出版年份（输入0表示不更新）：";
-            cin >> updateYear;
-            if (updateYear == 0) {
-                updateYear = it->GetYear(); // 保持原出版年份
-            }
-
-            // 显示更新后的书籍信息，确认是否更新
-            cout << "请确认更新后的书籍信息（输入y/yes确认）：" << endl
-                 << "ISBN: " << updateISBN << "  书名: " << updateName
-                 << "  作者: " << updateAuthor
-                 << "  出版社: " << updatePublisher
-                 << "  出版年份: " << updateYear << "\n> ";
-            cin.get(); // 读取多余的换行符
-            getline(cin, confirm); // 获取用户输入
-
-            if (confirm == "y" || confirm == "yes") { // 如果用户确认更新
-                // 更新书籍信息
-                while (it != libraryManager.end()) {
-                    if (it->GetISBN() == ISBN) { // 确认找到该书籍
-                        it->SetISBN(updateISBN);
-                        it->SetName(updateName);
-                        it->SetAuthor(updateAuthor);
-                        it->SetPublisher(updatePublisher);
-                        it->SetYear(updateYear);
-                    }
-                    ++it; // 移动到下一本书
-                }
-                cout << "成功更新" << endl;
-            } else {
-                cout << "更新已取消" << endl;
-            }
-        } else {
+        if (confirm != "y" && confirm != "yes") {
             cout << "更新已取消" << endl;
+            continue;
         }
-    } else {
-        cout << "没有找到该ISBN号的书籍" << endl;
+
+        string updateISBN, updateName, updateAuthor, updatePublisher;
+        int updateYear;
+
+        // 提示用户输入更新的内容，如果输入"0"则不更新该项
+        cout << "请输入更新后的ISBN号（输入0表示不更新）：";
+        cin >> updateISBN;
+        if (updateISBN == "0") {
+            updateISBN = it->GetISBN(); // 保持原ISBN
+        }
+        cout << "请输入更新后的书名（输入0表示不更新）：";
+        cin >> updateName;
+        if (updateName == "0") {
+            updateName = it->GetName(); // 保持原书名
+        }
+        cout << "请输入更新后的作者（输入0表示不更新）：";
+        cin >> updateAuthor;
+        if (updateAuthor == "0") {
+            updateAuthor = it->GetAuthor(); // 保持原作者
+        }
+        cout << "请输入更新后的出版社（输入0表示不更新）：";
+        cin >> updatePublisher;
+        if (updatePublisher == "0") {
+            updatePublisher = it->GetPublisher(); // 保持原出版社
+        }
+        cout << "请输入更新后的出版年份（输入0表示不更新）：";
+        cin >> updateYear;
+        if (updateYear == 0) {
+            updateYear = it->GetYear(); // 保持原出版年份
+        }
+
+        // 显示更新后的书籍信息，确认是否更新
+        cout << "请确认更新后的书籍信息（输入y/yes确认）：" << endl
+             << "ISBN: " << updateISBN << "  书名: " << updateName
+             << "  作者: " << updateAuthor
+             << "  出版社: " << updatePublisher
+             << "  出版年份: " << updateYear << "\n> ";
         cin.get(); // 读取多余的换行符
-    }
+        getline(cin, confirm); // 获取用户输入
 
-    // 是否继续更新
-    cout << "是否继续更新？（输入y/yes继续;输入n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        UpdateByISBN();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+        if (confirm == "y" || confirm == "yes") { // 如果用户确认更新
+            UpdateByISBN(ISBN, Title(updateISBN, updateName, updateAuthor, updatePublisher, updateYear));
+            _commit();
+            cout << "成功更新" << endl;
+        } else {
+            cout << "更新已取消" << endl;
+        }
+    } while (_askContinue("是否继续更新？（输入y/yes继续;输入n/no取消）\n> "));
 }
 
 // 根据书籍编号删除书籍
 void BookManager::RemoveByID() {
-    int id;
-    cout << "请输入要删除的书籍ID：";
-    cin >> id;
-
-    auto it = libraryManager.find(id); // 查找指定ID的书籍
-    if (it != libraryManager.end()) { // 如果找到该书籍
+    do {
+        int id;
+        cout << "请输入要删除的书籍ID：";
+        cin >> id;
+
+        auto it = _findBook(id); // 查找指定ID的书籍
+        if (it == libraryManager.end()) {
+            cout << "没有找到该书籍ID" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
+        }
         cout << "书籍信息：" << endl
              << *it << endl
              << "是否删除？（输入y/yes确认删除）\n> ";
         string confirm;
         cin.get(); // 读取多余的换行符
         getline(cin, confirm); // 获取用户输入
-        if (confirm == "y" || confirm == "yes") { // 用户确认删除
-            if (it->GetBorrowStatus()) { // 如果书籍已借出
-                cout << "该书籍当前已被借出，借阅者: " << it->GetBorrower()
-                     << "，确定要删除吗？（输入y/yes确认）\n> ";
-                getline(cin, confirm); // 获取用户确认输入
-                if (confirm == "y" || confirm == "yes") { // 用户确认删除
-                    libraryManager.erase(it); // 删除书籍
-                    cout << "成功删除" << endl;
-                } else {
-                    cout << "删除已取消" << endl;
-                }
-            } else {
-                libraryManager.erase(it); // 如果书籍未借出，直接删除
-                cout << "成功删除" << endl;
-            }
-        } else {
+        if (confirm != "y" && confirm != "yes") {
             cout << "删除已取消" << endl;
+            continue;
         }
-    } else {
-        cout << "没有找到该书籍ID" << endl;
-        cin.get(); // 读取多余的换行符
-    }
-
-    // 是否继续删除
-    cout << "是否继续删除？（输入y/yes继续;输入n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        RemoveByID();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+        if (it->GetBorrowStatus()) { // 如果书籍已借出, 再次确认
+            cout << "该书籍当前已被借出，借阅者: " << it->GetBorrower()
+                 << "，确定要删除吗？（输入y/yes确认）\n> ";
+            getline(cin, confirm); // 获取用户确认输入
+            if (confirm != "y" && confirm != "yes") {
+                cout << "删除已取消" << endl;
+                continue;
+            }
+        }
+        RemoveByID(id);
+        _commit();
+        cout << "成功删除" << endl;
+    } while (_askContinue("是否继续删除？（输入y/yes继续;输入n/no取消）\n> "));
 }
 
 // 根据 ISBN 号删除书籍
 void BookManager::RemoveByISBN() {
-    string ISBN;
-    cout << "请输入要删除的书籍ISBN号：";
-    cin >> ISBN;
-
-    bool find = false; // 用于标记是否找到匹配的书籍
-    auto it = libraryManager.begin(); // 初始化迭代器，指向库中的第一个元素
-    while (it != libraryManager.end()) { // 遍历库中的书籍
-        if (it->GetISBN() == ISBN) { // 如果找到匹配的ISBN
-            find = true; // 标记为找到
-            break; // 退出循环
+    do {
+        string ISBN;
+        cout << "请输入要删除的书籍ISBN号：";
+        cin >> ISBN;
+
+        vector<Book> copies = FindByISBN(ISBN); // 通过 ISBN 索引查找
+        if (copies.empty()) {
+            cout << "没有找到该ISBN号的书籍" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
         }
-        ++it; // 继续查找下一本书
-    }
-    if (find) { // 如果找到书籍
+        const Book& first = copies.front(); // 取第一本副本展示信息
         cout << "书籍信息：" << endl
-             << "ISBN: " << it->GetISBN() << "  书名: " << it->GetName()
-             << "  作者: " << it->GetAuthor()
-             << "  出版社: " << it->GetPublisher()
-             << "  出版年份: " << it->GetYear() << endl
+             << "ISBN: " << first.GetISBN() << "  书名: " << first.GetName()
+             << "  作者: " << first.GetAuthor()
+             << "  出版社: " << first.GetPublisher()
+             << "  出版年份: " << first.GetYear() << endl
              << "是否删除？（输入y/yes确认删除）\n> ";
         string confirm;
         cin.get(); // 读取多余的换行符
         getline(cin, confirm); // 获取用户输入
-        if (confirm == "y" || confirm == "yes") { // 用户确认删除
-            // 遍历所有书籍并删除与指定ISBN匹配的书籍
-            while (it != libraryManager.end()) {
-                auto itAfter = ++it; // 备份当前迭代器位置，用于后续操作
-                --it; // 恢复迭代器到当前位置
-                if (it->GetISBN() == ISBN) { // 如果找到匹配的书籍
-                    if (it->GetBorrowStatus()) { // 如果书籍已借出
-                        cout << "书籍ID: " << it->GetId()
-                             << " 已被借出，借阅者: " << it->GetBorrower()
-                             << "，是否删除？（输入y/yes确认删除）\n> ";
-                        getline(cin, confirm); // 获取用户输入
-                        if (confirm == "y" || confirm == "yes") { // 用户确认删除
-                            libraryManager.erase(it); // 删除书籍
-                        }
-                    } else {
-                        libraryManager.erase(it); // 如果书籍未借出，直接删除
-                    }
+        if (confirm != "y" && confirm != "yes") {
+            cout << "删除已取消" << endl;
+            continue;
+        }
+        // 逐本删除, 已借出的副本需要单独确认
+        for (const Book& book : copies) {
+            if (book.GetBorrowStatus()) {
+                cout << "书籍ID: " << book.GetId()
+                     << " 已被借出，借阅者: " << book.GetBorrower()
+                     << "，是否删除？（输入y/yes确认删除）\n> ";
+                getline(cin, confirm); // 获取用户输入
+                if (confirm != "y" && confirm != "yes") {
+                    continue;
                 }
-                it = itAfter; // 移动到下一本书
             }
-            cout << "删除完成" << endl;
-        } else {
-            cout << "删除已取消" << endl;
+            RemoveByID(book.GetId());  // 最后一本副本删除时同时移除书目
         }
-    } else {
-        cout << "没有找到该ISBN号的书籍" << endl;
-        cin.get(); // 读取多余的换行符
-    }
-
-    // 是否继续删除
-    cout << "是否继续删除？（输入y/yes继续;n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        RemoveByISBN();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+        _commit();  // 所有删除一次提交
+        cout << "删除完成" << endl;
+    } while (_askContinue("是否继续删除？（输入y/yes继续;n/no取消）\n> "));
 }
 
 // 借出书籍操作
 void BookManager::Lend() {
-    int id;
-    string borrower;
-
-    cout << "请输入要借出的书籍ID：";
-    cin >> id;
-    auto it = libraryManager.find(id); // 查找指定ID的书籍
-    if (it != libraryManager.end()) { // 如果找到该书籍
+    do {
+        int id;
+        string borrower;
+
+        cout << "请输入要借出的书籍ID：";
+        cin >> id;
+        auto it = _findBook(id); // 查找指定ID的书籍
+        if (it == libraryManager.end()) {
+            cout << "没有找到该书籍ID" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
+        }
         if (it->GetBorrowStatus()) { // 如果书籍已经借出
             cout << "该书籍已经被借出" << endl;
             cin.get(); // 读取多余的换行符
-        } else {
-            // 如果书籍未借出，提示用户输入借阅者信息
-            cout << "请输入借阅者姓名：";
-            cin >> borrower;
-            // 显示书籍的借出信息，确认借出
-            cout << "请确认借出信息（输入y/yes确认）： " << endl
-                 << "书籍ID: " << id << "  ISBN: " << it->GetISBN()
-                 << "  书名: " << it->GetName()
-                 << "  作者: " << it->GetAuthor()
-                 << "  出版社: " << it->GetPublisher()
-                 << "  出版年份: " << it->GetYear() << "  借阅者: " << borrower
-                 << "\n> ";
-            string confirm;
-            cin.get(); // 读取多余的换行符
-            getline(cin, confirm); // 获取用户输入
-            if (confirm == "y" || confirm == "yes") { // 用户确认借出
-                it->SetBorrowStatus(true); // 设置书籍为已借出
-                it->SetBorrower(borrower); // 设置借阅者
-                cout << "成功借出" << endl;
-            } else {
-                cout << "借出已取消" << endl;
-            }
+            continue;
         }
-    } else {
-        cout << "没有找到该书籍ID" << endl;
+        // 如果书籍未借出，提示用户输入借阅者信息
+        cout << "请输入借阅者姓名：";
+        cin >> borrower;
+        // 显示书籍的借出信息，确认借出
+        cout << "请确认借出信息（输入y/yes确认）： " << endl
+             << "书籍ID: " << id << "  ISBN: " << it->GetISBN()
+             << "  书名: " << it->GetName()
+             << "  作者: " << it->GetAuthor()
+             << "  出版社: " << it->GetPublisher()
+             << "  出版年份: " << it->GetYear() << "  借阅者: " << borrower
+             << "\n> ";
+        string confirm;
         cin.get(); // 读取多余的换行符
-    }
-
-    // 是否继续借出书籍
-    cout << "是否继续借出？（输入y/yes继续;n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        Lend();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+        getline(cin, confirm); // 获取用户输入
+        if (confirm == "y" || confirm == "yes") { // 用户确认借出
+            Lend(id, borrower);
+            _commit();
+            cout << "成功借出" << endl;
+        } else {
+            cout << "借出已取消" << endl;
+        }
+    } while (_askContinue("是否继续借出？（输入y/yes继续;n/no取消）\n> "));
 }
 
 // 归还书籍操作
 void BookManager::Return() {
-    int id;
-    cout << "请输入要归还的书籍ID：";
-    cin >> id;
-    auto it = libraryManager.find(id); // 查找指定ID的书籍
-    if (it != libraryManager.end()) { // 如果找到该书籍
+    do {
+        int id;
+        cout << "请输入要归还的书籍ID：";
+        cin >> id;
+        auto it = _findBook(id); // 查找指定ID的书籍
+        if (it == libraryManager.end()) {
+            cout << "没有找到该书籍ID" << endl;
+            cin.get(); // 读取多余的换行符
+            continue;
+        }
         if (!it->GetBorrowStatus()) { // 如果书籍未被借出
             cout << "该书籍未借出" << endl;
             cin.get(); // 读取多余的换行符
-        } else {
-            // 如果书籍已借出，提示用户确认归还信息
-            cout << "请确认归还信息（输入y/yes确认）： " << endl
-                 << "书籍ID: " << id << "  ISBN: " << it->GetISBN()
-                 << "  书名: " << it->GetName()
-                 << "  作者: " << it->GetAuthor()
-                 << "  出版社: " << it->GetPublisher()
-                 << "  出版年份: " << it->GetYear()
-                 << "  借阅者: " << it->GetBorrower() << "\n> ";
-            string confirm;
-            cin.get(); // 读取多余的换行符
-            getline(cin, confirm); // 获取用户输入
-            if (confirm == "y" || confirm == "yes") { // 用户确认归还
-                it->SetBorrowStatus(false); // 设置书籍为未借出
-                it->SetBorrower(""); // 清空借阅者信息
-                cout << "成功归还" << endl;
-            } else {
-                cout << "归还已取消" << endl;
-            }
+            continue;
         }
-    } else {
-        cout << "没有找到该书籍ID" << endl;
+        // 如果书籍已借出，提示用户确认归还信息
+        cout << "请确认归还信息（输入y/yes确认）： " << endl
+             << "书籍ID: " << id << "  ISBN: " << it->GetISBN()
+             << "  书名: " << it->GetName()
+             << "  作者: " << it->GetAuthor()
+             << "  出版社: " << it->GetPublisher()
+             << "  出版年份: " << it->GetYear()
+             << "  借阅者: " << it->GetBorrower() << "\n> ";
+        string confirm;
         cin.get(); // 读取多余的换行符
-    }
-
-    // 是否继续归还书籍
-    cout << "是否继续归还？（输入y/yes继续;n/no取消）\n> ";
-    string confirm;
-    getline(cin, confirm);
-    if (confirm == "y" || confirm == "yes") {
-        Return();
-    } else if (confirm == "n" || confirm == "no") {
-        cout << "取消操作成功" << endl;
-    } else {
-        cout << "无效输入，请重新输入!" << endl;
-    }
+        getline(cin, confirm); // 获取用户输入
+        if (confirm == "y" || confirm == "yes") { // 用户确认归还
+            Return(id);
+            _commit();
+            cout << "成功归还" << endl;
+        } else {
+            cout << "归还已取消" << endl;
+        }
+    } while (_askContinue("是否继续归还？（输入y/yes继续;n/no取消）\n> "));
 }
 
 // 查询所有已借出的书籍
 void BookManager::FindAllLend() {
-    BookManager LendBook; // 创建一个新的 LibraryManager 对象来保存借出的书籍
-    auto it = libraryManager.begin();
-    while (it != libraryManager.end()) { // 遍历所有书籍
-        if (it->GetBorrowStatus()) { // 如果书籍已借出
-            LendBook.libraryManager.insertUnique(LendBook.libraryManager.end(), *it); // 将借出的书籍加入到新的 LendBook 中
-        }
-        ++it; // 继续查找下一本书
-    }
-    if (LendBook.Empty()) { // 如果没有借出的书籍
+    if (lendIndex.empty()) { // 如果没有借出的书籍
         cout << "当前没有借出的书籍" << endl;
         return;
     }
-    LendBook.FindByPage(1, 20); // 显示借出的书籍（分页显示，显示前20本）
+    _findLendByPage(1, 20); // 直接在借出索引上分页显示（每页20本）
+}
+
+// 分页显示已借出的书籍
+void BookManager::_findLendByPage(int currPage, int pageSize) {
+    _browse(lendIndex.size(), currPage, pageSize, [this](size_t page, size_t size) {
+        return FindLendPage(page, size);
+    });
 }
 
 // 保存图书数据到文件
-void BookManager::Save(string filePath, string fileType) {
-    // 打开一个临时文件用于追加写入数据
+BookManager::Status BookManager::Save(string filePath, string fileType) {
+    // 先写入临时文件, 扩展名为 .bin 时写二进制快照, 否则写文本格式
+    string temp = filePath + ".temp";  // 使用 ".temp" 作为临时文件名
+    bool ok = fileType == ".bin" ? BookSnapshot::Write(temp, libraryManager, currentMaxId)
+                                 : _saveText(temp);
+    if (!ok || !DurableFile::Sync(temp)) { // 如果写入或刷盘失败，保留原文件
+        remove(temp.c_str());
+        return IoError;
+    }
+
+    // 将临时文件直接重命名覆盖原文件 (不先删除, 崩溃时原文件仍完整), 并刷新目录项
+    if (!DurableFile::Replace(temp, filePath + fileType)) {
+        remove(temp.c_str());
+        return IoError;
+    }
+
+    // 新快照已落盘且包含日志中的所有修改, 记录最大编号后才能清空日志
+    if (opLog.IsOpen() && filePath == dataPath && fileType == dataType) {
+        UpdateMaxId("../data/book_max_id.txt");
+        if (!opLog.Reset(fileType)) {  // 快照已落盘, 但之后的修改无法写入日志
+            return IoError;
+        }
+    }
+    return Ok;
+}
+
+// 以文本格式保存图书
+bool BookManager::_saveText(const string& file) {
     ofstream out;
-    out.open(filePath + ".temp", ios::app);  // 使用 ".temp" 作为临时文件名
-    if (!out.is_open()) { // 如果文件打开失败，输出错误信息并返回
-        cout << "无法打开文件!请重试!" << endl;
-        return;
+    out.open(file, ios::trunc);
+    if (!out.is_open()) { // 如果文件打开失败
+        return false;
     }
 
     // 遍历所有图书并将数据写入文件
@@ -687,10 +1573,24 @@ void BookManager::Save(string filePath, string fileType) {
     }
 
     out.close(); // 完成写入后关闭文件
+    return !out.fail();
+}
 
-    // 删除原文件，并将临时文件重命名为原文件
-    remove((filePath + fileType).c_str());  // 删除原文件
-    rename((filePath + ".temp").c_str(), (filePath + fileType).c_str());  // 将临时文件重命名为原文件名
+// 提交尚未落盘的日志记录
+BookManager::Status BookManager::Sync() {
+    return _commit();
+}
+
+// 输出各棵红黑树的结构统计
+void BookManager::PrintTreeStats(ostream& out) {
+    out << "[主索引]" << endl;
+    libraryManager.stats().print(out);
+    out << "[ISBN 索引]" << endl;
+    isbnIndex.stats().print(out);
+    out << "[书目表]" << endl;
+    titles.stats().print(out);
+    out << "[借出索引]" << endl;
+    lendIndex.stats().print(out);
 }
 
 void BookManager::TestRbTree() {
@@ -703,18 +1603,31 @@ void BookManager::TestRbTree() {
     Book book4(7, "5", "Book Title 5", "Author 4", "Publisher 4", 2023, false, "");
 
     // 插入到图书馆的红黑树中
-    libraryManager.insertUnique(book1);
-    libraryManager.insertUnique(book2);
-    libraryManager.insertUnique(book3);
-    libraryManager.insertUnique(book4);
+    opLog.AppendPut(*_insertBook(book1));
+    opLog.AppendPut(*_insertBook(book2));
+    opLog.AppendPut(*_insertBook(book3));
+    opLog.AppendPut(*_insertBook(book4));
 
     // 输出初始树的中序遍历结果
     cout << "In-order traversal of the tree: ";
     libraryManager.inOrderTraversal(libraryManager.rootNode());
     cout << endl;
 
-    // 删除最右节点
+    // 删除最右节点 (先从 ISBN 索引和借出索引中移除, 删除后再清理书目表)
+    string lastISBN;
+    if (!libraryManager.empty()) {
+        BookRef last = --libraryManager.end();
+        opLog.AppendRemove(last->GetId());
+        _unindexISBN(last);
+        _setBorrowed(last, false, "");
+        columns.Remove(last->GetId());
+        yearIndex.Erase(last->GetYear(), last->GetId());
+        lastISBN = last->GetISBN();
+    }
+    _invalidateFrozen();
     libraryManager.removeRightmost();
+    _releaseTitle(lastISBN);
+    _commit();
 
     // 再次中序遍历树
     cout << "In-order traversal after removing the rightmost node: ";
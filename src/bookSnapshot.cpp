@@ -0,0 +1,54 @@
+#include "bookSnapshot.h"
+using namespace std;
+
+// 判断文件是否为二进制快照
+bool BookSnapshot::IsSnapshot(const string& file) {
+    ifstream in(file, ios::in | ios::binary);
+    char magic[4];
+    return in.read(magic, 4) && string(magic, 4) == "LMBS";
+}
+
+// 将字符串登记到字符串堆中
+uint32_t BookSnapshot::Intern(string& heap, unordered_map<string, uint32_t>& offsets, const string& s) {
+    auto it = offsets.find(s);
+    if (it != offsets.end()) {
+        return it->second;  // 已存在, 复用
+    }
+    uint32_t offset = (uint32_t) heap.size();
+    BinaryCodec::PutUint32(heap, (uint32_t) s.size());
+    heap += s;
+    offsets.emplace(s, offset);
+    return offset;
+}
+
+// 读取字符串堆中的字符串
+bool BookSnapshot::HeapString(const char* heap, uint32_t heapSize, uint32_t offset, string& s) {
+    if (offset > heapSize || heapSize - offset < 4) {
+        return false;
+    }
+    uint32_t len = BinaryCodec::GetUint32(heap + offset);
+    if (heapSize - offset - 4 < len) {
+        return false;
+    }
+    s.assign(heap + offset + 4, len);
+    return true;
+}
+
+// 校验文件内容并解析文件头
+bool BookSnapshot::CheckHeader(const string& data, uint32_t& count, int& maxId, uint32_t& heapSize) {
+    if (data.size() < HeaderSize + 4 || data.compare(0, 4, "LMBS") != 0) {
+        return false;  // 文件过短或魔数不符
+    }
+    const char* p = data.data();
+    if (BinaryCodec::GetUint32(p + 4) != Version) {
+        return false;  // 不支持的版本
+    }
+    count = BinaryCodec::GetUint32(p + 8);
+    maxId = (int) BinaryCodec::GetUint32(p + 12);
+    heapSize = BinaryCodec::GetUint32(p + 16);
+    if (data.size() != HeaderSize + (size_t) count * RecordSize + heapSize + 4) {
+        return false;  // 长度与文件头不一致
+    }
+    size_t body = data.size() - 4;
+    return BinaryCodec::Crc32(p, body) == BinaryCodec::GetUint32(p + body);  // 校验和
+}
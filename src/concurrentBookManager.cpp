@@ -0,0 +1,85 @@
+#include "concurrentBookManager.h"
+#include <mutex>
+using namespace std;
+
+// 包装 books
+ConcurrentBookManager::ConcurrentBookManager(BookManager& books) : books(books) {
+    books.SetSharedReads(true);
+}
+
+// 析构函数
+ConcurrentBookManager::~ConcurrentBookManager() {
+    books.SetSharedReads(false);
+}
+
+// 根据书籍编号查找
+BookManager::Status ConcurrentBookManager::FindByID(int id, Book& book) {
+    shared_lock<shared_mutex> guard(lock);
+    return books.FindByID(id, book);
+}
+
+// 根据 ISBN 查找所有副本
+vector<Book> ConcurrentBookManager::FindByISBN(const string& ISBN) {
+    shared_lock<shared_mutex> guard(lock);
+    return books.FindByISBN(ISBN);
+}
+
+// 取第 currPage 页的书籍
+vector<Book> ConcurrentBookManager::FindPage(size_t currPage, size_t pageSize) {
+    shared_lock<shared_mutex> guard(lock);
+    return books.FindPage(currPage, pageSize);
+}
+
+// 取已借出书籍的第 currPage 页
+vector<Book> ConcurrentBookManager::FindLendPage(size_t currPage, size_t pageSize) {
+    shared_lock<shared_mutex> guard(lock);
+    return books.FindLendPage(currPage, pageSize);
+}
+
+// 出版年份区间内的书数
+void ConcurrentBookManager::CountByYear(int yearMin, int yearMax, size_t& available, size_t& borrowed) {
+    shared_lock<shared_mutex> guard(lock);
+    books.CountByYear(yearMin, yearMax, available, borrowed);
+}
+
+// 图书总数
+size_t ConcurrentBookManager::Size() {
+    shared_lock<shared_mutex> guard(lock);
+    return books.Size();
+}
+
+// 已借出的图书数
+size_t ConcurrentBookManager::LendCount() {
+    shared_lock<shared_mutex> guard(lock);
+    return books.LendCount();
+}
+
+// 添加 count 本同一 ISBN 的副本
+BookManager::Status ConcurrentBookManager::Insert(const Title& title, int count, int& firstId) {
+    unique_lock<shared_mutex> guard(lock);
+    return books.Insert(title, count, firstId);
+}
+
+// 根据书籍编号删除
+BookManager::Status ConcurrentBookManager::RemoveByID(int id) {
+    unique_lock<shared_mutex> guard(lock);
+    return books.RemoveByID(id);
+}
+
+// 借出书籍
+BookManager::Status ConcurrentBookManager::Lend(int id, const string& borrower) {
+    unique_lock<shared_mutex> guard(lock);
+    return books.Lend(id, borrower);
+}
+
+// 归还书籍
+BookManager::Status ConcurrentBookManager::Return(int id) {
+    unique_lock<shared_mutex> guard(lock);
+    return books.Return(id);
+}
+
+// 提交日志并接管冻结索引
+BookManager::Status ConcurrentBookManager::Sync() {
+    unique_lock<shared_mutex> guard(lock);
+    return books.Sync();
+}
@@ -0,0 +1,57 @@
+#include "durableFile.h"
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+// 将文件内容刷入磁盘
+bool DurableFile::Sync(const string& file) {
+#ifdef _WIN32
+    int fd = _open(file.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+#endif
+    return ok;
+}
+
+// 将目录项的修改刷入磁盘
+bool DurableFile::SyncDirectory(const string& dir) {
+#ifdef _WIN32
+    (void) dir;  // Windows 的重命名由文件系统日志保证, 也无法打开目录句柄刷盘
+    return true;
+#else
+    int fd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#endif
+}
+
+// 用 from 原子地替换 to
+bool DurableFile::Replace(const string& from, const string& to) {
+    // filesystem::rename 在目标已存在时直接覆盖 (POSIX rename / Windows MoveFileEx), 不留下没有目标文件的窗口
+    error_code ec;
+    filesystem::rename(from, to, ec);
+    if (ec) {
+        return false;
+    }
+    return SyncDirectory(filesystem::path(to).parent_path().string());
+}
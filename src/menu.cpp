@@ -33,6 +33,8 @@ void Menu::Main() {
          << "3: 修改图书信息                  📗 " << endl
          << "4: 删除图书                      📙 " << endl
          << "5: 借阅管理                      📔 " << endl
+         << "6: 树结构统计                    📊 " << endl
+         << "7: 导入分馆图书                  📦 " << endl
          << "0: 登出                          ❌ " << endl
          << "> ";
 }
@@ -48,6 +50,10 @@ void Menu::Find() {
          << "1: 按书号查找                   🔢 " << endl
          << "2: 按ISBN查找                  🆔 " << endl
          << "3: 查看所有图书                 📚 " << endl
+         << "4: 多条件筛选                   🗂️ " << endl
+         << "5: 关键词检索                   🔎 " << endl
+         << "6: 按书名/作者前缀查找           🔤 " << endl
+         << "7: 按出版年份查找               📅 " << endl
          << "0: 返回上一级菜单                ↩️ " << endl
          << "> ";
 }
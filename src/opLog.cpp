@@ -0,0 +1,285 @@
+#include "opLog.h"
+#include "binaryCodec.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+// 构造函数
+OpLog::OpLog(size_t groupLimit)
+        : file(nullptr), failed(false), pendingCount(0), recordCount(0), groupLimit(groupLimit) {}
+
+// 析构函数
+OpLog::~OpLog() {
+    Close();
+}
+
+// 向字符串追加一个带长度前缀的字符串
+void OpLog::PutString(string& out, const string& s) {
+    BinaryCodec::PutUint32(out, (uint32_t) s.size());
+    out += s;
+}
+
+// 从缓冲区读取一个带长度前缀的字符串
+bool OpLog::GetString(const string& in, size_t& pos, string& s) {
+    uint32_t len;
+    if (!BinaryCodec::GetUint32(in, pos, len) || in.size() - pos < len) {
+        return false;
+    }
+    s.assign(in, pos, len);
+    pos += len;
+    return true;
+}
+
+// 将负载封装为一条记录并追加到缓冲区
+void OpLog::Append(const string& payload) {
+    if (path.empty()) {  // 未打开日志时不记录 (例如临时的 BookManager)
+        return;
+    }
+    BinaryCodec::PutUint32(buffer, (uint32_t) payload.size());
+    BinaryCodec::PutUint32(buffer, BinaryCodec::Crc32(payload.data(), payload.size()));
+    buffer += payload;
+    ++pendingCount;
+    ++recordCount;
+    if (pendingCount >= groupLimit) {  // 缓冲区过大时自动提交
+        Commit();
+    }
+}
+
+// 解析一条记录的负载
+bool OpLog::Decode(const string& payload, OpType& type, Book& book, string& ISBN) {
+    if (payload.empty()) {
+        return false;
+    }
+    type = (OpType) payload[0];
+    size_t pos = 1;
+    if (type == Checkpoint) {  // 快照文件类型存放在 ISBN 中
+        book = Book();
+        return GetString(payload, pos, ISBN) && pos == payload.size();
+    }
+    if (type == Retitle) {
+        string newISBN, name, author, publisher;
+        uint32_t year;
+        if (!GetString(payload, pos, ISBN) || !GetString(payload, pos, newISBN) ||
+            !GetString(payload, pos, name) || !GetString(payload, pos, author) ||
+            !GetString(payload, pos, publisher) || !BinaryCodec::GetUint32(payload, pos, year)) {
+            return false;
+        }
+        book = Book(0, newISBN, name, author, publisher, (int) year, false, "");
+        return pos == payload.size();
+    }
+    uint32_t id;
+    if (!BinaryCodec::GetUint32(payload, pos, id)) {
+        return false;
+    }
+    if (type == Remove) {
+        book = Book();
+        book.SetId((int) id);
+        return pos == payload.size();
+    }
+    if (type != Put) {
+        return false;
+    }
+    string name, author, publisher, borrower;
+    uint32_t year, status;
+    if (!GetString(payload, pos, ISBN) || !GetString(payload, pos, name) ||
+        !GetString(payload, pos, author) || !GetString(payload, pos, publisher) ||
+        !BinaryCodec::GetUint32(payload, pos, year) || !BinaryCodec::GetUint32(payload, pos, status) ||
+        !GetString(payload, pos, borrower)) {
+        return false;
+    }
+    book = Book((int) id, ISBN, name, author, publisher, (int) year, status != 0, borrower);
+    return pos == payload.size();
+}
+
+// 以追加模式打开日志文件
+bool OpLog::Open(const string& filePath) {
+    Close();
+    file = fopen(filePath.c_str(), "ab");
+    if (file == nullptr) {
+        return false;
+    }
+    path = filePath;
+    failed = false;
+    return true;
+}
+
+// 提交剩余记录并关闭日志文件
+void OpLog::Close() {
+    if (file != nullptr) {
+        Commit();
+        fclose(file);
+        file = nullptr;
+    }
+    path.clear();
+    buffer.clear();
+    pendingCount = 0;
+}
+
+// 日志文件是否已打开
+bool OpLog::IsOpen() const {
+    return !path.empty();
+}
+
+// 追加一条写入记录
+void OpLog::AppendPut(const Book& book) {
+    string payload(1, (char) Put);
+    BinaryCodec::PutUint32(payload, (uint32_t) book.GetId());
+    PutString(payload, book.GetISBN());
+    PutString(payload, book.GetName());
+    PutString(payload, book.GetAuthor());
+    PutString(payload, book.GetPublisher());
+    BinaryCodec::PutUint32(payload, (uint32_t) book.GetYear());
+    BinaryCodec::PutUint32(payload, book.GetBorrowStatus() ? 1 : 0);
+    PutString(payload, book.GetBorrower());
+    Append(payload);
+}
+
+// 追加一条删除记录
+void OpLog::AppendRemove(int id) {
+    string payload(1, (char) Remove);
+    BinaryCodec::PutUint32(payload, (uint32_t) id);
+    Append(payload);
+}
+
+// 追加一条描述信息修改记录
+void OpLog::AppendRetitle(const string& ISBN, const Title& title) {
+    string payload(1, (char) Retitle);
+    PutString(payload, ISBN);
+    PutString(payload, title.GetISBN());
+    PutString(payload, title.GetName());
+    PutString(payload, title.GetAuthor());
+    PutString(payload, title.GetPublisher());
+    BinaryCodec::PutUint32(payload, (uint32_t) title.GetYear());
+    Append(payload);
+}
+
+// 组提交: 一次写入 + 一次刷盘覆盖缓冲区中的所有记录
+bool OpLog::Commit() {
+    if (path.empty() || buffer.empty()) {
+        return !failed;
+    }
+    bool ok = !failed && file != nullptr &&
+              fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    // 失败时文件末尾可能留有不完整的记录, 之后追加的记录在回放时会被一并截断,
+    // 因此不再写入, 缓冲区中的修改只能由下一次成功的快照保存 (Reset 后恢复)
+    failed = !ok;
+    buffer.clear();
+    pendingCount = 0;
+    return ok;
+}
+
+// 回放日志文件
+bool OpLog::Replay(const string& filePath, const ApplyFunc& apply) {
+    ifstream in(filePath, ios::in | ios::binary);
+    if (!in.is_open()) {
+        return true;  // 日志不存在, 无需回放
+    }
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    size_t pos = 0, good = 0, count = 0;
+    OpType type;
+    Book book;
+    string ISBN;
+    while (true) {
+        size_t p = pos;
+        uint32_t len, crc;
+        if (!BinaryCodec::GetUint32(data, p, len) || !BinaryCodec::GetUint32(data, p, crc) ||
+            data.size() - p < len) {
+            break;  // 记录不完整 (写入时崩溃)
+        }
+        string payload = data.substr(p, len);
+        if (BinaryCodec::Crc32(payload.data(), payload.size()) != crc) {
+            break;  // 校验失败 (写入时崩溃)
+        }
+        if (!Decode(payload, type, book, ISBN)) {
+            return false;  // 校验通过却无法解析, 不是写入中断造成的, 不截断, 交给调用者处理
+        }
+        pos = good = p + len;
+        if (type == Checkpoint) {  // 检查点不是修改操作
+            continue;
+        }
+        apply(type, book, ISBN);
+        ++count;
+    }
+
+    if (good != data.size()) {  // 截断损坏的尾部, 以免之后追加的记录接在垃圾数据后面
+        error_code ec;
+        filesystem::resize_file(filePath, good, ec);
+        if (ec) {
+            return false;
+        }
+    }
+    recordCount += count;
+    return true;
+}
+
+// 清空日志
+bool OpLog::Reset(const string& baseType) {
+    buffer.clear();
+    pendingCount = 0;
+    recordCount = 0;
+    if (path.empty()) {
+        return true;
+    }
+    // 以写模式重新打开即截断文件, 之后的记录从文件开头顺序写入
+    if (file != nullptr) {
+        fclose(file);
+    }
+    file = fopen(path.c_str(), "wb");
+    // 打开失败时保持打开状态, 之后的提交都报告失败, 直到下一次 Reset 成功
+    failed = file == nullptr;
+    if (failed) {
+        return false;
+    }
+    // 检查点立即落盘: 此后即使快照文件丢失, 启动时也不会退回去加载更旧的数据
+    string payload(1, (char) Checkpoint);
+    PutString(payload, baseType);
+    Append(payload);
+    --recordCount;  // 检查点不计入压缩阈值
+    return Commit();
+}
+
+// 读取日志第一条检查点记录中的快照文件类型
+string OpLog::BaseType(const string& filePath) {
+    ifstream in(filePath, ios::in | ios::binary);
+    char header[8];
+    if (!in.is_open() || !in.read(header, 8)) {
+        return "";
+    }
+    string head(header, 8);
+    size_t pos = 0;
+    uint32_t len, crc;
+    BinaryCodec::GetUint32(head, pos, len);
+    BinaryCodec::GetUint32(head, pos, crc);
+    if (len == 0 || len > 4096) {  // 检查点记录很短, 过长说明第一条不是检查点
+        return "";
+    }
+    string payload(len, '\0');
+    if (!in.read(&payload[0], len) || BinaryCodec::Crc32(payload.data(), len) != crc) {
+        return "";
+    }
+    OpType type;
+    Book book;
+    string baseType;
+    if (!Decode(payload, type, book, baseType) || type != Checkpoint) {
+        return "";
+    }
+    return baseType;
+}
+
+// 自上次清空以来的记录数
+size_t OpLog::RecordCount() const {
+    return recordCount;
+}
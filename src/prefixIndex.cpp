@@ -0,0 +1,154 @@
+#include "prefixIndex.h"
+#include <algorithm>
+#include <cctype>
+using namespace std;
+
+// 构造函数
+PrefixIndex::PrefixIndex() : count(0) {}
+
+// 清空索引
+void PrefixIndex::Clear() {
+    root.children.clear();
+    root.values.clear();
+    count = 0;
+}
+
+// 统一大小写后的键值 (只转换 ASCII 字母, 多字节字符原样保留)
+string PrefixIndex::_normalize(const string& key) {
+    string result = key;
+    for (char& c : result) {
+        if ((unsigned char) c < 0x80) {
+            c = (char) tolower((unsigned char) c);
+        }
+    }
+    return result;
+}
+
+// 在 node 的子节点中查找边的首字节为 c 的子节点
+size_t PrefixIndex::_childIndex(const Node& node, unsigned char c) {
+    auto it = lower_bound(node.children.begin(), node.children.end(), c,
+                          [](const unique_ptr<Node>& child, unsigned char b) {
+                              return (unsigned char) child->label[0] < b;
+                          });
+    return it - node.children.begin();
+}
+
+// 登记 (key, value)
+void PrefixIndex::Insert(const string& key, const string& value) {
+    string k = _normalize(key);
+    Node* node = &root;
+    size_t pos = 0;
+    while (pos < k.size()) {
+        size_t i = _childIndex(*node, (unsigned char) k[pos]);
+        if (i == node->children.size() || node->children[i]->label[0] != k[pos]) {
+            // 没有共同前缀的子节点: 剩余部分整体作为一条新边
+            unique_ptr<Node> leaf(new Node());
+            leaf->label = k.substr(pos);
+            node->children.insert(node->children.begin() + i, move(leaf));
+            node = node->children[i].get();
+            pos = k.size();
+            break;
+        }
+        Node* child = node->children[i].get();
+        // 计算边与剩余键值的公共前缀长度
+        size_t common = 1;
+        while (common < child->label.size() && pos + common < k.size() && child->label[common] == k[pos + common]) {
+            ++common;
+        }
+        if (common < child->label.size()) {
+            // 键值在边的中间分叉 (或结束): 在分叉处拆出中间节点, 原子节点成为它的唯一子节点
+            unique_ptr<Node> middle(new Node());
+            middle->label = child->label.substr(0, common);
+            child->label.erase(0, common);
+            middle->children.push_back(move(node->children[i]));
+            node->children[i] = move(middle);
+            child = node->children[i].get();
+        }
+        node = child;
+        pos += common;
+    }
+    auto it = lower_bound(node->values.begin(), node->values.end(), value);
+    if (it == node->values.end() || *it != value) {
+        node->values.insert(it, value);
+        ++count;
+    }
+}
+
+// 从 node 开始删除 key[pos..] 对应的值
+bool PrefixIndex::_erase(Node& node, const string& key, size_t pos, const string& value) {
+    if (pos == key.size()) {
+        auto it = lower_bound(node.values.begin(), node.values.end(), value);
+        if (it == node.values.end() || *it != value) {
+            return false;
+        }
+        node.values.erase(it);
+        return true;
+    }
+    size_t i = _childIndex(node, (unsigned char) key[pos]);
+    if (i == node.children.size()) {
+        return false;
+    }
+    Node& child = *node.children[i];
+    if (key.compare(pos, child.label.size(), child.label) != 0 || !_erase(child, key, pos + child.label.size(), value)) {
+        return false;
+    }
+    // 维持压缩: 子节点为空时移除, 只剩一个分支时与下一级合并
+    if (child.values.empty() && child.children.empty()) {
+        node.children.erase(node.children.begin() + i);
+    } else if (child.values.empty() && child.children.size() == 1) {
+        unique_ptr<Node> grandchild = move(child.children[0]);
+        grandchild->label = child.label + grandchild->label;
+        node.children[i] = move(grandchild);
+    }
+    return true;
+}
+
+// 移除 (key, value)
+void PrefixIndex::Erase(const string& key, const string& value) {
+    if (_erase(root, _normalize(key), 0, value)) {
+        --count;
+    }
+}
+
+// 按字典序遍历子树, 收集值直到 result 中有 k 个
+void PrefixIndex::_collect(const Node& node, size_t k, vector<string>& result) {
+    for (const string& value : node.values) {
+        if (result.size() == k) {
+            return;
+        }
+        result.push_back(value);
+    }
+    for (const unique_ptr<Node>& child : node.children) {
+        if (result.size() == k) {
+            return;
+        }
+        _collect(*child, k, result);
+    }
+}
+
+// 返回键值以 prefix 开头的前 k 个值
+vector<string> PrefixIndex::Complete(const string& prefix, size_t k) const {
+    vector<string> result;
+    string p = _normalize(prefix);
+    const Node* node = &root;
+    size_t pos = 0;
+    while (pos < p.size()) {
+        size_t i = _childIndex(*node, (unsigned char) p[pos]);
+        if (i == node->children.size()) {
+            return result;
+        }
+        const Node* child = node->children[i].get();
+        // 前缀的剩余部分与边比较: 前缀在边的中间结束时, 子节点的整棵子树都匹配
+        size_t len = min(child->label.size(), p.size() - pos);
+        if (p.compare(pos, len, child->label, 0, len) != 0) {
+            return result;
+        }
+        node = child;
+        pos += len;
+    }
+    _collect(*node, k, result);
+    return result;
+}
+
+// (键值, 值) 对的个数
+size_t PrefixIndex::Size() const { return count; }
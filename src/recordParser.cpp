@@ -0,0 +1,129 @@
+#include "recordParser.h"
+#include <charconv>
+#include <cstring>
+using namespace std;
+
+// 转换为 Book 对象
+Book RecordParser::BookFields::ToBook() const {
+    return Book(id, string(ISBN), string(name), string(author), string(publisher), year,
+                borrowStatus, string(borrower));
+}
+
+// 转换为 Admin 对象
+Admin RecordParser::AdminFields::ToAdmin() const {
+    return Admin(string(name), string(password));
+}
+
+// 构造函数
+RecordParser::RecordParser(const char* data, size_t size, size_t firstLine)
+        : pos(data), end(data + size), firstLine(firstLine), line(firstLine) {}
+
+// 取出下一行并切分为字段
+bool RecordParser::NextLine(string_view* tokens, size_t& count, size_t& lineNo) {
+    while (pos < end) {
+        // 找到行尾
+        const char* eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        const char* p = pos;
+        pos = eol < end ? eol + 1 : end;
+        lineNo = line++;
+
+        // 按空白切分字段 (兼容 Windows 的 \r\n 换行)
+        count = 0;
+        while (p < eol) {
+            while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r')) {
+                ++p;
+            }
+            if (p == eol) {
+                break;
+            }
+            const char* q = p;
+            while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') {
+                ++q;
+            }
+            if (count < MaxTokens) {
+                tokens[count] = string_view(p, q - p);
+            }
+            ++count;
+            p = q;
+        }
+        if (count > 0) {
+            return true;  // 跳过空行
+        }
+    }
+    return false;
+}
+
+// 解析整数字段, 必须整个字段都是数字
+bool RecordParser::ParseInt(string_view s, int& value) {
+    const char* last = s.data() + s.size();
+    auto result = from_chars(s.data(), last, value);
+    return result.ec == errc() && result.ptr == last;
+}
+
+// 解析下一条图书记录
+bool RecordParser::NextBook(BookFields& fields) {
+    string_view t[MaxTokens];
+    size_t count, lineNo;
+    while (NextLine(t, count, lineNo)) {
+        if (count < 7) {
+            errors.push_back({lineNo, "字段数不足"});
+            continue;
+        }
+        int status;
+        if (!ParseInt(t[0], fields.id)) {
+            errors.push_back({lineNo, "编号不是整数: " + string(t[0])});
+            continue;
+        }
+        if (!ParseInt(t[5], fields.year)) {
+            errors.push_back({lineNo, "出版年份不是整数: " + string(t[5])});
+            continue;
+        }
+        if (!ParseInt(t[6], status) || (status != 0 && status != 1)) {
+            errors.push_back({lineNo, "借阅状态不是 0 或 1: " + string(t[6])});
+            continue;
+        }
+        // 借出的书有借阅人字段, 在库的书没有
+        size_t expected = status ? 8 : 7;
+        if (count != expected) {
+            errors.push_back({lineNo, count < expected ? "缺少借阅人" : "字段数过多"});
+            continue;
+        }
+        fields.ISBN = t[1];
+        fields.name = t[2];
+        fields.author = t[3];
+        fields.publisher = t[4];
+        fields.borrowStatus = status != 0;
+        fields.borrower = status ? t[7] : string_view();
+        return true;
+    }
+    return false;
+}
+
+// 解析下一条管理员记录
+bool RecordParser::NextAdmin(AdminFields& fields) {
+    string_view t[MaxTokens];
+    size_t count, lineNo;
+    while (NextLine(t, count, lineNo)) {
+        if (count != 2) {
+            errors.push_back({lineNo, "应为 用户名 密码 两个字段"});
+            continue;
+        }
+        fields.name = t[0];
+        fields.password = t[1];
+        return true;
+    }
+    return false;
+}
+
+// 已读取的行数
+size_t RecordParser::LinesRead() const {
+    return line - firstLine;
+}
+
+// 格式错误的行
+const vector<RecordParser::Error>& RecordParser::Errors() const {
+    return errors;
+}
@@ -0,0 +1,328 @@
+#include "textIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+using namespace std;
+
+// 是否为标点或空白 (全角标点、中文标点、常用符号), 这些字符不作为词
+static bool isPunctuation(uint32_t cp) {
+    return (cp >= 0x2000 && cp <= 0x206F)      // 常用标点 (破折号、引号、省略号等)
+           || (cp >= 0x3000 && cp <= 0x303F)   // 中日韩符号和标点 (、。《》「」等)
+           || (cp >= 0xFF00 && cp <= 0xFF0F)   // 全角 ！＂＃ ... ／
+           || (cp >= 0xFF1A && cp <= 0xFF20)   // 全角 ：；＜＝＞？＠
+           || (cp >= 0xFF3B && cp <= 0xFF40)   // 全角 ［＼］＾＿｀
+           || (cp >= 0xFF5B && cp <= 0xFF65);  // 全角 ｛｜｝～ 及半角标点
+}
+
+// 在末尾追加一项
+void TextIndex::PostingList::Append(uint32_t doc, uint8_t fields) {
+    if (count % SkipInterval == 0) {
+        skips.push_back({doc, (uint32_t) bytes.size(), last});
+    }
+    // 文档号差按变长整数存放: 每字节 7 位, 最高位为 1 表示后面还有字节
+    uint32_t delta = doc - last;
+    while (delta >= 0x80) {
+        bytes.push_back((uint8_t) (delta | 0x80));
+        delta >>= 7;
+    }
+    bytes.push_back((uint8_t) delta);
+    bytes.push_back(fields);
+    last = doc;
+    ++count;
+}
+
+// 构造函数, 位于第一项之前
+TextIndex::Cursor::Cursor(const PostingList& list) : list(&list), offset(0), index(0), doc(0), fields(0) {}
+
+// 移到下一项
+bool TextIndex::Cursor::Next() {
+    if (index >= list->count) {
+        return false;
+    }
+    const uint8_t* p = list->bytes.data() + offset;
+    uint32_t delta = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        delta |= (uint32_t) (*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    delta |= (uint32_t) *p++ << shift;
+    doc += delta;
+    fields = *p++;
+    offset = p - list->bytes.data();
+    ++index;
+    return true;
+}
+
+// 移到文档号不小于 target 的第一项
+bool TextIndex::Cursor::Seek(uint32_t target) {
+    if (index > 0 && doc >= target) {
+        return true;
+    }
+    // 在下一项之后的跳跃点中倍增查找最后一个文档号不大于 target 的点, 直接跳到该点
+    const vector<Skip>& skips = list->skips;
+    size_t lo = (index + SkipInterval - 1) / SkipInterval;
+    if (lo < skips.size() && skips[lo].doc <= target) {
+        size_t step = 1;
+        while (lo + step < skips.size() && skips[lo + step].doc <= target) {
+            lo += step;
+            step *= 2;
+        }
+        // 此时 skips[lo].doc <= target, 结果在 [lo, min(lo + step, size)) 中, 二分查找
+        size_t hi = min(lo + step, skips.size());
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (skips[mid].doc <= target) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        offset = skips[lo].offset;
+        index = (uint32_t) (lo * SkipInterval);
+        doc = skips[lo].prevDoc;
+    }
+    // 跳跃点之后最多顺序解码 SkipInterval 项
+    while (Next()) {
+        if (doc >= target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 对 text 分词
+template <class Emit>
+void TextIndex::_tokenize(const string& text, Emit emit) {
+    string word;  // 正在累积的 ASCII 词
+    auto flush = [&word, &emit]() {
+        if (!word.empty()) {
+            emit(word);
+            word.clear();
+        }
+    };
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = (unsigned char) text[i];
+        if (c < 0x80) {  // ASCII: 字母数字累积为一个词, 其余字符为分隔符
+            if (isalnum(c)) {
+                word += (char) tolower(c);
+            } else {
+                flush();
+            }
+            ++i;
+            continue;
+        }
+        flush();
+        // UTF-8 多字节字符: 由首字节确定长度, 每个字符单独作为一个词
+        size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        len = min(len, text.size() - i);
+        uint32_t cp = len == 1 ? c : c & (0x7F >> len);
+        for (size_t k = 1; k < len; ++k) {
+            cp = (cp << 6) | ((unsigned char) text[i + k] & 0x3F);
+        }
+        if (!isPunctuation(cp)) {
+            emit(text.substr(i, len));
+        }
+        i += len;
+    }
+    flush();
+}
+
+// 书名、作者、出版社拼接为一个字符串 (以不会出现在文本中的 \x1F 分隔)
+string TextIndex::_textOf(const Title& title) {
+    return title.GetName() + '\x1F' + title.GetAuthor() + '\x1F' + title.GetPublisher();
+}
+
+// 构造函数
+TextIndex::TextIndex() : live(0) {}
+
+// 清空索引
+void TextIndex::Clear() {
+    terms.clear();
+    docOfISBN.clear();
+    isbnOfDoc.clear();
+    textOfDoc.clear();
+    alive.clear();
+    live = 0;
+}
+
+// 作废一个文档
+void TextIndex::_retire(uint32_t doc) {
+    alive[doc] = 0;
+    string().swap(isbnOfDoc[doc]);
+    string().swap(textOfDoc[doc]);
+    --live;
+}
+
+// 登记或更新一个书目
+void TextIndex::Put(const Title& title) {
+    string text = _textOf(title);
+    auto it = docOfISBN.find(title.GetISBN());
+    if (it != docOfISBN.end()) {
+        if (textOfDoc[it->second] == text) {  // 只有出版年份等未索引的字段变化
+            return;
+        }
+        _retire(it->second);
+    }
+
+    // 分配新文档号, 追加到各个词的倒排表末尾
+    uint32_t doc = (uint32_t) isbnOfDoc.size();
+    docOfISBN[title.GetISBN()] = doc;
+    isbnOfDoc.push_back(title.GetISBN());
+    textOfDoc.push_back(move(text));
+    alive.push_back(1);
+    ++live;
+
+    // 收集三个字段的词, 同一个词合并字段掩码
+    vector<pair<string, uint8_t>> tokens;
+    _tokenize(title.GetName(), [&tokens](const string& t) { tokens.emplace_back(t, NameField); });
+    _tokenize(title.GetAuthor(), [&tokens](const string& t) { tokens.emplace_back(t, AuthorField); });
+    _tokenize(title.GetPublisher(), [&tokens](const string& t) { tokens.emplace_back(t, PublisherField); });
+    sort(tokens.begin(), tokens.end());
+    for (size_t i = 0; i < tokens.size();) {
+        uint8_t fields = 0;
+        size_t j = i;
+        for (; j < tokens.size() && tokens[j].first == tokens[i].first; ++j) {
+            fields |= tokens[j].second;
+        }
+        terms[tokens[i].first].Append(doc, fields);
+        i = j;
+    }
+    _compactIfNeeded();
+}
+
+// 移除一个 ISBN 的书目
+void TextIndex::Remove(const string& ISBN) {
+    auto it = docOfISBN.find(ISBN);
+    if (it == docOfISBN.end()) {
+        return;
+    }
+    _retire(it->second);
+    docOfISBN.erase(it);
+    _compactIfNeeded();
+}
+
+// 作废的文档过多时压缩
+void TextIndex::_compactIfNeeded() {
+    size_t dead = isbnOfDoc.size() - live;
+    if (dead <= max(CompactMinDocs, live)) {
+        return;
+    }
+    // 有效文档按原顺序重新编号, 新旧编号的相对顺序不变, 倒排表重新编码后仍然有序
+    vector<uint32_t> renumber(isbnOfDoc.size(), UINT32_MAX);  // 旧编号 -> 新编号, 作废的文档为 UINT32_MAX
+    uint32_t next = 0;
+    for (size_t doc = 0; doc < isbnOfDoc.size(); ++doc) {
+        if (alive[doc]) {
+            renumber[doc] = next;
+            if (next != doc) {
+                isbnOfDoc[next] = move(isbnOfDoc[doc]);
+                textOfDoc[next] = move(textOfDoc[doc]);
+                alive[next] = 1;
+                docOfISBN[isbnOfDoc[next]] = next;
+            }
+            ++next;
+        }
+    }
+    isbnOfDoc.resize(next);
+    textOfDoc.resize(next);
+    alive.resize(next);
+
+    for (auto it = terms.begin(); it != terms.end();) {
+        PostingList compacted;
+        Cursor cursor(it->second);
+        while (cursor.Next()) {
+            if (renumber[cursor.doc] != UINT32_MAX) {
+                compacted.Append(renumber[cursor.doc], cursor.fields);
+            }
+        }
+        if (compacted.count == 0) {
+            it = terms.erase(it);
+        } else {
+            it->second = move(compacted);
+            ++it;
+        }
+    }
+}
+
+// 查找包含 query 中所有词的书目
+vector<string> TextIndex::Search(const string& query) const {
+    vector<string> result;
+    vector<string> words;
+    _tokenize(query, [&words](const string& t) { words.push_back(t); });
+    sort(words.begin(), words.end());
+    words.erase(unique(words.begin(), words.end()), words.end());
+    if (words.empty()) {
+        return result;
+    }
+
+    // 任何一个词不存在时交集为空; 其余按倒排表长度从短到长排列, 最短的表驱动交集
+    vector<const PostingList*> lists;
+    for (const string& w : words) {
+        auto it = terms.find(w);
+        if (it == terms.end()) {
+            return result;
+        }
+        lists.push_back(&it->second);
+    }
+    sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) { return a->count < b->count; });
+
+    // 词越少见权重越高 (倒排表长度含作废的表项, 压缩前略有偏差)
+    vector<double> idf;
+    vector<Cursor> cursors;
+    for (const PostingList* list : lists) {
+        idf.push_back(log(1.0 + (double) max<size_t>(live, 1) / list->count));
+        cursors.emplace_back(*list);
+    }
+
+    vector<pair<double, uint32_t>> hits;  // (相关度, 文档号)
+    size_t n = cursors.size();
+    bool more = cursors[0].Next();
+    while (more) {
+        uint32_t target = cursors[0].doc;
+        size_t i = 1;
+        for (; i < n; ++i) {
+            if (!cursors[i].Seek(target)) {  // 某个倒排表已耗尽, 不会再有交集
+                more = false;
+                break;
+            }
+            if (cursors[i].doc != target) {
+                break;
+            }
+        }
+        if (!more) {
+            break;
+        }
+        if (i < n) {  // 第 i 个表跳过了 target, 最短的表直接跳到它的位置
+            more = cursors[0].Seek(cursors[i].doc);
+            continue;
+        }
+        if (alive[target]) {
+            double score = 0;
+            for (size_t k = 0; k < n; ++k) {
+                uint8_t f = cursors[k].fields;
+                score += idf[k] * (3 * !!(f & NameField) + 2 * !!(f & AuthorField) + !!(f & PublisherField));
+            }
+            hits.emplace_back(score, target);
+        }
+        more = cursors[0].Next();
+    }
+
+    sort(hits.begin(), hits.end(), [this](const pair<double, uint32_t>& a, const pair<double, uint32_t>& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return isbnOfDoc[a.second] < isbnOfDoc[b.second];
+    });
+    result.reserve(hits.size());
+    for (const auto& hit : hits) {
+        result.push_back(isbnOfDoc[hit.second]);
+    }
+    return result;
+}
+
+// 有效的书目数
+size_t TextIndex::Size() const { return live; }
+
+// 不同的词数
+size_t TextIndex::TermCount() const { return terms.size(); }
@@ -0,0 +1,57 @@
+#include "title.h"
+
+// 默认构造函数
+Title::Title() : year(0) {}
+
+// 有参构造函数
+Title::Title(const string& ISBN, const string& name, const string& author,
+             const string& publisher, int year)
+        : ISBN(ISBN),             // 初始化 ISBN
+          name(name),             // 初始化书名
+          author(author),         // 初始化作者
+          publisher(publisher),   // 初始化出版社
+          year(year) {}           // 初始化出版年份
+
+// 默认析构函数
+Title::~Title() = default;
+
+// 获取 ISBN
+const string& Title::GetISBN() const { return ISBN; }
+
+// 设置 ISBN
+void Title::SetISBN(const string& ISBN) { Title::ISBN = ISBN; }
+
+// 获取书名
+const string& Title::GetName() const { return name; }
+
+// 设置书名
+void Title::SetName(const string& name) { Title::name = name; }
+
+// 获取作者
+const string& Title::GetAuthor() const { return author; }
+
+// 设置作者
+void Title::SetAuthor(const string& author) { Title::author = author; }
+
+// 获取出版社
+const string& Title::GetPublisher() const { return publisher; }
+
+// 设置出版社
+void Title::SetPublisher(const string& publisher) { Title::publisher = publisher; }
+
+// 获取出版年份
+int Title::GetYear() const { return year; }
+
+// 设置出版年份
+void Title::SetYear(int year) { Title::year = year; }
+
+// 比较描述信息是否完全相同
+bool Title::operator==(const Title& other) const {
+    return ISBN == other.ISBN && name == other.name && author == other.author &&
+           publisher == other.publisher && year == other.year;
+}
+
+// 比较描述信息是否不同
+bool Title::operator!=(const Title& other) const {
+    return !(*this == other);
+}
@@ -0,0 +1,101 @@
+#include "yearIndex.h"
+#include <algorithm>
+using namespace std;
+
+// 键值小于 k 的项数和其中已借出的项数
+void YearIndex::_prefix(const pair<int, int>& k, size_t& total, size_t& borrowed) {
+    total = borrowed = 0;
+    Node<Entry>* x = tree.rootNode();
+    while (x != nullptr) {
+        if (x->value.key < k) {  // x 和它的左子树都在 k 之前
+            total += Node<Entry>::subtreeSize(x->left) + 1;
+            borrowed += (x->left ? x->left->value.borrowedCount : 0) + x->value.borrowed;
+            x = x->right;
+        } else {
+            x = x->left;
+        }
+    }
+}
+
+// 由 items 重建索引
+void YearIndex::Build(const vector<Item>& items) {
+    vector<Entry> entries;
+    entries.reserve(items.size());
+    for (const Item& item : items) {
+        entries.push_back(Entry{{item.year, item.id}, item.borrowed, 0});
+    }
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    tree.clear();
+    tree.buildUnique(entries.begin(), entries.end());  // 聚合值在建树时自底向上计算
+}
+
+// 登记一本书
+void YearIndex::Insert(int year, int id, bool borrowed) {
+    tree.insertUnique(Entry{{year, id}, borrowed, 0});
+}
+
+// 移除一本书
+void YearIndex::Erase(int year, int id) {
+    auto it = tree.find({year, id});
+    if (it != tree.end()) {
+        tree.erase(it);
+    }
+}
+
+// 修改一本书的借阅状态
+void YearIndex::SetBorrowed(int year, int id, bool borrowed) {
+    auto it = tree.find({year, id});
+    if (it != tree.end() && it->borrowed != borrowed) {
+        it->borrowed = borrowed;
+        tree.refresh(it);  // 重新计算到根路径上的聚合值
+    }
+}
+
+// 出版年份在 [yearMin, yearMax] 内的书数
+void YearIndex::Count(int yearMin, int yearMax, size_t& available, size_t& borrowed) {
+    available = borrowed = 0;
+    if (yearMin > yearMax) {
+        return;
+    }
+    // 区间内的项 = 键值小于 (yearMax + 1, 最小编号) 的项 - 键值小于 (yearMin, 最小编号) 的项
+    size_t lowTotal, lowBorrowed, highTotal, highBorrowed;
+    _prefix({yearMin, INT_MIN}, lowTotal, lowBorrowed);
+    if (yearMax == INT_MAX) {
+        Node<Entry>* root = tree.rootNode();
+        highTotal = tree.size();
+        highBorrowed = root ? root->value.borrowedCount : 0;
+    } else {
+        _prefix({yearMax + 1, INT_MIN}, highTotal, highBorrowed);
+    }
+    borrowed = highBorrowed - lowBorrowed;
+    available = highTotal - lowTotal - borrowed;
+}
+
+// 返回区间内从第 offset 项开始的至多 limit 个编号
+vector<int> YearIndex::Range(int yearMin, int yearMax, size_t offset, size_t limit) {
+    vector<int> result;
+    if (yearMin > yearMax) {
+        return result;
+    }
+    // 由名次定位到区间内的第 offset 项, 然后顺序遍历到区间末尾
+    size_t first = tree.rank({yearMin, INT_MIN});
+    size_t last = yearMax == INT_MAX ? tree.size() : tree.rank({yearMax + 1, INT_MIN});
+    if (first + offset >= last) {
+        return result;
+    }
+    auto it = tree.select(first + offset);
+    for (size_t i = first + offset; i < last && result.size() < limit; ++i, ++it) {
+        result.push_back(it->key.second);
+    }
+    return result;
+}
+
+// 清空索引
+void YearIndex::Clear() {
+    tree.clear();
+}
+
+// 索引项个数
+size_t YearIndex::Size() const {
+    return tree.size();
+}
@@ -0,0 +1,103 @@
+// 并发门面测试
+// 多个读者线程与一个写者线程同时通过 ConcurrentBookManager 访问同一个 BookManager:
+// - 读者看到的每个结果都是某一次写操作前后的完整状态 (副本数、在库 + 借出的总数不变)
+// - 结束后借出数与写者记录的一致, 重新加载 (回放操作日志) 后仍然一致
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "concurrentBookManager.h"
+#include "testUtil.h"
+using namespace std;
+
+class ConcurrentTest {
+public:
+    static constexpr int Titles = 50;   // 书目数
+    static constexpr int Copies = 10;   // 每个书目的副本数
+    static constexpr int Books = Titles * Copies;
+
+    // 读者: 反复查找并检查不变量
+    static void reader(ConcurrentBookManager& books, atomic<bool>& stop, atomic<size_t>& rounds, int seed) {
+        mt19937 rng(seed);
+        Book book;
+        while (!stop.load()) {
+            int id = (int) (rng() % Books) + 1;
+            CHECK(books.FindByID(id, book) == BookManager::Ok && book.GetId() == id);
+            vector<Book> copies = books.FindByISBN("978-" + to_string((id - 1) / Copies));
+            CHECK(copies.size() == (size_t) Copies);
+            for (const Book& copy : copies) {
+                CHECK(copy.GetName() == "书名" + to_string((id - 1) / Copies));
+            }
+            size_t available, borrowed;
+            books.CountByYear(2000, 2000 + Titles, available, borrowed);
+            CHECK(available + borrowed == (size_t) Books);
+            CHECK(books.FindPage(rng() % (Books / 20) + 1, 20).size() == 20);
+            CHECK(books.Size() == (size_t) Books);
+            ++rounds;
+            this_thread::yield();  // 读写锁偏向读者, 让出时间片以免写者长时间等待
+        }
+    }
+
+    // 写者: 随机借出或归还, 记录借出的编号
+    static void writer(ConcurrentBookManager& books, set<int>& lent) {
+        mt19937 rng(7);
+        for (int i = 0; i < 3000; ++i) {
+            int id = (int) (rng() % Books) + 1;
+            if (lent.count(id)) {
+                CHECK(books.Return(id) == BookManager::Ok);
+                lent.erase(id);
+            } else {
+                CHECK(books.Lend(id, "读者") == BookManager::Ok);
+                lent.insert(id);
+            }
+            if (i % 64 == 0) {
+                CHECK(books.Sync() == BookManager::Ok);
+            }
+        }
+        CHECK(books.Sync() == BookManager::Ok);
+    }
+};
+
+int main() {
+    string path = (TestUtil::enterTempDir("concurrent_test") / "book").string();
+    set<int> lent;
+    {
+        BookManager manager;
+        CHECK(manager.Init(path, ".bin") == BookManager::Ok);
+        ConcurrentBookManager books(manager);
+        for (int t = 0; t < ConcurrentTest::Titles; ++t) {
+            int firstId;
+            CHECK(books.Insert(Title("978-" + to_string(t), "书名" + to_string(t), "作者", "出版社", 2000 + t),
+                               ConcurrentTest::Copies, firstId) == BookManager::Ok);
+            CHECK(firstId == t * ConcurrentTest::Copies + 1);
+        }
+        CHECK(books.Sync() == BookManager::Ok);
+
+        atomic<bool> stop(false);
+        atomic<size_t> rounds(0);  // 读者完成的检查轮数
+        vector<thread> readers;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([&books, &stop, &rounds, i] { ConcurrentTest::reader(books, stop, rounds, i + 1); });
+        }
+        ConcurrentTest::writer(books, lent);
+        stop = true;
+        for (thread& t : readers) {
+            t.join();
+        }
+        CHECK(books.LendCount() == lent.size());
+        CHECK(rounds.load() > 0);
+    }
+    {
+        BookManager manager;  // 回放操作日志
+        CHECK(manager.Init(path, ".bin") == BookManager::Ok);
+        CHECK(manager.Size() == (size_t) ConcurrentTest::Books);
+        CHECK(manager.LendCount() == lent.size());
+        Book book;
+        for (int id : lent) {
+            CHECK(manager.FindByID(id, book) == BookManager::Ok && book.GetBorrowStatus());
+        }
+    }
+    cout << "concurrent_test: OK" << endl;
+    return 0;
+}
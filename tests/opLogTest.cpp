@@ -0,0 +1,106 @@
+// 操作日志测试
+// - 提交的记录按顺序回放, 检查点记录声明接续的快照类型
+// - 尾部写了一半的记录 (写入时崩溃) 被截断, 之前的记录照常回放
+// - 校验通过却无法解析的记录使回放失败, 文件保持原样
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "binaryCodec.h"
+#include "opLog.h"
+#include "testUtil.h"
+using namespace std;
+
+class OpLogTest {
+public:
+    // 回放 file, 返回是否成功, 回放的记录依次存入 ops
+    static bool replay(const string& file, vector<pair<OpLog::OpType, Book>>& ops) {
+        OpLog log;
+        ops.clear();
+        return log.Replay(file, [&ops](OpLog::OpType type, const Book& book, const string&) {
+            ops.emplace_back(type, book);
+        });
+    }
+
+    // 在文件末尾追加原始字节
+    static void appendRaw(const string& file, const string& bytes) {
+        ofstream out(file, ios::out | ios::binary | ios::app);
+        out << bytes;
+    }
+
+    // 写入若干条记录后正常回放
+    static void commitReplay(const string& file) {
+        OpLog log;
+        CHECK(log.Open(file));
+        CHECK(log.Reset(".bin"));
+        log.AppendPut(Book(1, "978-1", "书名", "作者", "出版社", 2001, false, ""));
+        log.AppendPut(Book(2, "978-1", "书名", "作者", "出版社", 2001, true, "读者"));
+        log.AppendRemove(1);
+        CHECK(log.Commit());
+        CHECK(log.RecordCount() == 3);
+        log.Close();
+
+        CHECK(OpLog::BaseType(file) == ".bin");
+        vector<pair<OpLog::OpType, Book>> ops;
+        CHECK(replay(file, ops));
+        CHECK(ops.size() == 3);
+        CHECK(ops[0].first == OpLog::Put && ops[0].second.GetId() == 1);
+        CHECK(ops[1].first == OpLog::Put && ops[1].second.GetBorrower() == "读者");
+        CHECK(ops[2].first == OpLog::Remove && ops[2].second.GetId() == 1);
+    }
+
+    // 尾部写了一半的记录被截断
+    static void tornWrite(const string& file) {
+        size_t good = filesystem::file_size(file);
+        string torn;
+        BinaryCodec::PutUint32(torn, 100);  // 声明 100 字节的负载, 实际只写入 3 字节
+        BinaryCodec::PutUint32(torn, 0);
+        torn += "abc";
+        appendRaw(file, torn);
+
+        vector<pair<OpLog::OpType, Book>> ops;
+        CHECK(replay(file, ops));
+        CHECK(ops.size() == 3);
+        CHECK(filesystem::file_size(file) == good);
+
+        // 长度完整但校验值不符的记录同样视为写入中断
+        string payload(1, (char) OpLog::Remove), bad;
+        BinaryCodec::PutUint32(payload, 2);
+        BinaryCodec::PutUint32(bad, (uint32_t) payload.size());
+        BinaryCodec::PutUint32(bad, BinaryCodec::Crc32(payload.data(), payload.size()) ^ 1);
+        appendRaw(file, bad + payload);
+        CHECK(replay(file, ops));
+        CHECK(ops.size() == 3);
+        CHECK(filesystem::file_size(file) == good);
+
+        // 截断之后追加的记录可以正常回放
+        OpLog log;
+        CHECK(log.Open(file));
+        log.AppendRemove(2);
+        CHECK(log.Commit());
+        log.Close();
+        CHECK(replay(file, ops));
+        CHECK(ops.size() == 4 && ops[3].first == OpLog::Remove && ops[3].second.GetId() == 2);
+    }
+
+    // 校验通过却无法解析的记录
+    static void corruptRecord(const string& file) {
+        string payload = "\x09junk", record;  // 不存在的操作类型
+        BinaryCodec::PutUint32(record, (uint32_t) payload.size());
+        BinaryCodec::PutUint32(record, BinaryCodec::Crc32(payload.data(), payload.size()));
+        appendRaw(file, record + payload);
+        size_t size = filesystem::file_size(file);
+
+        vector<pair<OpLog::OpType, Book>> ops;
+        CHECK(!replay(file, ops));
+        CHECK(filesystem::file_size(file) == size);  // 不截断, 留给人工处理
+    }
+};
+
+int main() {
+    string file = (TestUtil::enterTempDir("oplog_test") / "book.log").string();
+    OpLogTest::commitReplay(file);
+    OpLogTest::tornWrite(file);
+    OpLogTest::corruptRecord(file);
+    cout << "oplog_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,186 @@
+// 持久化红黑树测试
+// - 随机插入、替换、删除和线性建树之后检查红黑树性质 (_rb_verify) 以及与 std::map 的内容一致
+// - 已取得的快照不受之后写操作的影响, 快照上的 find/select/rank/lowerBound 结果正确
+// - 写者修改期间读者线程取得的每个快照都是某个完整的版本
+// - Snapshot 可以直接交给 BookSnapshot::Write 保存, 读回的 RbTree 形状相同
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "book.h"
+#include "bookSnapshot.h"
+#include "persistentRbTree.h"
+#include "rbTree.h"
+#include "testUtil.h"
+using namespace std;
+
+class PersistentRbTreeTest {
+public:
+    // 键值和附带的文本
+    struct Entry {
+        int key;
+        string text;
+    };
+    struct KeyOfEntry {
+        const int &operator()(const Entry &e) const { return e.key; }
+    };
+    typedef PersistentRbTree<int, Entry, KeyOfEntry, std::less<>> Tree;
+
+    // 检查快照的内容与 expected 完全相同 (按中序)
+    static void checkContents(const Tree::Snapshot &s, const map<int, string> &expected) {
+        CHECK(s.size() == expected.size());
+        auto e = expected.begin();
+        for (auto it = s.begin(); it != s.end(); ++it, ++e) {
+            CHECK(it->key == e->first && it->text == e->second);
+        }
+        CHECK(e == expected.end());
+    }
+
+    // 随机插入、替换和删除
+    static void insertErase() {
+        mt19937 rng(3);
+        Tree tree;
+        map<int, string> expected;
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 500; ++i) {
+                int k = (int) (rng() % 3000);
+                string text = to_string(round);
+                switch (rng() % 3) {
+                    case 0:
+                        CHECK(tree.insertUnique({k, text}) == expected.emplace(k, text).second);
+                        break;
+                    case 1:
+                        tree.insertOrAssign({k, text});
+                        expected[k] = text;
+                        break;
+                    default:
+                        CHECK(tree.erase(k) == (expected.erase(k) == 1));
+                        break;
+                }
+            }
+            CHECK(tree._rb_verify());
+            checkContents(tree.snapshot(), expected);
+        }
+        tree.clear();
+        CHECK(tree.empty() && tree._rb_verify());
+    }
+
+    // 快照隔离与按名次查找
+    static void snapshots() {
+        vector<Entry> sorted;
+        for (int i = 0; i < 2000; ++i) {
+            sorted.push_back({i * 2, "v" + to_string(i)});
+        }
+        Tree tree;
+        tree.buildUnique(sorted.begin(), sorted.end());
+        CHECK(tree._rb_verify());
+        Tree::Snapshot before = tree.snapshot();
+
+        for (int i = 0; i < 2000; i += 2) {
+            tree.erase(i * 2);
+        }
+        tree.insertOrAssign({2, "changed"});
+        tree.insertUnique({1, "new"});
+        CHECK(tree._rb_verify());
+
+        // 旧快照保持原样
+        CHECK(before.size() == 2000);
+        for (size_t i = 0; i < sorted.size(); i += 13) {
+            const Entry *e = before.select(i);
+            CHECK(e != nullptr && e->key == sorted[i].key && e->text == sorted[i].text);
+            CHECK(before.rank(sorted[i].key) == i);
+            CHECK(before.rank(sorted[i].key + 1) == i + 1);
+            CHECK(before.find(sorted[i].key) != nullptr);
+            CHECK(before.lowerBound(sorted[i].key - 1)->key == sorted[i].key);
+        }
+        CHECK(before.find(1) == nullptr && before.find(2)->text == "v1");
+        CHECK(before.select(2000) == nullptr);
+
+        // 新版本
+        Tree::Snapshot after = tree.snapshot();
+        CHECK(after.size() == 1001);
+        CHECK(after.find(0) == nullptr && after.find(1)->text == "new" && after.find(2)->text == "changed");
+        CHECK(after.select(0)->key == 1 && after.rank(3) == 2);
+        CHECK(after.lowerBound(100000) == after.end());
+    }
+
+    // 读者线程在写者修改期间取得快照
+    static void concurrentReaders() {
+        Tree tree;
+        atomic<bool> stop(false);
+        atomic<size_t> rounds(0);
+        vector<thread> readers;
+        for (int t = 0; t < 3; ++t) {
+            readers.emplace_back([&tree, &stop, &rounds] {
+                while (!stop.load()) {
+                    // 写者成对插入 2k 和 2k + 1, 任一完整版本中奇数键值的前一个偶数键值都存在
+                    Tree::Snapshot s = tree.snapshot();
+                    size_t count = 0;
+                    int last = -1;
+                    for (auto it = s.begin(); it != s.end(); ++it, ++count) {
+                        CHECK(it->key > last);
+                        last = it->key;
+                        if (it->key % 2 == 1) {
+                            CHECK(s.find(it->key - 1) != nullptr);
+                        }
+                    }
+                    CHECK(count == s.size());
+                    ++rounds;
+                    this_thread::yield();
+                }
+            });
+        }
+        for (int k = 0; k < 4000; k += 2) {
+            tree.insertUnique({k, ""});
+            tree.insertUnique({k + 1, ""});
+            if (k % 8 == 6) {
+                tree.erase(k - 6 + 1);  // 删除奇数键值不破坏不变量
+            }
+        }
+        stop = true;
+        for (thread &t : readers) {
+            t.join();
+        }
+        CHECK(tree._rb_verify());
+        CHECK(rounds.load() > 0);
+    }
+
+    // 按编号排序的图书
+    struct IdOfBook {
+        const int &operator()(const Book &book) const { return book.GetId(); }
+    };
+
+    // 把一个版本写成二进制快照, 再读回为 RbTree
+    static void bookSnapshot(const string &file) {
+        PersistentRbTree<int, Book, IdOfBook, std::less<>> books;
+        auto title = make_shared<const Title>("978-1", "书名", "作者", "出版社", 2001);
+        for (int id = 1; id <= 500; ++id) {
+            books.insertUnique(Book(id, title, id % 5 == 0, id % 5 == 0 ? "读者" : ""));
+        }
+        auto version = books.snapshot();
+        books.erase(1);  // 之后的修改不影响已取得的版本
+        CHECK(BookSnapshot::Write(file, version, 500));
+
+        RbTree<int, Book, IdOfBook, std::less<>> loaded;
+        int maxId = 0;
+        CHECK(BookSnapshot::Read(file, loaded, maxId));
+        CHECK(maxId == 500 && loaded.size() == 500 && loaded._rb_verify());
+        auto it = loaded.begin();
+        for (auto b = version.begin(); b != version.end(); ++b, ++it) {
+            CHECK(it->GetId() == b->GetId() && it->GetBorrowStatus() == b->GetBorrowStatus());
+        }
+    }
+};
+
+int main() {
+    string file = (TestUtil::enterTempDir("persistent_rbtree_test") / "book.bin").string();
+    PersistentRbTreeTest::insertErase();
+    PersistentRbTreeTest::snapshots();
+    PersistentRbTreeTest::concurrentReaders();
+    PersistentRbTreeTest::bookSnapshot(file);
+    cout << "persistent_rbtree_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+// 红黑树测试
+// 随机插入、删除、线性建树之后检查红黑树性质 (_rb_verify), 以及 select/rank、split/join 和 unionWith 的结果
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include "rbTree.h"
+#include "testUtil.h"
+using namespace std;
+
+class RbTreeTest {
+public:
+    struct KeyOfInt {
+        const int &operator()(const int &v) const { return v; }
+    };
+    typedef RbTree<int, int, KeyOfInt, std::less<>> Tree;
+
+    // 检查树中的键值与 expected 完全相同 (按中序)
+    static void checkContents(Tree &tree, const set<int> &expected) {
+        CHECK(tree._rb_verify());
+        CHECK(tree.size() == expected.size());
+        auto e = expected.begin();
+        for (auto it = tree.begin(); it != tree.end(); ++it, ++e) {
+            CHECK(*it == *e);
+        }
+    }
+
+    // 随机插入和删除
+    static void insertErase() {
+        mt19937 rng(1);
+        Tree tree;
+        set<int> expected;
+        for (int i = 0; i < 20000; ++i) {
+            int k = (int) (rng() % 50000);
+            CHECK(tree.insertUnique(k).second == expected.insert(k).second);
+        }
+        checkContents(tree, expected);
+        for (int i = 0; i < 20000; ++i) {
+            int k = (int) (rng() % 50000);
+            CHECK(tree.erase(k) == expected.erase(k));
+        }
+        checkContents(tree, expected);
+    }
+
+    // 按名次查找和求名次
+    static void selectRank() {
+        Tree tree;
+        vector<int> keys;
+        for (int i = 0; i < 5000; ++i) {
+            keys.push_back(i * 3);
+        }
+        CHECK(tree.buildUnique(keys.begin(), keys.end()));
+        CHECK(tree._rb_verify());
+        for (size_t i = 0; i < keys.size(); i += 7) {
+            CHECK(*tree.select(i) == keys[i]);
+            CHECK(tree.rank(keys[i]) == i);
+            CHECK(tree.rank(keys[i] + 1) == i + 1);  // 不存在的键值: 小于它的节点个数
+        }
+        CHECK(tree.select(keys.size()) == tree.end());
+        CHECK(tree.rank(-1) == 0);
+    }
+
+    // 拆分后再连接
+    static void splitJoin() {
+        for (int at : {0, 1, 2500, 4999, 5000, 9000}) {
+            Tree tree, right;
+            set<int> all;
+            for (int i = 0; i < 5000; ++i) {
+                tree.insertUnique(i * 2);
+                all.insert(i * 2);
+            }
+            CHECK(tree.split(at, right));
+            set<int> low(all.begin(), all.lower_bound(at)), high(all.lower_bound(at), all.end());
+            checkContents(tree, low);
+            checkContents(right, high);
+            CHECK(tree.join(right));
+            CHECK(right.size() == 0 && right._rb_verify());
+            checkContents(tree, all);
+        }
+        // right 非空时拒绝拆分, 键值范围重叠时拒绝连接
+        Tree a, b;
+        a.insertUnique(1);
+        a.insertUnique(5);
+        b.insertUnique(3);
+        CHECK(!a.split(3, b));
+        CHECK(!a.join(b));
+        CHECK(a.size() == 2 && b.size() == 1);
+    }
+
+    // 合并两棵键值部分重叠的树
+    static void unionWith() {
+        mt19937 rng(2);
+        for (unsigned threads : {1u, 4u}) {
+            Tree a, b;
+            set<int> all;
+            size_t added = 0;
+            for (int i = 0; i < 8000; ++i) {
+                int k = (int) (rng() % 20000);
+                if (a.insertUnique(k).second) {
+                    all.insert(k);
+                }
+            }
+            for (int i = 0; i < 3000; ++i) {
+                int k = (int) (rng() % 20000);
+                if (b.insertUnique(k).second && all.insert(k).second) {
+                    ++added;
+                }
+            }
+            CHECK(a.unionWith(b, threads) == added);
+            CHECK(b.size() == 0 && b._rb_verify());
+            checkContents(a, all);
+        }
+    }
+};
+
+int main() {
+    RbTreeTest::insertErase();
+    RbTreeTest::selectRank();
+    RbTreeTest::splitJoin();
+    RbTreeTest::unionWith();
+    cout << "rbtree_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+// 记录解析测试
+// 合法的行按顺序解析出来, 格式错误的行被跳过并以正确的行号和原因记录, 空行不计为错误
+#include <string>
+#include <vector>
+#include "recordParser.h"
+#include "testUtil.h"
+using namespace std;
+
+class RecordParserTest {
+public:
+    // 图书记录
+    static void books() {
+        string data =
+                "1 978-1 书名 作者 出版社 2001 0\n"        // 1: 在库
+                "2 978-1 书名 作者 出版社 2001 1 读者\n"   // 2: 借出
+                "\n"                                       // 3: 空行
+                "3 978-2 书名 作者 出版社\n"               // 4: 字段数不足
+                "x 978-2 书名 作者 出版社 2002 0\n"        // 5: 编号不是整数
+                "4 978-2 书名 作者 出版社 二零 0\n"        // 6: 年份不是整数
+                "5 978-2 书名 作者 出版社 2002 2\n"        // 7: 借阅状态非法
+                "6 978-2 书名 作者 出版社 2002 1\n"        // 8: 缺少借阅人
+                "7 978-2 书名 作者 出版社 2002 0 多余\n"   // 9: 字段数过多
+                "8 978-3 书名 作者 出版社 2003 0";         // 10: 末尾没有换行
+        RecordParser parser(data.data(), data.size());
+        RecordParser::BookFields fields;
+        vector<int> ids;
+        while (parser.NextBook(fields)) {
+            ids.push_back(fields.id);
+            if (fields.id == 2) {
+                CHECK(fields.borrowStatus && fields.borrower == "读者");
+            }
+        }
+        CHECK((ids == vector<int>{1, 2, 8}));
+        CHECK(parser.LinesRead() == 10);
+
+        const vector<RecordParser::Error>& errors = parser.Errors();
+        CHECK(errors.size() == 6);
+        for (size_t i = 0; i < errors.size(); ++i) {
+            CHECK(errors[i].line == i + 4);
+            CHECK(!errors[i].message.empty());
+        }
+        CHECK(errors[0].message == "字段数不足");
+        CHECK(errors[4].message == "缺少借阅人");
+        CHECK(errors[5].message == "字段数过多");
+    }
+
+    // 行号从 firstLine 开始 (BookLoader 按块解析时使用)
+    static void firstLine() {
+        string data = "1 978-1 书名 作者 出版社 2001 0\nbad\n";
+        RecordParser parser(data.data(), data.size(), 100);
+        RecordParser::BookFields fields;
+        CHECK(parser.NextBook(fields));
+        CHECK(!parser.NextBook(fields));
+        CHECK(parser.Errors().size() == 1 && parser.Errors()[0].line == 101);
+    }
+
+    // 管理员记录
+    static void admins() {
+        string data = "admin 123456\nonlyname\nroot pw extra\nguest guest\n";
+        RecordParser parser(data.data(), data.size());
+        RecordParser::AdminFields fields;
+        vector<string> names;
+        while (parser.NextAdmin(fields)) {
+            names.emplace_back(fields.name);
+        }
+        CHECK((names == vector<string>{"admin", "guest"}));
+        CHECK(parser.Errors().size() == 2);
+        CHECK(parser.Errors()[0].line == 2 && parser.Errors()[1].line == 3);
+    }
+};
+
+int main() {
+    RecordParserTest::books();
+    RecordParserTest::firstLine();
+    RecordParserTest::admins();
+    cout << "record_parser_test: OK" << endl;
+    return 0;
+}
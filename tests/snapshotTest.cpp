@@ -0,0 +1,114 @@
+// 二进制快照测试
+// - 写出后读回: 书籍数据、最大编号和树的形状 (先序) 完全相同, 共享的描述信息读回后仍然共享
+// - 任意一个字节被改动或文件被截断时拒绝加载, 目标树保持为空
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "book.h"
+#include "bookSnapshot.h"
+#include "rbTree.h"
+#include "testUtil.h"
+using namespace std;
+
+class SnapshotTest {
+public:
+    // 按编号排序的主索引 (与 BookManager 相同)
+    struct IdOfBook {
+        const int &operator()(const Book &book) const { return book.GetId(); }
+    };
+    typedef RbTree<int, Book, IdOfBook, std::less<>> Tree;
+
+    // 生成 n 本书, 每 3 本共享一个描述信息, 每 7 本有一本借出
+    static void fill(Tree &tree, int n) {
+        shared_ptr<const Title> title;
+        for (int id = 1; id <= n; ++id) {
+            if (id % 3 == 1) {
+                title = make_shared<const Title>("978-" + to_string(id / 3), "书名" + to_string(id / 3), "作者",
+                                                 "出版社" + to_string(id % 5), 1990 + id % 30);
+            }
+            bool borrowed = id % 7 == 0;
+            tree.insertUnique(Book(id, title, borrowed, borrowed ? "读者" + to_string(id) : ""));
+        }
+    }
+
+    // 读取整个文件
+    static string readFile(const string &file) {
+        ifstream in(file, ios::in | ios::binary);
+        return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    }
+
+    // 覆盖写入整个文件
+    static void writeFile(const string &file, const string &data) {
+        ofstream out(file, ios::out | ios::binary | ios::trunc);
+        out << data;
+    }
+
+    // 写出后读回
+    static void roundTrip(const string &file) {
+        Tree tree;
+        fill(tree, 1000);
+        CHECK(BookSnapshot::Write(file, tree, 1234));
+        CHECK(BookSnapshot::IsSnapshot(file));
+
+        Tree loaded;
+        int maxId = 0;
+        CHECK(BookSnapshot::Read(file, loaded, maxId));
+        CHECK(maxId == 1234);
+        CHECK(loaded._rb_verify());
+        CHECK(loaded.size() == tree.size());
+        CHECK(_samePreorder(tree.rootNode(), loaded.rootNode()));
+        for (auto a = tree.begin(), b = loaded.begin(); a != tree.end(); ++a, ++b) {
+            CHECK(a->GetId() == b->GetId() && a->GetISBN() == b->GetISBN() && a->GetName() == b->GetName() &&
+                  a->GetAuthor() == b->GetAuthor() && a->GetPublisher() == b->GetPublisher() &&
+                  a->GetYear() == b->GetYear() && a->GetBorrowStatus() == b->GetBorrowStatus() &&
+                  a->GetBorrower() == b->GetBorrower());
+        }
+        auto first = loaded.find(1), second = loaded.find(2);
+        CHECK(first->GetTitle() == second->GetTitle());  // 同一 ISBN 的副本读回后共享描述信息
+
+        // 空树
+        Tree empty, emptyLoaded;
+        CHECK(BookSnapshot::Write(file + ".empty", empty, 0));
+        CHECK(BookSnapshot::Read(file + ".empty", emptyLoaded, maxId));
+        CHECK(emptyLoaded.size() == 0 && emptyLoaded._rb_verify());
+    }
+
+    // 损坏的快照
+    static void corruption(const string &file) {
+        string data = readFile(file);
+        string damaged = file + ".damaged";
+        for (size_t pos : {(size_t) 8, BookSnapshot::HeaderSize + 3, data.size() / 2, data.size() - 1}) {
+            string bytes = data;
+            bytes[pos] ^= 0x20;
+            writeFile(damaged, bytes);
+            Tree tree;
+            int maxId = 0;
+            CHECK(!BookSnapshot::Read(damaged, tree, maxId));
+            CHECK(tree.size() == 0);
+        }
+        writeFile(damaged, data.substr(0, data.size() - 5));  // 截断
+        Tree tree;
+        int maxId = 0;
+        CHECK(!BookSnapshot::Read(damaged, tree, maxId));
+        CHECK(tree.size() == 0);
+    }
+
+private:
+    // 两棵树的先序形状 (键值和颜色) 是否相同
+    static bool _samePreorder(Tree::NodePtr a, Tree::NodePtr b) {
+        if (a == nullptr || b == nullptr) {
+            return a == b;
+        }
+        return a->value.GetId() == b->value.GetId() && a->color == b->color &&
+               _samePreorder(a->left, b->left) && _samePreorder(a->right, b->right);
+    }
+};
+
+int main() {
+    string file = (TestUtil::enterTempDir("snapshot_test") / "book.bin").string();
+    SnapshotTest::roundTrip(file);
+    SnapshotTest::corruption(file);
+    cout << "snapshot_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef LIBRARYMANAGEMENT_TESTUTIL_H
+#define LIBRARYMANAGEMENT_TESTUTIL_H
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+using namespace std;
+
+// 检查条件, 不成立时输出位置并以失败状态退出 (不受 NDEBUG 影响, Release 构建下同样生效)
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " << #cond << endl;    \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+// 测试的公共工具
+class TestUtil {
+public:
+    // 创建空的临时目录 <临时目录>/<name>/{data,run} 并切换到 run
+    // BookManager 按相对路径 ../data 读写最大编号文件, 测试在这里运行以免改动真实数据
+    // 返回 data 目录
+    static filesystem::path enterTempDir(const string& name) {
+        filesystem::path root = filesystem::temp_directory_path() / name;
+        filesystem::remove_all(root);
+        filesystem::create_directories(root / "data");
+        filesystem::create_directories(root / "run");
+        filesystem::current_path(root / "run");
+        return root / "data";
+    }
+};
+
+#endif //LIBRARYMANAGEMENT_TESTUTIL_H